@@ -1,103 +1,93 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#include "AStar.h"
-#include "Runtime/Core/Public/HAL/RunnableThread.h"
-#include "Algo/Reverse.h"
-#include "Kismet/GameplayStatics.h"
-#include "FAStarNT.h"
-
-FAStar* FAStar::Runnable = nullptr;
-
-bool FAStar::Init()
-{
-	return true;
-}
-
-uint32 FAStar::Run()
-{
-	FPlatformProcess::Sleep(0.01);
-	FindPath();
-	return 0;
-}
-
-void FAStar::Stop()
-{
-	StopTaskCounter.Increment();
-}
-
-void FAStar::RetracePath()
-{
-	ACellBase* CurrentCell = Target;
-	while (CurrentCell != Start)
-	{
-		Path.Add(CurrentCell);
-		CurrentCell = CurrentCell->GetParent();
-	}
-	Algo::Reverse(Path);
-	bFinish = true;
-	
-}
-
-void FAStar::EnsureCompletion()
-{
-	Stop();
-	Thread->WaitForCompletion();
-}
-
-void FAStar::Shutdown()
-{
-	if (Runnable)
-	{
-		Runnable->EnsureCompletion();
-		delete Runnable;
-		Runnable = nullptr;
-	}
-}
-
-bool FAStar::IsThreadFinished()
-{
-	if (Runnable) return Runnable->IsFinished();
-	return true;
-}
-TArray<ACellBase*> FAStar::GetPath()
-{
-	TArray<ACellBase*> Empty;
-	if (Runnable) return Runnable->Path;
-	return Empty;
-}
-
-FAStar * FAStar::JoyInit(ACellBase* StartCell, ACellBase* TargetCell, AGridGenerator* GridGenerator, TArray<ACellBase*> CellPath)
-{
-	if (!Runnable && FPlatformProcess::SupportsMultithreading())
-	{
-		Runnable = new FAStar(StartCell,TargetCell,GridGenerator,CellPath);
-	}
-	return Runnable;
-}
-
-FAStar::FAStar(ACellBase* StartCell, ACellBase* TargetCell, AGridGenerator* GridGenerator, TArray<ACellBase*> CellPath)
-{
-	Start = StartCell;
-	Target = TargetCell;
-	Grid = GridGenerator;
-	Path = CellPath;
-	
-	Thread = FRunnableThread::Create(this, *FString("AStar" + FString::FromInt(FMath::RandRange(0.0f,1000.0f))), 0, TPri_AboveNormal);
-}
-
-FAStar::~FAStar()
-{
-	delete Thread;
-	Thread = nullptr;
-}
-float FAStar::GetDistance(ACellBase* CellA, ACellBase* CellB)
-{
-	return uint16(FVector::Distance(CellA->GetActorLocation(), CellB->GetActorLocation()));
-}
-
-void FAStar::FindPath()
-{	
-	Path = UFAStarNT::GetPath(Start,Target,Grid);
-	bFinish = true;
-
-}
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AStar.h"
+#include "Runtime/Core/Public/HAL/RunnableThread.h"
+#include "FAStarNT.h"
+#include "PathfindingService.h"
+
+FAStar::FAStar(FPathfindingService& InService, int32 WorkerIndex)
+	: Service(InService)
+{
+	WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+
+	Thread = FRunnableThread::Create(this, *FString("AStarWorker" + FString::FromInt(WorkerIndex)), 0, TPri_AboveNormal);
+}
+
+FAStar::~FAStar()
+{
+	delete Thread;
+	Thread = nullptr;
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+}
+
+bool FAStar::Init()
+{
+	return true;
+}
+
+uint32 FAStar::Run()
+{
+	while (StopTaskCounter.GetValue() == 0)
+	{
+		TSharedPtr<FPathQuery, ESPMode::ThreadSafe> Query = Service.DequeueRequest(*this);
+		if (Query.IsValid() && Query->BatchMembers.Num() > 0)
+		{
+			RunBatch(*Query);
+		}
+		else if (Query.IsValid())
+		{
+			const FPathRequest& Request = Query->Request;
+			FPathBuffer Path = Request.CellGrid
+				? UFAStarNT::GetPath(Request.CellGrid, Request.StartId, Request.TargetId, Request.Mode, &Query->Cancellation, Request.SuboptimalityBound)
+				: UFAStarNT::GetPath(Request.StartCell, Request.TargetCell, Request.GridGenerator, Request.Mode, &Query->Cancellation, Request.SuboptimalityBound);
+			Service.CompleteRequest(*Query, MoveTemp(Path));
+		}
+		else
+		{
+			WorkEvent->Wait();
+		}
+	}
+	return 0;
+}
+
+void FAStar::RunBatch(FPathQuery& Batch)
+{
+	// Members cancelled before the batch got here are left out of the search
+	TArray<FPathQuery*> Members;
+	TArray<ACellBase*> StartCells;
+	for (const TSharedPtr<FPathQuery, ESPMode::ThreadSafe>& Member : Batch.BatchMembers)
+	{
+		EPathRequestState Expected = EPathRequestState::Queued;
+		if (Member->State.CompareExchange(Expected, EPathRequestState::Running))
+		{
+			Members.Add(Member.Get());
+			StartCells.Add(Member->Request.StartCell);
+		}
+	}
+
+	TArray<FPathBuffer> Paths;
+	UFAStarNT::GetPathsToTarget(StartCells, Batch.Request.TargetCell, Batch.Request.GridGenerator, Paths, &Batch.Cancellation);
+	for (int32 i = 0; i < Members.Num(); ++i)
+	{
+		Service.CompleteRequest(*Members[i], MoveTemp(Paths[i]));
+	}
+}
+
+void FAStar::Stop()
+{
+	StopTaskCounter.Increment();
+	Wake();
+}
+
+void FAStar::EnsureCompletion()
+{
+	Stop();
+	Thread->WaitForCompletion();
+}
+
+void FAStar::Wake()
+{
+	WorkEvent->Trigger();
+}
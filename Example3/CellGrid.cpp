@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CellGrid.h"
+#include "CellBase.h"
+#include "PathGrid.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+#include "Hash/CityHash.h"
+
+ACellGrid::ACellGrid()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	CellInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("CellInstances"));
+	CellInstances->NumCustomDataFloats = 2;
+	RootComponent = CellInstances;
+
+	CellSize = 100.0f;
+	Width = 0;
+	Height = 0;
+}
+
+void ACellGrid::Init(int32 InWidth, int32 InHeight)
+{
+	for (auto It = CellActors.CreateIterator(); It; ++It)
+	{
+		if (It.Value())
+		{
+			It.Value()->Destroy();
+		}
+	}
+	CellActors.Empty();
+
+	Width = FMath::Max(InWidth, 0);
+	Height = FMath::Max(InHeight, 0);
+	Walkable.Init(1, Num());
+	Costs.Init(1, Num());
+	Heights.Init(0.0f, Num());
+	RebuildInstances();
+	FPathGrid::Release(this);
+}
+
+int32 ACellGrid::FindCellId(const FVector& Location) const
+{
+	const FVector Local = Location - GetActorLocation();
+	const int32 X = FMath::RoundToInt(Local.X / CellSize);
+	const int32 Y = FMath::RoundToInt(Local.Y / CellSize);
+	return IsValidCoord(X, Y) ? GetCellId(X, Y) : INDEX_NONE;
+}
+
+FVector ACellGrid::GetCellLocation(int32 CellId) const
+{
+	const FIntPoint Coord = GetCoord(CellId);
+	return GetActorLocation() + FVector(Coord.X * CellSize, Coord.Y * CellSize, Heights[CellId]);
+}
+
+void ACellGrid::SetWalkable(int32 CellId, bool bWalkable)
+{
+	if (IsWalkable(CellId) == bWalkable)
+	{
+		return;
+	}
+	Walkable[CellId] = bWalkable ? 1 : 0;
+	CellInstances->SetCustomDataValue(CellId, WalkableCustomData, bWalkable ? 1.0f : 0.0f, true);
+	FPathGrid::NotifyWalkabilityChanged(this, CellId);
+}
+
+void ACellGrid::SetCost(int32 CellId, uint8 Cost)
+{
+	Costs[CellId] = Cost;
+	CellInstances->SetCustomDataValue(CellId, CostCustomData, Cost, true);
+}
+
+void ACellGrid::SetCellHeight(int32 CellId, float CellHeight)
+{
+	Heights[CellId] = CellHeight;
+	const FIntPoint Coord = GetCoord(CellId);
+	CellInstances->UpdateInstanceTransform(CellId, FTransform(FVector(Coord.X * CellSize, Coord.Y * CellSize, CellHeight)), false, true);
+	if (ACellBase* Cell = FindCellActor(CellId))
+	{
+		Cell->SetActorLocation(GetCellLocation(CellId));
+	}
+}
+
+ACellBase* ACellGrid::GetOrSpawnCellActor(int32 CellId)
+{
+	if (ACellBase* Cell = FindCellActor(CellId))
+	{
+		return Cell;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Owner = this;
+	UClass* CellClass = CellActorClass ? *CellActorClass : ACellBase::StaticClass();
+	ACellBase* Cell = GetWorld()->SpawnActor<ACellBase>(CellClass, GetCellLocation(CellId), FRotator::ZeroRotator, SpawnParameters);
+	if (Cell)
+	{
+		Cell->SetCellId(CellId);
+		CellActors.Add(CellId, Cell);
+	}
+	return Cell;
+}
+
+ACellBase* ACellGrid::FindCellActor(int32 CellId) const
+{
+	return CellActors.FindRef(CellId);
+}
+
+void ACellGrid::ReleaseCellActor(int32 CellId)
+{
+	ACellBase* Cell = nullptr;
+	if (CellActors.RemoveAndCopyValue(CellId, Cell) && Cell)
+	{
+		Cell->Destroy();
+	}
+}
+
+void ACellGrid::RebuildInstances()
+{
+	// Instance index and cell id are the same, so updating a cell never has to look its instance up
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(Num());
+	for (int32 CellId = 0; CellId < Num(); ++CellId)
+	{
+		const FIntPoint Coord = GetCoord(CellId);
+		Transforms.Add(FTransform(FVector(Coord.X * CellSize, Coord.Y * CellSize, Heights[CellId])));
+	}
+
+	CellInstances->ClearInstances();
+	CellInstances->AddInstances(Transforms, false);
+	for (int32 CellId = 0; CellId < Num(); ++CellId)
+	{
+		CellInstances->SetCustomDataValue(CellId, WalkableCustomData, IsWalkable(CellId) ? 1.0f : 0.0f, false);
+		CellInstances->SetCustomDataValue(CellId, CostCustomData, Costs[CellId], false);
+	}
+	CellInstances->MarkRenderStateDirty();
+}
+
+uint64 ACellGrid::GetLayoutHash() const
+{
+	// Heights only move the instances, the search graph doesn't depend on them
+	const int32 Dimensions[] = { Width, Height };
+	uint64 Hash = CityHash64(reinterpret_cast<const char*>(Dimensions), sizeof(Dimensions));
+	Hash = CityHash64WithSeed(reinterpret_cast<const char*>(&CellSize), sizeof(CellSize), Hash);
+	Hash = CityHash64WithSeed(reinterpret_cast<const char*>(Walkable.GetData()), Walkable.Num(), Hash);
+	return CityHash64WithSeed(reinterpret_cast<const char*>(Costs.GetData()), Costs.Num(), Hash);
+}
+
+SIZE_T ACellGrid::GetAllocatedSize() const
+{
+	return Walkable.GetAllocatedSize() + Costs.GetAllocatedSize() + Heights.GetAllocatedSize() + CellActors.GetAllocatedSize();
+}
+
+void ACellGrid::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (CellInstances->GetInstanceCount() != Num())
+	{
+		RebuildInstances();
+	}
+}
+
+void ACellGrid::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FPathGrid::Release(this);
+
+	Super::EndPlay(EndPlayReason);
+}
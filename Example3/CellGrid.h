@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CellGrid.generated.h"
+
+class ACellBase;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Grid of a level kept as packed per-cell arrays instead of one ACellBase actor per cell.
+ * Cell ids are Y * Width + X like in FPathGrid, so the row of a cell in the arrays is its node in the search graph and
+ * its coordinates and location follow from the id. A single instanced static mesh draws every cell, walkability and cost
+ * reach the material as per-instance custom data. Cells that need gameplay (pickups, doors, triggers) get an actor
+ * spawned on demand, the arrays stay the authority on walkability either way.
+ * Searches run straight on these arrays, see UFAStarNT::GetPath(ACellGrid*, ...).
+ */
+UCLASS()
+class INVADED_API ACellGrid : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ACellGrid();
+
+	/** Custom data floats of a cell instance, 1 / 0 for walkable / blocked and the cost multiplier */
+	static constexpr int32 WalkableCustomData = 0;
+	static constexpr int32 CostCustomData = 1;
+
+	/** Distance between neighbouring cell centres, also the step cost the searches use */
+	UPROPERTY(EditAnywhere, Category = "Grid")
+	float CellSize;
+
+	/** Spawned for cells that need an actor, ACellBase when unset */
+	UPROPERTY(EditAnywhere, Category = "Grid")
+	TSubclassOf<ACellBase> CellActorClass;
+
+	/** Resets the grid to InWidth x InHeight walkable cells of cost 1 at height 0 and releases every cell actor */
+	void Init(int32 InWidth, int32 InHeight);
+
+	int32 GetWidth() const { return Width; }
+	int32 GetHeight() const { return Height; }
+	int32 Num() const { return Width * Height; }
+
+	bool IsValidCoord(int32 X, int32 Y) const { return X >= 0 && Y >= 0 && X < Width && Y < Height; }
+	int32 GetCellId(int32 X, int32 Y) const { return Y * Width + X; }
+	FIntPoint GetCoord(int32 CellId) const { return FIntPoint(CellId % Width, CellId / Width); }
+
+	/** Cell under the world location, INDEX_NONE outside the grid */
+	int32 FindCellId(const FVector& Location) const;
+
+	/** Centre of the cell at its height, in world space */
+	FVector GetCellLocation(int32 CellId) const;
+
+	bool IsWalkable(int32 CellId) const { return Walkable[CellId] != 0; }
+	uint8 GetCost(int32 CellId) const { return Costs[CellId]; }
+	float GetCellHeight(int32 CellId) const { return Heights[CellId]; }
+
+	const TArray<uint8>& GetCosts() const { return Costs; }
+
+	/** Blocks or opens the cell and tells the pathfinding grid, so only the paths through it are dropped */
+	void SetWalkable(int32 CellId, bool bWalkable);
+
+	/**
+	 * Terrain cost multiplier of the cell, 1 is plain ground. Searches pick costs up when the pathfinding grid
+	 * is built or invalidated, so change them in bulk and call FPathGrid::Invalidate once.
+	 */
+	void SetCost(int32 CellId, uint8 Cost);
+
+	/** Moves the cell up or down, only the location of its instance and actor depends on it */
+	void SetCellHeight(int32 CellId, float CellHeight);
+
+	/** Actor standing in for the cell, spawned at the cell on first request */
+	ACellBase* GetOrSpawnCellActor(int32 CellId);
+
+	/** Actor of the cell if one was spawned, nullptr otherwise */
+	ACellBase* FindCellActor(int32 CellId) const;
+
+	/** Destroys the actor of the cell once its gameplay is over, the cell itself stays */
+	void ReleaseCellActor(int32 CellId);
+
+	int32 GetNumCellActors() const { return CellActors.Num(); }
+
+	/** Recreates the instance of every cell, Init does it for a fresh grid */
+	void RebuildInstances();
+
+	/** Identifies the dimensions, spacing, walkability and costs of the cells, a cooked grid file is only used while it matches */
+	uint64 GetLayoutHash() const;
+
+	/** Memory held by the cell arrays, not counting the instances or the pathfinding grid */
+	SIZE_T GetAllocatedSize() const;
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+protected:
+	UPROPERTY(VisibleAnywhere, Category = "Grid")
+	UInstancedStaticMeshComponent* CellInstances;
+
+private:
+	UPROPERTY()
+	int32 Width;
+
+	UPROPERTY()
+	int32 Height;
+
+	/** One entry per cell id, saved with the level */
+	UPROPERTY()
+	TArray<uint8> Walkable;
+
+	UPROPERTY()
+	TArray<uint8> Costs;
+
+	UPROPERTY()
+	TArray<float> Heights;
+
+	UPROPERTY(Transient)
+	TMap<int32, ACellBase*> CellActors;
+};
@@ -0,0 +1,304 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DStarLite.h"
+#include "CellBase.h"
+#include "PathGrid.h"
+
+namespace
+{
+	int32 AddCost(int32 A, int32 B)
+	{
+		return (A == MAX_int32 || B == MAX_int32) ? MAX_int32 : A + B;
+	}
+}
+
+FDStarLitePlanner::FDStarLitePlanner(const TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& InGrid, int32 InStartId, int32 InTargetId)
+	: Grid(InGrid)
+{
+	StartId = InStartId;
+	LastStartId = InStartId;
+	TargetId = InTargetId;
+	KeyModifier = 0;
+	LastExpansions = 0;
+
+	const int32 NumCells = Grid->Num();
+	G.Init(MAX_int32, NumCells);
+	Rhs.Init(MAX_int32, NumCells);
+	HeapIndex.Init(INDEX_NONE, NumCells);
+	Keys.SetNumUninitialized(NumCells);
+
+	Rhs[TargetId] = 0;
+	HeapInsert(TargetId, CalculateKey(TargetId));
+}
+
+TSharedPtr<FDStarLitePlanner> FDStarLitePlanner::Create(ACellBase* StartCell, ACellBase* TargetCell, AGridGenerator* GridGenerator)
+{
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid = FPathGrid::FindOrBuild(GridGenerator, StartCell);
+	return MakeShared<FDStarLitePlanner>(Grid, Grid->GetCellId(StartCell), Grid->GetCellId(TargetCell));
+}
+
+void FDStarLitePlanner::SetStart(int32 CellId)
+{
+	KeyModifier += GetHeuristic(LastStartId, CellId);
+	LastStartId = CellId;
+	StartId = CellId;
+}
+
+void FDStarLitePlanner::SetStart(ACellBase* Cell)
+{
+	SetStart(Grid->GetCellId(Cell));
+}
+
+void FDStarLitePlanner::NotifyCellsChanged(const TArray<int32>& ChangedCells)
+{
+	// A cell takes part in the steps into and out of it and, as a corner, in the diagonal
+	// steps between its neighbours, so only the cell and its neighbours need new rhs values
+	for (int32 CellId : ChangedCells)
+	{
+		UpdateVertex(CellId);
+		ForEachNeighbour(CellId, [this](int32 NeighbourId)
+		{
+			UpdateVertex(NeighbourId);
+		});
+	}
+}
+
+void FDStarLitePlanner::NotifyCellsChanged(const TArray<ACellBase*>& ChangedCells)
+{
+	TArray<int32> CellIds;
+	CellIds.Reserve(ChangedCells.Num());
+	for (ACellBase* Cell : ChangedCells)
+	{
+		CellIds.Add(Grid->GetCellId(Cell));
+	}
+	NotifyCellsChanged(CellIds);
+}
+
+bool FDStarLitePlanner::Plan()
+{
+	LastExpansions = 0;
+	while (Heap.Num() > 0 && (Keys[Heap[0]] < CalculateKey(StartId) || Rhs[StartId] > G[StartId]))
+	{
+		const int32 CellId = Heap[0];
+		const FKey OldKey = Keys[CellId];
+		const FKey NewKey = CalculateKey(CellId);
+		++LastExpansions;
+
+		if (OldKey < NewKey)
+		{
+			HeapUpdate(CellId, NewKey);
+		}
+		else if (G[CellId] > Rhs[CellId])
+		{
+			G[CellId] = Rhs[CellId];
+			HeapRemove(CellId);
+			ForEachNeighbour(CellId, [this](int32 NeighbourId)
+			{
+				UpdateVertex(NeighbourId);
+			});
+		}
+		else
+		{
+			G[CellId] = MAX_int32;
+			UpdateVertex(CellId);
+			ForEachNeighbour(CellId, [this](int32 NeighbourId)
+			{
+				UpdateVertex(NeighbourId);
+			});
+		}
+	}
+	return Rhs[StartId] != MAX_int32;
+}
+
+bool FDStarLitePlanner::GetPath(TArray<int32>& OutPath) const
+{
+	OutPath.Reset();
+	if (Rhs[StartId] == MAX_int32)
+	{
+		return false;
+	}
+
+	int32 CurrentId = StartId;
+	while (CurrentId != TargetId)
+	{
+		int32 BestId = INDEX_NONE;
+		int32 BestCost = MAX_int32;
+		ForEachNeighbour(CurrentId, [&](int32 NeighbourId)
+		{
+			const int32 Cost = AddCost(GetStepCost(CurrentId, NeighbourId), G[NeighbourId]);
+			if (Cost < BestCost)
+			{
+				BestCost = Cost;
+				BestId = NeighbourId;
+			}
+		});
+
+		if (BestId == INDEX_NONE || OutPath.Num() >= Grid->Num())
+		{
+			OutPath.Reset();
+			return false;
+		}
+		OutPath.Add(BestId);
+		CurrentId = BestId;
+	}
+	return true;
+}
+
+TArray<ACellBase*> FDStarLitePlanner::GetPath() const
+{
+	TArray<int32> CellPath;
+	TArray<ACellBase*> Path;
+	if (GetPath(CellPath))
+	{
+		Path.Reserve(CellPath.Num());
+		for (int32 CellId : CellPath)
+		{
+			Path.Add(Grid->GetCell(CellId));
+		}
+	}
+	return Path;
+}
+
+FDStarLitePlanner::FKey FDStarLitePlanner::CalculateKey(int32 CellId) const
+{
+	const int32 Cost = FMath::Min(G[CellId], Rhs[CellId]);
+	FKey Key;
+	Key.Primary = AddCost(AddCost(Cost, GetHeuristic(StartId, CellId)), KeyModifier);
+	Key.Secondary = Cost;
+	return Key;
+}
+
+void FDStarLitePlanner::UpdateVertex(int32 CellId)
+{
+	if (CellId != TargetId)
+	{
+		int32 BestCost = MAX_int32;
+		ForEachNeighbour(CellId, [&](int32 NeighbourId)
+		{
+			BestCost = FMath::Min(BestCost, AddCost(GetStepCost(CellId, NeighbourId), G[NeighbourId]));
+		});
+		Rhs[CellId] = BestCost;
+	}
+
+	const bool bInHeap = HeapIndex[CellId] != INDEX_NONE;
+	if (G[CellId] != Rhs[CellId])
+	{
+		if (bInHeap)
+		{
+			HeapUpdate(CellId, CalculateKey(CellId));
+		}
+		else
+		{
+			HeapInsert(CellId, CalculateKey(CellId));
+		}
+	}
+	else if (bInHeap)
+	{
+		HeapRemove(CellId);
+	}
+}
+
+int32 FDStarLitePlanner::GetStepCost(int32 FromId, int32 ToId) const
+{
+	if (!Grid->IsWalkable(FromId) || !Grid->IsWalkable(ToId) || !Grid->IsMoveAllowed(FromId, ToId))
+	{
+		return MAX_int32;
+	}
+	const FIntPoint From = Grid->GetCoord(FromId);
+	const FIntPoint To = Grid->GetCoord(ToId);
+	return (From.X != To.X && From.Y != To.Y) ? Grid->GetDiagonalCost() : Grid->GetStraightCost();
+}
+
+template <typename FunctorType>
+void FDStarLitePlanner::ForEachNeighbour(int32 CellId, FunctorType&& Visitor) const
+{
+	const FIntPoint Coord = Grid->GetCoord(CellId);
+	for (int32 DY = -1; DY <= 1; ++DY)
+	{
+		for (int32 DX = -1; DX <= 1; ++DX)
+		{
+			if ((DX != 0 || DY != 0) && Grid->IsValidCoord(Coord.X + DX, Coord.Y + DY))
+			{
+				Visitor(Grid->GetCellId(Coord.X + DX, Coord.Y + DY));
+			}
+		}
+	}
+}
+
+int32 FDStarLitePlanner::GetHeuristic(int32 FromId, int32 ToId) const
+{
+	return Grid->GetOctileDistance(FromId, ToId);
+}
+
+void FDStarLitePlanner::HeapInsert(int32 CellId, const FKey& Key)
+{
+	Keys[CellId] = Key;
+	HeapIndex[CellId] = Heap.Add(CellId);
+	SiftUp(HeapIndex[CellId]);
+}
+
+void FDStarLitePlanner::HeapRemove(int32 CellId)
+{
+	const int32 Index = HeapIndex[CellId];
+	const int32 Last = Heap.Pop(false);
+	HeapIndex[CellId] = INDEX_NONE;
+	if (Last != CellId)
+	{
+		Heap[Index] = Last;
+		HeapIndex[Last] = Index;
+		SiftUp(Index);
+		SiftDown(HeapIndex[Last]);
+	}
+}
+
+void FDStarLitePlanner::HeapUpdate(int32 CellId, const FKey& Key)
+{
+	Keys[CellId] = Key;
+	SiftUp(HeapIndex[CellId]);
+	SiftDown(HeapIndex[CellId]);
+}
+
+void FDStarLitePlanner::SiftUp(int32 Index)
+{
+	const int32 CellId = Heap[Index];
+	while (Index > 0)
+	{
+		const int32 ParentIndex = (Index - 1) / 2;
+		if (!(Keys[CellId] < Keys[Heap[ParentIndex]]))
+		{
+			break;
+		}
+		Heap[Index] = Heap[ParentIndex];
+		HeapIndex[Heap[Index]] = Index;
+		Index = ParentIndex;
+	}
+	Heap[Index] = CellId;
+	HeapIndex[CellId] = Index;
+}
+
+void FDStarLitePlanner::SiftDown(int32 Index)
+{
+	const int32 CellId = Heap[Index];
+	const int32 Count = Heap.Num();
+	while (true)
+	{
+		int32 Child = Index * 2 + 1;
+		if (Child >= Count)
+		{
+			break;
+		}
+		if (Child + 1 < Count && Keys[Heap[Child + 1]] < Keys[Heap[Child]])
+		{
+			++Child;
+		}
+		if (!(Keys[Heap[Child]] < Keys[CellId]))
+		{
+			break;
+		}
+		Heap[Index] = Heap[Child];
+		HeapIndex[Heap[Index]] = Index;
+		Index = Child;
+	}
+	Heap[Index] = CellId;
+	HeapIndex[CellId] = Index;
+}
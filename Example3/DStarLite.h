@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ACellBase;
+class AGridGenerator;
+class FPathGrid;
+
+/**
+ * Incremental planner (D* Lite) for one agent heading to a fixed target.
+ * The search runs backwards from the target and keeps its tree between calls, so after the
+ * agent moves or cells change only the inconsistent part of the tree is repaired instead of
+ * searching again from scratch.
+ */
+class INVADED_API FDStarLitePlanner
+{
+public:
+	FDStarLitePlanner(const TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& InGrid, int32 InStartId, int32 InTargetId);
+
+	static TSharedPtr<FDStarLitePlanner> Create(ACellBase* StartCell, ACellBase* TargetCell, AGridGenerator* GridGenerator);
+
+	/** Moves the agent, the tree is reused as is */
+	void SetStart(int32 CellId);
+	void SetStart(ACellBase* Cell);
+
+	/** Repairs the tree around cells whose walkability changed since the last plan, report them to FPathGrid::NotifyWalkabilityChanged first */
+	void NotifyCellsChanged(const TArray<int32>& ChangedCells);
+	void NotifyCellsChanged(const TArray<ACellBase*>& ChangedCells);
+
+	/** Brings the tree up to date, false when the target can't be reached from the start */
+	bool Plan();
+
+	/** Follows the tree from the start, the path holds the cells after the start up to the target */
+	bool GetPath(TArray<int32>& OutPath) const;
+	TArray<ACellBase*> GetPath() const;
+
+	/** Nodes expanded by the last Plan call */
+	int32 GetLastExpansions() const { return LastExpansions; }
+
+private:
+	struct FKey
+	{
+		int32 Primary;
+		int32 Secondary;
+
+		bool operator<(const FKey& Other) const
+		{
+			return Primary < Other.Primary || (Primary == Other.Primary && Secondary < Other.Secondary);
+		}
+	};
+
+	FKey CalculateKey(int32 CellId) const;
+	void UpdateVertex(int32 CellId);
+
+	/** Cost of the step between two neighbouring cells, MAX_int32 when it is blocked */
+	int32 GetStepCost(int32 FromId, int32 ToId) const;
+
+	/** Calls Visitor(NeighbourId) for every cell around CellId */
+	template <typename FunctorType>
+	void ForEachNeighbour(int32 CellId, FunctorType&& Visitor) const;
+
+	int32 GetHeuristic(int32 FromId, int32 ToId) const;
+
+	void HeapInsert(int32 CellId, const FKey& Key);
+	void HeapRemove(int32 CellId);
+	void HeapUpdate(int32 CellId, const FKey& Key);
+	void SiftUp(int32 Index);
+	void SiftDown(int32 Index);
+
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid;
+
+	int32 StartId;
+	int32 LastStartId;
+	int32 TargetId;
+
+	/** Accumulated heuristic drift from agent moves */
+	int32 KeyModifier;
+
+	TArray<int32> G;
+	TArray<int32> Rhs;
+
+	TArray<int32> Heap;
+	TArray<int32> HeapIndex;
+	TArray<FKey> Keys;
+
+	int32 LastExpansions;
+};
@@ -1,103 +1,444 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#include "FAStarNT.h"
-#include "Actors/CellBase.h"
-#include "Algo/Reverse.h"
-#include "Environment/GridGenerator.h"
-
-struct FAStarComparator
-{
-	FORCEINLINE bool operator()(const ACellBase& A,const ACellBase& B) const { return A.GetHCost() + A.GetGCost() > B.GetHCost() + B.GetGCost(); }
-};
-struct FCellWrapper
-{
-public:
-	ACellBase* Cell;
-	FCellWrapper(ACellBase* Value)
-	{
-		Cell = Value;
-	}
-	FCellWrapper()
-	{
-		Cell = nullptr;
-	}
-	
-};
-bool operator==(const FCellWrapper& A,const FCellWrapper& B) { return A.Cell == B.Cell; }
-bool operator<(const FCellWrapper& A, const FCellWrapper& B) { return A.Cell->GetFCost() < B.Cell->GetFCost(); }
-bool operator>(const FCellWrapper& A, const FCellWrapper& B) { return A.Cell->GetFCost() > B.Cell->GetFCost(); }
-TArray<ACellBase*> UFAStarNT::GetPath(ACellBase* StartCell,ACellBase* TargetCell,AGridGenerator* GridGenerator)
-{
-	TArray<FCellWrapper> OpenSet;
-
-	OpenSet.Add(FCellWrapper(StartCell));
-
-
-	TSet<ACellBase*> ClosedSet;
-	while (OpenSet.Num() > 0)
-	{
-
-		 FCellWrapper CurrentCell = OpenSet[0];
-		for (int i = 1; i < OpenSet.Num(); ++i)
-		{
-			if (OpenSet[i].Cell->GetFCost() < CurrentCell.Cell->GetFCost() || OpenSet[i].Cell->GetFCost() == CurrentCell.Cell->GetFCost())
-			{
-				if (OpenSet[i].Cell->GetHCost() < CurrentCell.Cell->GetHCost())
-					CurrentCell = OpenSet[i];
-			}
-		}
-		OpenSet.Remove(CurrentCell);
-				
-		ClosedSet.Add(CurrentCell.Cell);
-		if (CurrentCell.Cell == TargetCell)
-		{
-
-			return RetracePath(StartCell,TargetCell);
-			
-		}
-
-	
-		for (ACellBase* Neighbour : GridGenerator->GetNeighbours(CurrentCell.Cell))
-		{
-
-			if (!Neighbour->GetIsWalkable() || ClosedSet.Contains(Neighbour))
-			{
-				continue;
-			}
-
-			uint16 MovementCost = CurrentCell.Cell->GetGCost() + GetDistance(CurrentCell.Cell, Neighbour);
-			if (MovementCost < Neighbour->GetGCost() || !OpenSet.Contains(FCellWrapper(Neighbour)))
-			{
-
-				Neighbour->SetGCost(MovementCost);
-				Neighbour->SetHCost(GetDistance(Neighbour, TargetCell));
-				Neighbour->SetParent(CurrentCell.Cell);
-
-				if (!OpenSet.Contains(FCellWrapper(Neighbour)))
-				{
-					OpenSet.Add(FCellWrapper(Neighbour));
-				}
-			}
-		}
-
-
-	}
-	return TArray<ACellBase*>();
-}
-TArray<ACellBase*> UFAStarNT::RetracePath(ACellBase* Start,ACellBase* Target)
-{
-	TArray<ACellBase*> Path;
-	ACellBase* CurrentCell = Target;
-	while (CurrentCell != Start)
-	{
-		Path.Add(CurrentCell);
-		CurrentCell = CurrentCell->GetParent();
-	}
-	Algo::Reverse(Path);
-	return Path;
-}
-
-float UFAStarNT::GetDistance(ACellBase * CellA, ACellBase * CellB)
-{
-	return uint16(FVector2D::Distance(FVector2D(CellA->GetActorLocation()), FVector2D(CellB->GetActorLocation())));
-}
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FAStarNT.h"
+#include "Actors/CellBase.h"
+#include "Environment/GridGenerator.h"
+#include "CellGrid.h"
+#include "PathGrid.h"
+#include "PathQueryProfiler.h"
+#include "PathfindingStats.h"
+#include "PathfindingCore/AStarNodeTable.h"
+#include "PathfindingCore/AStarOpenSet.h"
+#include "PathfindingCore/FocalSearch.h"
+#include "PathfindingCore/GridAStar.h"
+#include "PathfindingCore/HierarchicalPathfinder.h"
+#include "PathfindingCore/JumpPointSearch.h"
+#include "PathfindingCore/JumpPointTable.h"
+#include "PathfindingCore/LandmarkHeuristic.h"
+#include "PathfindingCore/PathHeuristics.h"
+#include "PathfindingCore/ThetaStar.h"
+
+DECLARE_CYCLE_STAT(TEXT("Path Query"), STAT_PathQuery, STATGROUP_Pathfinding);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Unreachable Targets Rejected"), STAT_PathUnreachableRejected, STATGROUP_Pathfinding);
+
+namespace
+{
+	/** Start and target in different components, no search could connect them */
+	bool RejectUnreachable(const FPathGrid& Grid, int32 StartId, int32 TargetId)
+	{
+		if (Grid.GetComponents().AreConnected(StartId, TargetId))
+		{
+			return false;
+		}
+		INC_DWORD_STAT(STAT_PathUnreachableRejected);
+		return true;
+	}
+
+	/** A* with the landmark heuristic once FPathGrid::BuildLandmarks finished for the grid, with the octile one until then */
+	bool FindAStarPath(FPathGrid& Grid, int32 StartId, int32 TargetId, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats = nullptr)
+	{
+		// Landmark estimates never fall below the octile ones, so once the table is ready they only save expansions
+		const TSharedPtr<const FLandmarkTable, ESPMode::ThreadSafe> Landmarks = Grid.GetLandmarks();
+		if (!Landmarks.IsValid())
+		{
+			return FGridAStar::FindPath<FOctileHeuristic>(Grid, StartId, TargetId, OutPath, Cancellation, OutStats);
+		}
+		return FGridAStar::FindPathWithHeuristic(Grid, StartId, TargetId, FLandmarkHeuristic(Grid, *Landmarks, TargetId), OutPath, Cancellation, OutStats);
+	}
+
+
+	/** GetPath once the grid and the key of the query are known, fills in the search part of the record */
+	FPathBuffer FindPath(FPathGrid& Grid, const FPathCacheKey& CacheKey, const FPathCancellationToken* Cancellation, FPathQueryRecord& OutRecord)
+	{
+		const bool bBounded = CacheKey.Mode == EPathSearchMode::WeightedAStar || CacheKey.Mode == EPathSearchMode::Focal;
+		OutRecord.bCacheHit = true;
+
+		FPathBuffer Path;
+		if (RejectUnreachable(Grid, CacheKey.StartId, CacheKey.TargetId) || Grid.GetPathCache().Find(CacheKey, Path))
+		{
+			return Path;
+		}
+
+		// An optimal path is within any bound, so a cached A* one serves bounded queries as well
+		if (bBounded && Grid.GetPathCache().Find(FPathCacheKey(CacheKey.StartId, CacheKey.TargetId, CacheKey.GridVersion, EPathSearchMode::AStar), Path))
+		{
+			return Path;
+		}
+		OutRecord.bCacheHit = false;
+		FPathSearchStats& Stats = OutRecord.Search;
+
+		// A cell may be blocked while the search runs, such a path is still handed out but the cache refuses it
+		const uint32 CacheEpoch = Grid.GetPathCache().GetInvalidationEpoch();
+
+		// The searches write their cell ids straight into the buffer the path is handed out in
+		Path = FPathBufferPool::Get().Acquire();
+		std::vector<int32>& CellPath = Path.GetCellIds();
+		// Jump points, any-angle lines and the hierarchy price a step by its direction alone, weighted cells need A*
+		EPathSearchMode Mode = CacheKey.Mode;
+		if (!Grid.HasUniformCosts() && (Mode == EPathSearchMode::JumpPoint || Mode == EPathSearchMode::JumpPointPlus || Mode == EPathSearchMode::Hierarchical || Mode == EPathSearchMode::AnyAngle))
+		{
+			Mode = EPathSearchMode::AStar;
+		}
+
+		bool bFound;
+		switch (Mode)
+		{
+		case EPathSearchMode::JumpPoint:
+			bFound = FJumpPointSearch::FindPath(Grid, CacheKey.StartId, CacheKey.TargetId, CellPath, Cancellation, &Stats);
+			break;
+		case EPathSearchMode::JumpPointPlus:
+			bFound = FJumpPointSearch::FindPath(Grid.GetJumpPoints(), CacheKey.StartId, CacheKey.TargetId, CellPath, Cancellation, &Stats);
+			break;
+		case EPathSearchMode::WeightedAStar:
+			bFound = FGridAStar::FindPathWeighted(Grid, CacheKey.StartId, CacheKey.TargetId, CacheKey.SuboptimalityBound, CellPath, Cancellation, &Stats);
+			break;
+		case EPathSearchMode::Focal:
+			bFound = FFocalSearch::FindPath(Grid, CacheKey.StartId, CacheKey.TargetId, CacheKey.SuboptimalityBound, CellPath, Cancellation, &Stats);
+			break;
+		case EPathSearchMode::Hierarchical:
+			bFound = Grid.GetHierarchy().FindPath(CacheKey.StartId, CacheKey.TargetId, CellPath, Cancellation, &Stats);
+			break;
+		case EPathSearchMode::AnyAngle:
+			bFound = FThetaStar::FindPath(Grid, CacheKey.StartId, CacheKey.TargetId, CellPath, Cancellation, &Stats);
+			break;
+		default:
+			bFound = FindAStarPath(Grid, CacheKey.StartId, CacheKey.TargetId, CellPath, Cancellation, &Stats);
+			break;
+		}
+		if (!bFound || CellPath.empty())
+		{
+			return FPathBuffer();
+		}
+		Grid.ResolveCells(Path);
+
+		// Agents walk the segments between the turning points of an any-angle path, so the cells under them decide
+		// whether the path stays valid. Kept per thread so the worker threads don't allocate them for every query.
+		static thread_local std::vector<int32> CrossedCells;
+		CrossedCells.clear();
+		if (Mode == EPathSearchMode::AnyAngle)
+		{
+			int32 FromId = CacheKey.StartId;
+			for (int32 CellId : CellPath)
+			{
+				FThetaStar::GetCrossedCells(Grid, FromId, CellId, CrossedCells);
+				FromId = CellId;
+			}
+		}
+
+		Grid.GetPathCache().Add(CacheKey, Path, CacheEpoch, TArrayView<const int32>(CrossedCells.data(), int32(CrossedCells.size())));
+		return Path;
+	}
+
+	/** Fills in what a record takes from the key and path of its query and hands it to FPathQueryProfiler */
+	void RecordQuery(const FPathGrid& Grid, const FPathCacheKey& CacheKey, const FPathBuffer& Path, FPathQueryRecord& Record)
+	{
+		Record.GridVersion = CacheKey.GridVersion;
+		Record.Start = Grid.GetCoord(CacheKey.StartId);
+		Record.Target = Grid.GetCoord(CacheKey.TargetId);
+		Record.Mode = CacheKey.Mode;
+		Record.SuboptimalityBound = CacheKey.SuboptimalityBound;
+		Record.PathLength = Path.NumCellIds();
+		Record.ThreadId = FPlatformTLS::GetCurrentThreadId();
+		FPathQueryProfiler::Get().Record(Record);
+	}
+
+	/** GetPath between two cell ids of the grid, timed and recorded with FPathQueryProfiler */
+	FPathBuffer RunQuery(FPathGrid& Grid, int32 StartId, int32 TargetId, EPathSearchMode Mode, const FPathCancellationToken* Cancellation, float SuboptimalityBound, uint64 StartCycles)
+	{
+		const bool bBounded = Mode == EPathSearchMode::WeightedAStar || Mode == EPathSearchMode::Focal;
+		const FPathCacheKey CacheKey(StartId, TargetId, Grid.GetVersion(), Mode, bBounded ? FMath::Max(SuboptimalityBound, 0.0f) : 0.0f);
+
+		FPathQueryRecord Record;
+		FPathBuffer Path = FindPath(Grid, CacheKey, Cancellation, Record);
+		Record.Milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+		RecordQuery(Grid, CacheKey, Path, Record);
+		return Path;
+	}
+}
+
+FPathBuffer UFAStarNT::GetPath(ACellBase* StartCell,ACellBase* TargetCell,AGridGenerator* GridGenerator, EPathSearchMode Mode, const FPathCancellationToken* Cancellation, float SuboptimalityBound)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathQuery);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid = FPathGrid::FindOrBuild(GridGenerator, StartCell);
+	return RunQuery(*Grid, Grid->GetCellId(StartCell), Grid->GetCellId(TargetCell), Mode, Cancellation, SuboptimalityBound, StartCycles);
+}
+FPathBuffer UFAStarNT::GetPath(ACellGrid* CellGrid, int32 StartId, int32 TargetId, EPathSearchMode Mode, const FPathCancellationToken* Cancellation, float SuboptimalityBound)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathQuery);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid = FPathGrid::FindOrBuild(CellGrid);
+	return RunQuery(*Grid, StartId, TargetId, Mode, Cancellation, SuboptimalityBound, StartCycles);
+}
+FPathBuffer UFAStarNT::GetAStarPath(ACellBase* StartCell,ACellBase* TargetCell,AGridGenerator* GridGenerator, const FPathCancellationToken* Cancellation)
+{
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid = FPathGrid::FindOrBuild(GridGenerator, StartCell);
+
+	const int32 StartId = Grid->GetCellId(StartCell);
+	const int32 TargetId = Grid->GetCellId(TargetCell);
+	FPathBuffer Path = FPathBufferPool::Get().Acquire();
+	if (RejectUnreachable(*Grid, StartId, TargetId) || !FindAStarPath(*Grid, StartId, TargetId, Path.GetCellIds(), Cancellation))
+	{
+		return FPathBuffer();
+	}
+	Grid->ResolveCells(Path);
+	return Path;
+}
+template <typename HeuristicPolicy>
+FPathBuffer UFAStarNT::GetAStarPath(ACellBase* StartCell,ACellBase* TargetCell,AGridGenerator* GridGenerator, const FPathCancellationToken* Cancellation)
+{
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid = FPathGrid::FindOrBuild(GridGenerator, StartCell);
+
+	const int32 StartId = Grid->GetCellId(StartCell);
+	const int32 TargetId = Grid->GetCellId(TargetCell);
+	FPathBuffer Path = FPathBufferPool::Get().Acquire();
+	if (RejectUnreachable(*Grid, StartId, TargetId) || !FGridAStar::FindPath<HeuristicPolicy>(*Grid, StartId, TargetId, Path.GetCellIds(), Cancellation))
+	{
+		return FPathBuffer();
+	}
+	Grid->ResolveCells(Path);
+	return Path;
+}
+void UFAStarNT::GetPathsToTarget(const TArray<ACellBase*>& StartCells, ACellBase* TargetCell, AGridGenerator* GridGenerator, TArray<FPathBuffer>& OutPaths, const FPathCancellationToken* Cancellation)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid = FPathGrid::FindOrBuild(GridGenerator, TargetCell);
+	const int32 TargetId = Grid->GetCellId(TargetCell);
+
+	OutPaths.Reset();
+	OutPaths.SetNum(StartCells.Num());
+
+	// Every start is recorded as a query of its own. Those the search reaches get the stats and time of the
+	// shared search up to where their path came out, those it never reaches the stats and time of all of it.
+	TArray<FPathQueryRecord> Records;
+	Records.SetNum(StartCells.Num());
+	FPathSearchStats Stats;
+	auto RecordQueries = [&]()
+	{
+		const double Milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+		for (int32 i = 0; i < StartCells.Num(); ++i)
+		{
+			FPathQueryRecord& Record = Records[i];
+			if (!Record.bCacheHit && Record.Search.NodesExpanded == 0)
+			{
+				Record.Search = Stats;
+				Record.Milliseconds = Milliseconds;
+			}
+			RecordQuery(*Grid, FPathCacheKey(Grid->GetCellId(StartCells[i]), TargetId, Grid->GetVersion(), EPathSearchMode::AStar), OutPaths[i], Record);
+		}
+	};
+
+	// Starts served from the cache, sitting on the target or cut off from it need no search. A single cut off
+	// start would otherwise keep the backward search running until it flooded the whole target component.
+	TMap<int32, int32> StartIndices;
+	for (int32 i = 0; i < StartCells.Num(); ++i)
+	{
+		const int32 StartId = Grid->GetCellId(StartCells[i]);
+		if (StartIndices.Contains(StartId))
+		{
+			continue;
+		}
+		Records[i].bCacheHit = StartId == TargetId || RejectUnreachable(*Grid, StartId, TargetId) || Grid->GetPathCache().Find(FPathCacheKey(StartId, TargetId, Grid->GetVersion(), EPathSearchMode::AStar), OutPaths[i]);
+		if (Records[i].bCacheHit)
+		{
+			Records[i].Milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+		}
+		else
+		{
+			StartIndices.Add(StartId, i);
+		}
+	}
+	if (StartIndices.Num() == 0 || !Grid->IsWalkable(TargetId))
+	{
+		RecordQueries();
+		return;
+	}
+
+	TArray<int32> StartIds;
+	StartIndices.GenerateKeyArray(StartIds);
+
+	// The closest start bounds the remaining cost from every node, past a handful of starts the min costs more than it saves
+	const int32 MaxHeuristicStarts = 16;
+	auto GetHeuristic = [&Grid, &StartIds, MaxHeuristicStarts](int32 CellId)
+	{
+		if (StartIds.Num() > MaxHeuristicStarts)
+		{
+			return 0;
+		}
+		int32 Best = MAX_int32;
+		for (int32 StartId : StartIds)
+		{
+			Best = FMath::Min(Best, Grid->GetOctileDistance(CellId, StartId));
+		}
+		return Best;
+	};
+
+	// Paths are cached as they come out, unless a cell was blocked since the search started
+	const uint32 CacheEpoch = Grid->GetPathCache().GetInvalidationEpoch();
+	FScopedNodeTable Nodes(*Grid);
+	FAStarOpenSet OpenSet(*Nodes, &Stats);
+	const FEdgeCostSnapshot EdgeCosts = Grid->GetEdgeCosts();
+
+	Nodes->Visit(TargetId);
+	Nodes->SetGCost(TargetId, 0);
+	Nodes->SetHCost(TargetId, GetHeuristic(TargetId));
+	OpenSet.Push(TargetId);
+	++Stats.NodesGenerated;
+
+	// Moves are symmetric, so the parent chain from a start leads forward to the target
+	int32 StartsLeft = StartIds.Num();
+	bool bCancelled = false;
+	while (!OpenSet.IsEmpty() && StartsLeft > 0)
+	{
+		if (Cancellation && Cancellation->IsCancelled())
+		{
+			bCancelled = true;
+			break;
+		}
+
+		const int32 CurrentId = OpenSet.Pop();
+		++Stats.NodesExpanded;
+		if (const int32* StartIndex = StartIndices.Find(CurrentId))
+		{
+			FPathBuffer& Path = OutPaths[*StartIndex];
+			Path = FPathBufferPool::Get().Acquire();
+			std::vector<int32>& CellPath = Path.GetCellIds();
+			for (int32 CellId = Nodes->GetParent(CurrentId); ; CellId = Nodes->GetParent(CellId))
+			{
+				CellPath.push_back(CellId);
+				if (CellId == TargetId)
+				{
+					break;
+				}
+			}
+			Grid->ResolveCells(Path);
+			Grid->GetPathCache().Add(FPathCacheKey(CurrentId, TargetId, Grid->GetVersion(), EPathSearchMode::AStar), Path, CacheEpoch);
+			--StartsLeft;
+
+			Records[*StartIndex].Search = Stats;
+			Records[*StartIndex].Milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+			// A forward search may leave a blocked start but never pass through one
+			if (!Grid->IsWalkable(CurrentId))
+			{
+				continue;
+			}
+		}
+
+		Stats.NeighboursEvaluated += Grid->GetEndEdge(CurrentId) - Grid->GetFirstEdge(CurrentId);
+		for (int32 Edge = Grid->GetFirstEdge(CurrentId); Edge < Grid->GetEndEdge(CurrentId); ++Edge)
+		{
+			const int32 NeighbourId = Grid->GetEdgeTarget(Edge);
+			if ((!Grid->IsWalkable(NeighbourId) && !StartIndices.Contains(NeighbourId)) || Nodes->IsClosed(NeighbourId) || !Grid->IsMoveAllowed(CurrentId, NeighbourId))
+			{
+				continue;
+			}
+
+			if (!Nodes->IsVisited(NeighbourId))
+			{
+				Nodes->Visit(NeighbourId);
+			}
+
+			const bool bInOpenSet = OpenSet.Contains(NeighbourId);
+			const int32 MovementCost = Nodes->GetGCost(CurrentId) + EdgeCosts[Edge];
+			if (MovementCost < Nodes->GetGCost(NeighbourId) || !bInOpenSet)
+			{
+				Nodes->SetGCost(NeighbourId, MovementCost);
+				Nodes->SetHCost(NeighbourId, GetHeuristic(NeighbourId));
+				Nodes->SetParent(NeighbourId, CurrentId);
+
+				if (bInOpenSet)
+				{
+					OpenSet.Update(NeighbourId);
+				}
+				else
+				{
+					OpenSet.Push(NeighbourId);
+					++Stats.NodesGenerated;
+				}
+			}
+		}
+	}
+
+	// Repeated starts share the path found for their first occurrence
+	for (int32 i = 0; i < StartCells.Num(); ++i)
+	{
+		const int32* StartIndex = StartIndices.Find(Grid->GetCellId(StartCells[i]));
+		if (StartIndex && *StartIndex != i)
+		{
+			OutPaths[i] = OutPaths[*StartIndex];
+			Records[i] = Records[*StartIndex];
+		}
+	}
+
+	if (bCancelled)
+	{
+		OutPaths.Reset();
+		OutPaths.SetNum(StartCells.Num());
+	}
+	RecordQueries();
+}
+
+FPathBuffer UFAStarNT::GetPathToNearest(ACellBase* StartCell, const TArray<ACellBase*>& TargetCells, AGridGenerator* GridGenerator, int32& OutTargetIndex, const FPathCancellationToken* Cancellation)
+{
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid = FPathGrid::FindOrBuild(GridGenerator, StartCell);
+	const int32 StartId = Grid->GetCellId(StartCell);
+	OutTargetIndex = INDEX_NONE;
+
+	// Targets in other components would only pull the search towards cells it can never reach
+	std::vector<int32> TargetIds;
+	TArray<int32> TargetIndices;
+	for (int32 i = 0; i < TargetCells.Num(); ++i)
+	{
+		const int32 TargetId = Grid->GetCellId(TargetCells[i]);
+		if (!RejectUnreachable(*Grid, StartId, TargetId))
+		{
+			TargetIds.push_back(TargetId);
+			TargetIndices.Add(i);
+		}
+	}
+
+	const uint32 CacheEpoch = Grid->GetPathCache().GetInvalidationEpoch();
+	FPathBuffer Path = FPathBufferPool::Get().Acquire();
+	int32 ReachedIndex;
+	if (TargetIds.empty() || !FGridAStar::FindPathToNearest(*Grid, StartId, TargetIds, Path.GetCellIds(), ReachedIndex, Cancellation))
+	{
+		return FPathBuffer();
+	}
+	OutTargetIndex = TargetIndices[ReachedIndex];
+	Grid->ResolveCells(Path);
+
+	// The path is an optimal one to the target it reached, so plain A* queries between the two can reuse it
+	if (!Path.IsEmpty())
+	{
+		Grid->GetPathCache().Add(FPathCacheKey(StartId, TargetIds[ReachedIndex], Grid->GetVersion(), EPathSearchMode::AStar), Path, CacheEpoch);
+	}
+	return Path;
+}
+template FPathBuffer UFAStarNT::GetAStarPath<FOctileHeuristic>(ACellBase*, ACellBase*, AGridGenerator*, const FPathCancellationToken*);
+template FPathBuffer UFAStarNT::GetAStarPath<FManhattanHeuristic>(ACellBase*, ACellBase*, AGridGenerator*, const FPathCancellationToken*);
+ACellBase* UFAStarNT::GetNearestReachableCell(ACellBase* StartCell, ACellBase* TargetCell, AGridGenerator* GridGenerator)
+{
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid = FPathGrid::FindOrBuild(GridGenerator, StartCell);
+	const int32 CellId = Grid->GetComponents().FindNearestReachableCell(Grid->GetCellId(StartCell), Grid->GetCellId(TargetCell));
+	return CellId != INDEX_NONE ? Grid->GetCell(CellId) : nullptr;
+}
+int32 UFAStarNT::GetNearestReachableCellId(ACellGrid* CellGrid, int32 StartId, int32 TargetId)
+{
+	return FPathGrid::FindOrBuild(CellGrid)->GetComponents().FindNearestReachableCell(StartId, TargetId);
+}
+FPathBuffer UFAStarNT::RetracePath(const FPathGrid& Grid, const FAStarNodeTable& Nodes, int32 StartId, int32 TargetId)
+{
+	FPathBuffer Path = FPathBufferPool::Get().Acquire();
+	FGridAStar::RetracePath(Nodes, StartId, TargetId, Path.GetCellIds());
+	Grid.ResolveCells(Path);
+	return Path;
+}
+
+float UFAStarNT::GetDistance(ACellBase * CellA, ACellBase * CellB)
+{
+	return uint16(FVector2D::Distance(FVector2D(CellA->GetActorLocation()), FVector2D(CellB->GetActorLocation())));
+}
@@ -1,20 +1,68 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "UObject/NoExportTypes.h"
-#include "FAStarNT.generated.h"
-
-/**
- * 
- */
-UCLASS()
-class INVADED_API UFAStarNT : public UObject
-{
-	GENERATED_BODY()
-public:
-	static TArray<class ACellBase*> GetPath(class ACellBase* StartCell,class ACellBase* TargetCell,class AGridGenerator* GridGenerator);
-	static TArray<class ACellBase*> RetracePath(class ACellBase* Start, class ACellBase* Target);
-	static float GetDistance(class ACellBase* CellA,class ACellBase* CellB);
-};
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "PathfindingTypes.h"
+#include "FAStarNT.generated.h"
+
+class FPathGrid;
+class FAStarNodeTable;
+
+/**
+ * Path queries over the grid of a generator. Paths come back in pooled buffers shared with the path cache,
+ * see FPathBuffer, so a query that is answered from the cache or finds its path copies nothing.
+ */
+UCLASS()
+class INVADED_API UFAStarNT : public UObject
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * Finds a path with the given algorithm, a cancelled token stops the search and yields an empty path.
+	 * SuboptimalityBound is the epsilon of the WeightedAStar and Focal modes and ignored by the others.
+	 */
+	static FPathBuffer GetPath(class ACellBase* StartCell,class ACellBase* TargetCell,class AGridGenerator* GridGenerator, EPathSearchMode Mode = EPathSearchMode::AStar, const FPathCancellationToken* Cancellation = nullptr, float SuboptimalityBound = 0.0f);
+
+	/**
+	 * GetPath between two cells of a packed grid, searched straight on its arrays. The path holds cell ids only,
+	 * see FPathBuffer::GetCellIdView and ACellGrid::GetCellLocation. On grids with weighted cells the JumpPoint,
+	 * JumpPointPlus, Hierarchical and AnyAngle modes fall back to A*, they assume every step of a direction costs the same.
+	 */
+	static FPathBuffer GetPath(class ACellGrid* CellGrid, int32 StartId, int32 TargetId, EPathSearchMode Mode = EPathSearchMode::AStar, const FPathCancellationToken* Cancellation = nullptr, float SuboptimalityBound = 0.0f);
+
+	/** A* with the landmark heuristic once FPathGrid::BuildLandmarks finished for the grid, with the octile one until then */
+	static FPathBuffer GetAStarPath(class ACellBase* StartCell,class ACellBase* TargetCell,class AGridGenerator* GridGenerator, const FPathCancellationToken* Cancellation = nullptr);
+
+	/** A* with the heuristic policy picked at compile time, FOctileHeuristic or FManhattanHeuristic from PathHeuristics.h */
+	template <typename HeuristicPolicy>
+	static FPathBuffer GetAStarPath(class ACellBase* StartCell,class ACellBase* TargetCell,class AGridGenerator* GridGenerator, const FPathCancellationToken* Cancellation = nullptr);
+
+	/**
+	 * TargetCell when a path from StartCell reaches it, otherwise the reachable cell closest to it, for agents that
+	 * should get as near as they can to a walled-off goal. Answered from the grid components, no search runs.
+	 * nullptr when StartCell is enclosed on every side.
+	 */
+	static class ACellBase* GetNearestReachableCell(class ACellBase* StartCell, class ACellBase* TargetCell, class AGridGenerator* GridGenerator);
+
+	/** GetNearestReachableCell on a packed grid, INDEX_NONE when StartId is enclosed on every side */
+	static int32 GetNearestReachableCellId(class ACellGrid* CellGrid, int32 StartId, int32 TargetId);
+
+	/**
+	 * Paths from many starts to one target from a single backward A* out of the target, for agents converging on one spot.
+	 * OutPaths[i] belongs to StartCells[i] and has the same form as GetPath, empty when that start can't reach the target.
+	 */
+	static void GetPathsToTarget(const TArray<class ACellBase*>& StartCells, class ACellBase* TargetCell, class AGridGenerator* GridGenerator, TArray<FPathBuffer>& OutPaths, const FPathCancellationToken* Cancellation = nullptr);
+
+	/**
+	 * Path to whichever of TargetCells is cheapest to reach, from one search instead of a GetPath per candidate, for goals
+	 * like the nearest health pack. OutTargetIndex gets the index of the reached cell in TargetCells, INDEX_NONE along
+	 * with an empty path when none of them can be reached. See FGridAStar::FindPathToNearest for how it searches.
+	 */
+	static FPathBuffer GetPathToNearest(class ACellBase* StartCell, const TArray<class ACellBase*>& TargetCells, class AGridGenerator* GridGenerator, int32& OutTargetIndex, const FPathCancellationToken* Cancellation = nullptr);
+
+	/** Path from StartId to TargetId along the parents in the node table, written in walking order into a pooled buffer */
+	static FPathBuffer RetracePath(const FPathGrid& Grid, const FAStarNodeTable& Nodes, int32 StartId, int32 TargetId);
+	static float GetDistance(class ACellBase* CellA,class ACellBase* CellB);
+};
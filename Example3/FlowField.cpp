@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FlowField.h"
+#include "CellBase.h"
+#include "PathGrid.h"
+
+FFlowField::FFlowField(const TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& InGrid, int32 InTargetId)
+	: Grid(InGrid)
+	, Field(*InGrid, InTargetId)
+{
+}
+
+TSharedPtr<FFlowField, ESPMode::ThreadSafe> FFlowField::FindOrBuild(ACellBase* TargetCell, AGridGenerator* GridGenerator)
+{
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid = FPathGrid::FindOrBuild(GridGenerator, TargetCell);
+	const int32 TargetId = Grid->GetCellId(TargetCell);
+
+	TSharedPtr<FFlowField, ESPMode::ThreadSafe> Field = Grid->FindFlowField(TargetId);
+	if (!Field.IsValid())
+	{
+		Field = MakeShared<FFlowField, ESPMode::ThreadSafe>(Grid, TargetId);
+		Field->Build();
+		Grid->AddFlowField(Field);
+	}
+	return Field;
+}
+
+void FFlowField::Build()
+{
+	Field.Build();
+}
+
+void FFlowField::NotifyCellsChanged(const TArray<int32>& ChangedCells)
+{
+	Field.NotifyCellsChanged(std::vector<int32>(ChangedCells.GetData(), ChangedCells.GetData() + ChangedCells.Num()));
+}
+
+ACellBase* FFlowField::GetNextCell(ACellBase* Cell) const
+{
+	const int32 NextId = GetNextCell(Grid->GetCellId(Cell));
+	return NextId != INDEX_NONE ? Grid->GetCell(NextId) : nullptr;
+}
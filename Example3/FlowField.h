@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathfindingCore/GridFlowField.h"
+
+class ACellBase;
+class AGridGenerator;
+class FPathGrid;
+
+/**
+ * Flow field towards one target, shared by every agent heading there.
+ * Wraps the FGridFlowField of the grid and keeps the grid alive for as long as agents hold the field,
+ * an agent just follows the direction of the cell it stands on.
+ */
+class INVADED_API FFlowField
+{
+public:
+	static constexpr int32 Unreachable = FGridFlowField::Unreachable;
+	static constexpr uint8 NoDirection = FGridFlowField::NoDirection;
+
+	FFlowField(const TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& InGrid, int32 InTargetId);
+
+	/** Returns the field shared by all agents heading to the target, built on first use */
+	static TSharedPtr<FFlowField, ESPMode::ThreadSafe> FindOrBuild(ACellBase* TargetCell, AGridGenerator* GridGenerator);
+
+	/** Computes both fields from scratch */
+	void Build();
+
+	/** Patches the fields around cells whose walkability changed, only cells whose distance depends on them are recomputed */
+	void NotifyCellsChanged(const TArray<int32>& ChangedCells);
+
+	int32 GetTargetId() const { return Field.GetTargetId(); }
+
+	int32 GetDistance(int32 CellId) const { return Field.GetDistance(CellId); }
+	uint8 GetDirection(int32 CellId) const { return Field.GetDirection(CellId); }
+
+	/** Cell to step to from CellId, INDEX_NONE at the target or where the target can't be reached */
+	int32 GetNextCell(int32 CellId) const { return Field.GetNextCell(CellId); }
+	ACellBase* GetNextCell(ACellBase* Cell) const;
+
+	SIZE_T GetAllocatedSize() const { return Field.GetAllocatedSize(); }
+
+private:
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid;
+	FGridFlowField Field;
+};
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathBufferPool.h"
+#include "Misc/ScopeLock.h"
+#include "PathfindingStats.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Path Buffers"), STAT_PathBuffers, STATGROUP_Pathfinding);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Path Buffers In Use"), STAT_PathBuffersInUse, STATGROUP_Pathfinding);
+
+FPathBuffer::FPathBuffer(const FPathBuffer& Other)
+	: Storage(Other.Storage)
+{
+	if (Storage)
+	{
+		Storage->RefCount.Increment();
+	}
+}
+
+FPathBuffer::FPathBuffer(FPathBuffer&& Other)
+	: Storage(Other.Storage)
+{
+	Other.Storage = nullptr;
+}
+
+FPathBuffer::~FPathBuffer()
+{
+	Release();
+}
+
+FPathBuffer& FPathBuffer::operator=(const FPathBuffer& Other)
+{
+	if (Storage != Other.Storage)
+	{
+		Release();
+		Storage = Other.Storage;
+		if (Storage)
+		{
+			Storage->RefCount.Increment();
+		}
+	}
+	return *this;
+}
+
+FPathBuffer& FPathBuffer::operator=(FPathBuffer&& Other)
+{
+	if (this != &Other)
+	{
+		Release();
+		Storage = Other.Storage;
+		Other.Storage = nullptr;
+	}
+	return *this;
+}
+
+void FPathBuffer::Release()
+{
+	if (Storage && Storage->RefCount.Decrement() == 0)
+	{
+		FPathBufferPool::Get().Return(Storage);
+	}
+	Storage = nullptr;
+}
+
+TArrayView<ACellBase* const> FPathBuffer::GetView() const
+{
+	return Storage ? TArrayView<ACellBase* const>(Storage->Cells.GetData(), Storage->Cells.Num()) : TArrayView<ACellBase* const>();
+}
+
+TArrayView<const int32> FPathBuffer::GetCellIdView() const
+{
+	return Storage ? TArrayView<const int32>(Storage->CellIds.data(), int32(Storage->CellIds.size())) : TArrayView<const int32>();
+}
+
+TArray<ACellBase*> FPathBuffer::ToArray() const
+{
+	return Storage ? Storage->Cells : TArray<ACellBase*>();
+}
+
+TArray<ACellBase*>& FPathBuffer::GetMutableCells()
+{
+	check(Storage && Storage->RefCount.GetValue() == 1);
+	return Storage->Cells;
+}
+
+std::vector<int32>& FPathBuffer::GetCellIds()
+{
+	check(Storage && Storage->RefCount.GetValue() == 1);
+	return Storage->CellIds;
+}
+
+SIZE_T FPathBuffer::GetAllocatedSize() const
+{
+	return Storage ? Storage->Cells.GetAllocatedSize() + Storage->CellIds.capacity() * sizeof(int32) : 0;
+}
+
+FPathBufferPool& FPathBufferPool::Get()
+{
+	// Never destroyed, cached paths held by other statics are released during their own shutdown
+	static FPathBufferPool* Pool = new FPathBufferPool();
+	return *Pool;
+}
+
+FPathBuffer FPathBufferPool::Acquire()
+{
+	FPathBufferStorage* Storage;
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (FreeBuffers.Num() > 0)
+		{
+			Storage = FreeBuffers.Pop(false);
+		}
+		else
+		{
+			// Room for every buffer on the free list up front, so returning one never allocates
+			Storage = new FPathBufferStorage();
+			Buffers.Add(Storage);
+			FreeBuffers.Reserve(Buffers.Num());
+			INC_DWORD_STAT(STAT_PathBuffers);
+		}
+	}
+
+	INC_DWORD_STAT(STAT_PathBuffersInUse);
+	Storage->RefCount.Set(1);
+	return FPathBuffer(Storage);
+}
+
+void FPathBufferPool::Return(FPathBufferStorage* Storage)
+{
+	Storage->Cells.Reset();
+	Storage->CellIds.clear();
+	DEC_DWORD_STAT(STAT_PathBuffersInUse);
+
+	FScopeLock ScopeLock(&Lock);
+	FreeBuffers.Add(Storage);
+}
+
+void FPathBufferPool::Trim()
+{
+	FScopeLock ScopeLock(&Lock);
+	for (FPathBufferStorage* Storage : FreeBuffers)
+	{
+		Buffers.RemoveSingleSwap(Storage, false);
+		delete Storage;
+		DEC_DWORD_STAT(STAT_PathBuffers);
+	}
+	FreeBuffers.Empty();
+}
+
+int32 FPathBufferPool::GetNumBuffers() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Buffers.Num();
+}
+
+int32 FPathBufferPool::GetNumFreeBuffers() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return FreeBuffers.Num();
+}
+
+SIZE_T FPathBufferPool::GetAllocatedSize() const
+{
+	FScopeLock ScopeLock(&Lock);
+	SIZE_T Size = Buffers.GetAllocatedSize() + FreeBuffers.GetAllocatedSize();
+	for (const FPathBufferStorage* Storage : Buffers)
+	{
+		Size += sizeof(FPathBufferStorage) + Storage->Cells.GetAllocatedSize() + Storage->CellIds.capacity() * sizeof(int32);
+	}
+	return Size;
+}
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include <vector>
+
+class ACellBase;
+
+/** Memory behind an FPathBuffer, recycled by FPathBufferPool with its allocations intact */
+struct FPathBufferStorage
+{
+	/** Cells after the start up to the target, in walking order */
+	TArray<ACellBase*> Cells;
+
+	/** Cell ids the core searches write the path into before it is resolved to cells */
+	std::vector<int32> CellIds;
+
+	FThreadSafeCounter RefCount;
+};
+
+/**
+ * Handle to a path held in a pooled buffer. Copies share the buffer and the last handle to go hands
+ * it back to FPathBufferPool, so a path is written once by the search and then passed through the
+ * path cache to the requester without being copied. A default handle is an empty path.
+ * The buffer is written only by whoever acquired it, before the handle is shared.
+ */
+class INVADED_API FPathBuffer
+{
+public:
+	FPathBuffer() : Storage(nullptr) {}
+	FPathBuffer(const FPathBuffer& Other);
+	FPathBuffer(FPathBuffer&& Other);
+	~FPathBuffer();
+
+	FPathBuffer& operator=(const FPathBuffer& Other);
+	FPathBuffer& operator=(FPathBuffer&& Other);
+
+	/** Lets go of the buffer, it goes back to the pool once no other handle shares it */
+	void Release();
+
+	/**
+	 * Cell actors on the path, what operator[], Last, GetView and iteration cover. Paths on packed grids leave the
+	 * actors out and fill in the cell ids only (see ACellGrid), so there this is zero, count the steps with NumCellIds.
+	 */
+	int32 Num() const { return Storage ? Storage->Cells.Num() : 0; }
+
+	/** Steps on the path on any grid */
+	int32 NumCellIds() const { return Storage ? int32(Storage->CellIds.size()) : 0; }
+
+	/** True when there is no path, on packed grids as well */
+	bool IsEmpty() const { return NumCellIds() == 0; }
+
+	/** Ids of the cells on the path, in the same order as the cells */
+	TArrayView<const int32> GetCellIdView() const;
+
+	ACellBase* operator[](int32 Index) const { return Storage->Cells[Index]; }
+	ACellBase* Last() const { return Storage->Cells.Last(); }
+
+	TArrayView<ACellBase* const> GetView() const;
+
+	ACellBase* const* begin() const { return Storage ? Storage->Cells.GetData() : nullptr; }
+	ACellBase* const* end() const { return Storage ? Storage->Cells.GetData() + Storage->Cells.Num() : nullptr; }
+
+	/** Copy owned by the caller, for code that wants to edit the path */
+	TArray<ACellBase*> ToArray() const;
+
+	/** Writer side, only while this is the one handle to a buffer fresh from FPathBufferPool::Acquire */
+	TArray<ACellBase*>& GetMutableCells();
+	std::vector<int32>& GetCellIds();
+
+	/** Memory held by the buffer, shared with every other handle to it */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	friend class FPathBufferPool;
+
+	explicit FPathBuffer(FPathBufferStorage* InStorage) : Storage(InStorage) {}
+
+	FPathBufferStorage* Storage;
+};
+
+/**
+ * Path buffers owned by the pathfinding system. Released buffers are kept with their capacity and
+ * handed out again, so once the pool has grown to the number of paths alive at a time, queries get
+ * their buffers without touching the heap.
+ */
+class INVADED_API FPathBufferPool
+{
+public:
+	static FPathBufferPool& Get();
+
+	/** Empty buffer to write a path into, a released one when there is one */
+	FPathBuffer Acquire();
+
+	/** Frees the buffers nobody holds, for after a burst of queries or very long paths */
+	void Trim();
+
+	int32 GetNumBuffers() const;
+	int32 GetNumFreeBuffers() const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	friend class FPathBuffer;
+
+	FPathBufferPool() {}
+
+	void Return(FPathBufferStorage* Storage);
+
+	mutable FCriticalSection Lock;
+	TArray<FPathBufferStorage*> Buffers;
+	TArray<FPathBufferStorage*> FreeBuffers;
+};
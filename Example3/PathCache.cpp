@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathCache.h"
+#include "Misc/ScopeLock.h"
+#include "PathfindingStats.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Cache Hits"), STAT_PathCacheHits, STATGROUP_Pathfinding);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Cache Misses"), STAT_PathCacheMisses, STATGROUP_Pathfinding);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Cache Invalidations"), STAT_PathCacheInvalidations, STATGROUP_Pathfinding);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Path Cache Entries"), STAT_PathCacheEntries, STATGROUP_Pathfinding);
+DECLARE_MEMORY_STAT(TEXT("Path Cache Memory"), STAT_PathCacheMemory, STATGROUP_Pathfinding);
+
+FPathCache::FPathCache(int32 InMaxEntries)
+{
+	MaxEntries = FMath::Max(InMaxEntries, 1);
+	Head = INDEX_NONE;
+	Tail = INDEX_NONE;
+	InvalidationEpoch = 0;
+
+	// Sized for a full cache up front, so a miss that evicts and inserts allocates nothing
+	Entries.Reserve(MaxEntries);
+	FreeEntries.Reserve(MaxEntries);
+	Lookup.Reserve(MaxEntries);
+}
+
+bool FPathCache::Find(const FPathCacheKey& Key, FPathBuffer& OutPath)
+{
+	FScopeLock ScopeLock(&Lock);
+	const int32* EntryIndex = Lookup.Find(Key);
+	if (!EntryIndex)
+	{
+		++Stats.Misses;
+		INC_DWORD_STAT(STAT_PathCacheMisses);
+		return false;
+	}
+
+	++Stats.Hits;
+	INC_DWORD_STAT(STAT_PathCacheHits);
+	Unlink(*EntryIndex);
+	Link(*EntryIndex);
+	OutPath = Entries[*EntryIndex].Path;
+	return true;
+}
+
+void FPathCache::Add(const FPathCacheKey& Key, const FPathBuffer& Path, uint32 SearchEpoch, TArrayView<const int32> CrossedCells)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (SearchEpoch != InvalidationEpoch || Lookup.Contains(Key))
+	{
+		return;
+	}
+
+	if (Lookup.Num() >= MaxEntries)
+	{
+		++Stats.Evictions;
+		Remove(Tail);
+	}
+
+	int32 EntryIndex;
+	if (FreeEntries.Num() > 0)
+	{
+		EntryIndex = FreeEntries.Pop(false);
+	}
+	else
+	{
+		EntryIndex = Entries.AddDefaulted();
+	}
+
+	FEntry& Entry = Entries[EntryIndex];
+	Entry.Key = Key;
+	Entry.Path = Path;
+	if (CrossedCells.Num() > 0)
+	{
+		Entry.Cells.Reset(CrossedCells.Num());
+		Entry.Cells.Append(CrossedCells.GetData(), CrossedCells.Num());
+	}
+	else
+	{
+		const TArrayView<const int32> CellIds = Path.GetCellIdView();
+		Entry.Cells.Reset(CellIds.Num());
+		Entry.Cells.Append(CellIds.GetData(), CellIds.Num());
+	}
+	Link(EntryIndex);
+	Lookup.Add(Key, EntryIndex);
+	for (int32 CellId : Entry.Cells)
+	{
+		EntriesByCell.FindOrAdd(CellId).AddUnique(EntryIndex);
+	}
+
+	INC_DWORD_STAT(STAT_PathCacheEntries);
+	INC_MEMORY_STAT_BY(STAT_PathCacheMemory, Entry.Path.GetAllocatedSize() + Entry.Cells.GetAllocatedSize());
+}
+
+void FPathCache::InvalidateCell(int32 CellId)
+{
+	FScopeLock ScopeLock(&Lock);
+	++InvalidationEpoch;
+
+	// Remove takes each entry off the list, which stays in the map, so the pointer holds for the whole loop
+	TArray<int32>* Crossing = EntriesByCell.Find(CellId);
+	while (Crossing && Crossing->Num() > 0)
+	{
+		++Stats.Invalidations;
+		INC_DWORD_STAT(STAT_PathCacheInvalidations);
+		Remove(Crossing->Last());
+	}
+}
+
+void FPathCache::Empty()
+{
+	FScopeLock ScopeLock(&Lock);
+	++InvalidationEpoch;
+	while (Tail != INDEX_NONE)
+	{
+		Remove(Tail);
+	}
+	Entries.Reset();
+	FreeEntries.Reset();
+	EntriesByCell.Empty();
+}
+
+FPathCacheStats FPathCache::GetStats() const
+{
+	FScopeLock ScopeLock(&Lock);
+	FPathCacheStats Result = Stats;
+	Result.NumEntries = Lookup.Num();
+	Result.AllocatedSize = Entries.GetAllocatedSize() + FreeEntries.GetAllocatedSize() + Lookup.GetAllocatedSize() + EntriesByCell.GetAllocatedSize();
+	for (const FEntry& Entry : Entries)
+	{
+		Result.AllocatedSize += Entry.Path.GetAllocatedSize() + Entry.Cells.GetAllocatedSize();
+	}
+	for (const auto& Pair : EntriesByCell)
+	{
+		Result.AllocatedSize += Pair.Value.GetAllocatedSize();
+	}
+	return Result;
+}
+
+void FPathCache::Link(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = Head;
+	if (Head != INDEX_NONE)
+	{
+		Entries[Head].Prev = EntryIndex;
+	}
+	Head = EntryIndex;
+	if (Tail == INDEX_NONE)
+	{
+		Tail = EntryIndex;
+	}
+}
+
+void FPathCache::Unlink(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+	if (Entry.Prev != INDEX_NONE)
+	{
+		Entries[Entry.Prev].Next = Entry.Next;
+	}
+	else
+	{
+		Head = Entry.Next;
+	}
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = Entry.Prev;
+	}
+	else
+	{
+		Tail = Entry.Prev;
+	}
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = INDEX_NONE;
+}
+
+void FPathCache::Remove(int32 EntryIndex)
+{
+	FEntry& Entry = Entries[EntryIndex];
+	for (int32 CellId : Entry.Cells)
+	{
+		if (TArray<int32>* Crossing = EntriesByCell.Find(CellId))
+		{
+			Crossing->RemoveSingleSwap(EntryIndex, false);
+		}
+	}
+
+	DEC_DWORD_STAT(STAT_PathCacheEntries);
+	DEC_MEMORY_STAT_BY(STAT_PathCacheMemory, Entry.Path.GetAllocatedSize() + Entry.Cells.GetAllocatedSize());
+
+	Unlink(EntryIndex);
+	Lookup.Remove(Entry.Key);
+	Entry.Path.Release();
+	Entry.Cells.Reset();
+	FreeEntries.Add(EntryIndex);
+}
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathfindingTypes.h"
+
+class ACellBase;
+
+/** Identifies a cached path, paths from an older grid version never match */
+struct FPathCacheKey
+{
+	int32 StartId;
+	int32 TargetId;
+	uint32 GridVersion;
+	EPathSearchMode Mode;
+
+	/** Epsilon of the bounded suboptimal modes, zero for every other mode */
+	float SuboptimalityBound;
+
+	FPathCacheKey(int32 InStartId, int32 InTargetId, uint32 InGridVersion, EPathSearchMode InMode, float InSuboptimalityBound = 0.0f)
+		: StartId(InStartId)
+		, TargetId(InTargetId)
+		, GridVersion(InGridVersion)
+		, Mode(InMode)
+		, SuboptimalityBound(InSuboptimalityBound)
+	{
+	}
+
+	bool operator==(const FPathCacheKey& Other) const
+	{
+		return StartId == Other.StartId && TargetId == Other.TargetId && GridVersion == Other.GridVersion && Mode == Other.Mode && SuboptimalityBound == Other.SuboptimalityBound;
+	}
+
+	friend uint32 GetTypeHash(const FPathCacheKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.StartId), GetTypeHash(Key.TargetId)), HashCombine(GetTypeHash(Key.GridVersion) ^ uint32(Key.Mode), GetTypeHash(Key.SuboptimalityBound)));
+	}
+};
+
+struct FPathCacheStats
+{
+	uint64 Hits;
+	uint64 Misses;
+	uint64 Evictions;
+	uint64 Invalidations;
+	int32 NumEntries;
+	SIZE_T AllocatedSize;
+
+	FPathCacheStats()
+	{
+		Hits = 0;
+		Misses = 0;
+		Evictions = 0;
+		Invalidations = 0;
+		NumEntries = 0;
+		AllocatedSize = 0;
+	}
+
+	float GetHitRate() const { return Hits + Misses > 0 ? float(Hits) / float(Hits + Misses) : 0.0f; }
+};
+
+/**
+ * LRU cache of found paths for one grid.
+ * Every cached path is indexed by the cells it crosses, so a walkability change only drops
+ * the paths through that cell. Paths stay cached when a cell opens up next to them; they are
+ * still valid, just possibly no longer the shortest.
+ */
+class INVADED_API FPathCache
+{
+public:
+	explicit FPathCache(int32 InMaxEntries = 1024);
+
+	/** Points OutPath at the cached path, which it shares with the cache instead of copying, false on a miss */
+	bool Find(const FPathCacheKey& Key, FPathBuffer& OutPath);
+
+	/**
+	 * Stores a found path, evicting the least recently used one when full. The cache keeps a handle to
+	 * the buffer, so the path must not change afterwards. Paths that skip cells between waypoints
+	 * (any-angle paths) pass the cells they cross, so blocking any of them still drops the path.
+	 * SearchEpoch is GetInvalidationEpoch from before the search, the path is refused if a cell was
+	 * invalidated since, as the invalidation may have come too early to find it.
+	 */
+	void Add(const FPathCacheKey& Key, const FPathBuffer& Path, uint32 SearchEpoch, TArrayView<const int32> CrossedCells = TArrayView<const int32>());
+
+	/** Drops every cached path crossing the cell */
+	void InvalidateCell(int32 CellId);
+
+	/** Bumped by every invalidation, take it before searching for a path to Add */
+	uint32 GetInvalidationEpoch() const { return InvalidationEpoch; }
+
+	void Empty();
+
+	FPathCacheStats GetStats() const;
+
+private:
+	struct FEntry
+	{
+		FPathCacheKey Key;
+		FPathBuffer Path;
+
+		/** Cells the entry is indexed by in EntriesByCell */
+		TArray<int32> Cells;
+
+		int32 Prev;
+		int32 Next;
+
+		FEntry() : Key(INDEX_NONE, INDEX_NONE, 0, EPathSearchMode::AStar), Prev(INDEX_NONE), Next(INDEX_NONE) {}
+	};
+
+	void Link(int32 EntryIndex);
+	void Unlink(int32 EntryIndex);
+	void Remove(int32 EntryIndex);
+
+	int32 MaxEntries;
+
+	TArray<FEntry> Entries;
+	TArray<int32> FreeEntries;
+
+	/** Most and least recently used entries */
+	int32 Head;
+	int32 Tail;
+
+	TMap<FPathCacheKey, int32> Lookup;
+
+	/** Lists emptied by evictions and invalidations stay in the map, so their allocations are reused */
+	TMap<int32, TArray<int32>> EntriesByCell;
+
+	mutable FCriticalSection Lock;
+	FPathCacheStats Stats;
+
+	/** Only changed under Lock, so an Add that sees it unchanged is never overtaken by the invalidation */
+	TAtomic<uint32> InvalidationEpoch;
+};
@@ -0,0 +1,603 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathGrid.h"
+#include "CellBase.h"
+#include "CellGrid.h"
+#include "GridGenerator.h"
+#include "FlowField.h"
+#include "PathfindingCore/GridFile.h"
+#include "PathfindingCore/HierarchicalPathfinder.h"
+#include "PathfindingCore/JumpPointTable.h"
+#include "PathfindingCore/LandmarkHeuristic.h"
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	/** Grids by the generator or packed cell grid they index */
+	FCriticalSection RegistryLock;
+	TMap<const AActor*, TSharedPtr<FPathGrid, ESPMode::ThreadSafe>> Registry;
+
+	FThreadSafeCounter NextVersion;
+
+	/** A build that keeps overlapping walkability changes gives up, the level is evidently not static */
+	const int32 MaxLandmarkBuildAttempts = 3;
+}
+
+struct FPathGrid::FMappedGridFile
+{
+	// Declared before the region so the region is unmapped first
+	TUniquePtr<IMappedFileHandle> Handle;
+	TUniquePtr<IMappedFileRegion> Region;
+	FGridFile File;
+};
+
+FPathGrid::FPathGrid()
+	: Components(*this)
+{
+	Generator = nullptr;
+	CellGrid = nullptr;
+	Version = 0;
+	WalkabilityEpoch = 0;
+}
+
+FPathGrid::~FPathGrid()
+{
+}
+
+TSharedPtr<FPathGrid, ESPMode::ThreadSafe> FPathGrid::FindOrBuild(AGridGenerator* GridGenerator, ACellBase* SeedCell)
+{
+	FScopeLock Lock(&RegistryLock);
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& Grid = Registry.FindOrAdd(GridGenerator);
+	if (!Grid.IsValid())
+	{
+		Grid = MakeShared<FPathGrid, ESPMode::ThreadSafe>();
+		Grid->Build(GridGenerator, SeedCell);
+	}
+	return Grid;
+}
+
+TSharedPtr<FPathGrid, ESPMode::ThreadSafe> FPathGrid::FindOrBuild(ACellGrid* CellGrid)
+{
+	FScopeLock Lock(&RegistryLock);
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& Grid = Registry.FindOrAdd(CellGrid);
+	if (!Grid.IsValid())
+	{
+		Grid = MakeShared<FPathGrid, ESPMode::ThreadSafe>();
+		Grid->Build(CellGrid);
+	}
+	return Grid;
+}
+
+void FPathGrid::Release(AGridGenerator* GridGenerator)
+{
+	FScopeLock Lock(&RegistryLock);
+	Registry.Remove(GridGenerator);
+}
+
+void FPathGrid::Release(ACellGrid* CellGrid)
+{
+	FScopeLock Lock(&RegistryLock);
+	Registry.Remove(CellGrid);
+}
+
+void FPathGrid::BuildLandmarks(AGridGenerator* GridGenerator, ACellBase* SeedCell, int32 NumLandmarks)
+{
+	StartLandmarksBuild(FindOrBuild(GridGenerator, SeedCell), NumLandmarks);
+}
+
+void FPathGrid::BuildLandmarks(ACellGrid* CellGrid, int32 NumLandmarks)
+{
+	StartLandmarksBuild(FindOrBuild(CellGrid), NumLandmarks);
+}
+
+void FPathGrid::StartLandmarksBuild(const TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& Grid, int32 NumLandmarks)
+{
+	// The grid file may already have brought the table along
+	const TSharedPtr<const FLandmarkTable, ESPMode::ThreadSafe> Current = Grid->GetLandmarks();
+	if (Current.IsValid() && Current->GetNumLandmarks() == NumLandmarks)
+	{
+		return;
+	}
+
+	Async(EAsyncExecution::ThreadPool, [Grid, NumLandmarks]()
+	{
+		const FString Directory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Pathfinding"));
+		IFileManager::Get().MakeDirectory(*Directory, true);
+
+		for (int32 Attempt = 0; Attempt < MaxLandmarkBuildAttempts; ++Attempt)
+		{
+			const uint32 Epoch = Grid->WalkabilityEpoch;
+
+			// The layout hash names the file, so every level and every state of its walls gets a table of its own
+			const FString Filename = FPaths::Combine(Directory, FString::Printf(TEXT("%016llx_%d.landmarks"), FLandmarkTable::GetGraphHash(*Grid), NumLandmarks));
+			TSharedPtr<FLandmarkTable, ESPMode::ThreadSafe> Table = MakeShared<FLandmarkTable, ESPMode::ThreadSafe>();
+			if (!Table->Load(TCHAR_TO_UTF8(*Filename), *Grid) || Table->GetNumLandmarks() != NumLandmarks)
+			{
+				Table->Build(*Grid, NumLandmarks);
+				if (Epoch == Grid->WalkabilityEpoch)
+				{
+					Table->Save(TCHAR_TO_UTF8(*Filename));
+				}
+			}
+
+			if (Grid->SetLandmarks(Table, Epoch))
+			{
+				return;
+			}
+		}
+	});
+}
+
+void FPathGrid::NotifyWalkabilityChanged(AGridGenerator* GridGenerator, ACellBase* Cell)
+{
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid;
+	{
+		FScopeLock Lock(&RegistryLock);
+		Grid = Registry.FindRef(GridGenerator);
+	}
+	if (Grid.IsValid() && Cell->GetCellId() != INDEX_NONE)
+	{
+		Grid->OnWalkabilityChanged(Cell->GetCellId());
+	}
+}
+
+void FPathGrid::NotifyWalkabilityChanged(ACellGrid* CellGrid, int32 CellId)
+{
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid;
+	{
+		FScopeLock Lock(&RegistryLock);
+		Grid = Registry.FindRef(CellGrid);
+	}
+	if (Grid.IsValid())
+	{
+		Grid->OnWalkabilityChanged(CellId);
+	}
+}
+
+TSharedPtr<FPathGrid, ESPMode::ThreadSafe> FPathGrid::FindByVersion(uint32 Version)
+{
+	FScopeLock Lock(&RegistryLock);
+	for (auto It = Registry.CreateIterator(); It; ++It)
+	{
+		if (It.Value().IsValid() && It.Value()->GetVersion() == Version)
+		{
+			return It.Value();
+		}
+	}
+	return nullptr;
+}
+
+bool FPathGrid::SaveMovingAIMap(const FString& Filename) const
+{
+	TArray<FString> Lines;
+	Lines.Add(TEXT("type octile"));
+	Lines.Add(FString::Printf(TEXT("height %d"), Height));
+	Lines.Add(FString::Printf(TEXT("width %d"), Width));
+	Lines.Add(TEXT("map"));
+	for (int32 Y = 0; Y < Height; ++Y)
+	{
+		FString Row;
+		Row.Reserve(Width);
+		for (int32 X = 0; X < Width; ++X)
+		{
+			Row.AppendChar(IsWalkable(X, Y) ? TEXT('.') : TEXT('@'));
+		}
+		Lines.Add(Row);
+	}
+	return FFileHelper::SaveStringArrayToFile(Lines, *Filename);
+}
+
+void FPathGrid::Build(AGridGenerator* GridGenerator, ACellBase* SeedCell)
+{
+	Generator = GridGenerator;
+	Version = NextVersion.Increment();
+	PathCache.Empty();
+
+	// Collect every cell of the generator, walkable or not
+	TArray<ACellBase*> Found;
+	TSet<ACellBase*> Seen;
+	Found.Add(SeedCell);
+	Seen.Add(SeedCell);
+	for (int32 i = 0; i < Found.Num(); ++i)
+	{
+		for (ACellBase* Neighbour : GridGenerator->GetNeighbours(Found[i]))
+		{
+			if (!Seen.Contains(Neighbour))
+			{
+				Seen.Add(Neighbour);
+				Found.Add(Neighbour);
+			}
+		}
+	}
+
+	// Cells are laid out on a regular lattice, recover the spacing and origin from their locations
+	FVector2D Origin(FVector2D(SeedCell->GetActorLocation()));
+	float Spacing = MAX_flt;
+	for (ACellBase* Cell : Found)
+	{
+		const FVector2D Location(Cell->GetActorLocation());
+		Origin.X = FMath::Min(Origin.X, Location.X);
+		Origin.Y = FMath::Min(Origin.Y, Location.Y);
+		for (ACellBase* Neighbour : GridGenerator->GetNeighbours(Cell))
+		{
+			const FVector2D Delta = (FVector2D(Neighbour->GetActorLocation()) - Location).GetAbs();
+			if (Delta.X > KINDA_SMALL_NUMBER)
+			{
+				Spacing = FMath::Min(Spacing, Delta.X);
+			}
+			if (Delta.Y > KINDA_SMALL_NUMBER)
+			{
+				Spacing = FMath::Min(Spacing, Delta.Y);
+			}
+		}
+	}
+	if (Spacing == MAX_flt)
+	{
+		Spacing = 1.0f;
+	}
+	// Truncated like UFAStarNT::GetDistance so every search mode agrees on path cost
+	const int32 CellStraightCost = int32(uint16(Spacing));
+	const int32 CellDiagonalCost = int32(uint16(Spacing * UE_SQRT_2));
+
+	TArray<FIntPoint> Coords;
+	Coords.SetNumUninitialized(Found.Num());
+	int32 GridWidth = 0;
+	int32 GridHeight = 0;
+	for (int32 i = 0; i < Found.Num(); ++i)
+	{
+		const FVector2D Offset = (FVector2D(Found[i]->GetActorLocation()) - Origin) / Spacing;
+		Coords[i] = FIntPoint(FMath::RoundToInt(Offset.X), FMath::RoundToInt(Offset.Y));
+		GridWidth = FMath::Max(GridWidth, Coords[i].X + 1);
+		GridHeight = FMath::Max(GridHeight, Coords[i].Y + 1);
+	}
+
+	Cells.Init(nullptr, GridWidth * GridHeight);
+	for (int32 i = 0; i < Found.Num(); ++i)
+	{
+		const int32 CellId = Coords[i].Y * GridWidth + Coords[i].X;
+		Cells[CellId] = Found[i];
+		Found[i]->SetCellId(CellId);
+	}
+
+	// Flatten the adjacency once so searches never ask the generator for neighbours again
+	std::vector<int32> Offsets(Cells.Num() + 1, 0);
+	std::vector<int32> Targets;
+	for (int32 CellId = 0; CellId < Cells.Num(); ++CellId)
+	{
+		Offsets[CellId] = int32(Targets.size());
+		if (Cells[CellId])
+		{
+			for (ACellBase* Neighbour : GridGenerator->GetNeighbours(Cells[CellId]))
+			{
+				Targets.push_back(Neighbour->GetCellId());
+			}
+		}
+	}
+	Offsets[Cells.Num()] = int32(Targets.size());
+	BuildAdjacency(GridWidth, GridHeight, Offsets, Targets, CellStraightCost, CellDiagonalCost);
+
+	RefreshWalkability();
+	BuildDerivedData();
+}
+
+void FPathGrid::Build(const ACellGrid* InCellGrid)
+{
+	Generator = nullptr;
+	CellGrid = InCellGrid;
+	Version = NextVersion.Increment();
+	PathCache.Empty();
+	Cells.Empty();
+
+	if (AttachGridFile(InCellGrid))
+	{
+		BuildDerivedData(MappedFile->File.GetComponentLabels());
+		return;
+	}
+	BuildFromCells(InCellGrid);
+	BuildDerivedData();
+}
+
+bool FPathGrid::WriteGridFile(const ACellGrid* CellGrid, int32 NumLandmarks)
+{
+	FPathGrid Grid;
+	Grid.CellGrid = CellGrid;
+	Grid.BuildFromCells(CellGrid);
+	Grid.Components.Build();
+
+	FLandmarkTable Table;
+	if (NumLandmarks > 0)
+	{
+		Table.Build(Grid, NumLandmarks);
+	}
+
+	const FString Filename = GetGridFilename(CellGrid);
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Filename), true);
+	return FGridFile::Write(TCHAR_TO_UTF8(*Filename), Grid, CellGrid->GetLayoutHash(), &Grid.Components, NumLandmarks > 0 ? &Table : nullptr);
+}
+
+FString FPathGrid::GetGridFilename(const ACellGrid* CellGrid)
+{
+	return FPaths::Combine(FPaths::ProjectContentDir(), TEXT("Pathfinding"), FString::Printf(TEXT("%016llx.pfgrid"), CellGrid->GetLayoutHash()));
+}
+
+bool FPathGrid::AttachGridFile(const ACellGrid* InCellGrid)
+{
+	const uint64 LayoutHash = InCellGrid->GetLayoutHash();
+	const FString Filename = GetGridFilename(InCellGrid);
+	if (!FPaths::FileExists(Filename))
+	{
+		return false;
+	}
+
+	TSharedPtr<FMappedGridFile, ESPMode::ThreadSafe> Mapped = MakeShared<FMappedGridFile, ESPMode::ThreadSafe>();
+	Mapped->Handle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+	if (Mapped->Handle.IsValid())
+	{
+		Mapped->Region.Reset(Mapped->Handle->MapRegion());
+	}
+	if (!Mapped->Region.IsValid() || !Mapped->File.Open(Mapped->Region->GetMappedPtr(), Mapped->Region->GetMappedSize())
+		|| Mapped->File.GetSourceHash() != LayoutHash || Mapped->File.GetWidth() != InCellGrid->GetWidth() || Mapped->File.GetHeight() != InCellGrid->GetHeight())
+	{
+		return false;
+	}
+
+	// Edges and landmark distances are read from the mapping, only what changes at runtime is copied
+	Attach(Mapped->File);
+	MappedFile = Mapped;
+
+	FLandmarkTable* Table = new FLandmarkTable();
+	if (Table->Attach(Mapped->File))
+	{
+		SetLandmarks(MakeShareable(Table, [Mapped](FLandmarkTable* Attached) { delete Attached; }), WalkabilityEpoch);
+	}
+	else
+	{
+		delete Table;
+	}
+	return true;
+}
+
+void FPathGrid::BuildFromCells(const ACellGrid* InCellGrid)
+{
+	// Same step costs as a generator whose cell actors stand CellSize apart
+	std::vector<bool> Walkable(InCellGrid->Num());
+	for (int32 CellId = 0; CellId < InCellGrid->Num(); ++CellId)
+	{
+		Walkable[CellId] = InCellGrid->IsWalkable(CellId);
+	}
+	BuildLattice(InCellGrid->GetWidth(), InCellGrid->GetHeight(), Walkable, int32(uint16(InCellGrid->CellSize)), int32(uint16(InCellGrid->CellSize * UE_SQRT_2)));
+	const TArray<uint8>& Costs = InCellGrid->GetCosts();
+	SetCellCosts(std::vector<uint8>(Costs.GetData(), Costs.GetData() + Costs.Num()));
+
+	// The graph owns its arrays again, nothing reads the mapping anymore
+	MappedFile.Reset();
+}
+
+void FPathGrid::BuildDerivedData(const int32* ComponentLabels)
+{
+	if (ComponentLabels)
+	{
+		Components.Build(ComponentLabels);
+	}
+	else
+	{
+		Components.Build();
+	}
+	// Rebuilt in place rather than dropped, queries running on them hold references
+	{
+		FScopeLock Lock(&HierarchyLock);
+		if (Hierarchy.IsValid())
+		{
+			Hierarchy->Build();
+		}
+	}
+	{
+		FScopeLock Lock(&JumpPointsLock);
+		if (JumpPoints.IsValid())
+		{
+			JumpPoints->Build();
+		}
+	}
+	for (const TSharedPtr<FFlowField, ESPMode::ThreadSafe>& Field : GetLiveFlowFields())
+	{
+		Field->Build();
+	}
+}
+
+void FPathGrid::RefreshWalkability()
+{
+	for (int32 CellId = 0; CellId < Num(); ++CellId)
+	{
+		RefreshWalkability(CellId);
+	}
+}
+
+void FPathGrid::RefreshWalkability(int32 CellId)
+{
+	SetWalkable(CellId, IsCellWalkable(CellId));
+}
+
+int32 FPathGrid::GetCellId(const ACellBase* Cell) const
+{
+	return Cell->GetCellId();
+}
+
+ACellBase* FPathGrid::GetCell(int32 CellId) const
+{
+	return CellGrid ? CellGrid->FindCellActor(CellId) : Cells[CellId];
+}
+
+bool FPathGrid::IsCellWalkable(int32 CellId) const
+{
+	if (CellGrid)
+	{
+		return CellGrid->IsWalkable(CellId);
+	}
+	ACellBase* Cell = Cells[CellId];
+	return Cell && Cell->GetIsWalkable();
+}
+
+void FPathGrid::ResolveCells(FPathBuffer& Path) const
+{
+	// Most packed cells have no actor, their users go by the ids
+	if (CellGrid)
+	{
+		return;
+	}
+
+	const std::vector<int32>& CellIds = Path.GetCellIds();
+	TArray<ACellBase*>& PathCells = Path.GetMutableCells();
+	PathCells.SetNumUninitialized(int32(CellIds.size()), false);
+	for (int32 Index = 0; Index < int32(CellIds.size()); ++Index)
+	{
+		PathCells[Index] = Cells[CellIds[Index]];
+	}
+}
+
+void FPathGrid::Invalidate()
+{
+	RefreshWalkability();
+	if (CellGrid)
+	{
+		const TArray<uint8>& Costs = CellGrid->GetCosts();
+		SetCellCosts(std::vector<uint8>(Costs.GetData(), Costs.GetData() + Costs.Num()));
+	}
+	BuildDerivedData();
+
+	// Cells may have opened, which landmark distances can't account for
+	++WalkabilityEpoch;
+	{
+		FScopeLock Lock(&LandmarksLock);
+		Landmarks.Reset();
+	}
+
+	// Searches still running finish with the old version, so their results can never be served
+	Version = NextVersion.Increment();
+	PathCache.Empty();
+}
+
+FHierarchicalPathfinder& FPathGrid::GetHierarchy()
+{
+	FScopeLock Lock(&HierarchyLock);
+	if (!Hierarchy.IsValid())
+	{
+		// Clusters are independent of each other, so the task graph builds them in parallel
+		Hierarchy = MakeUnique<FHierarchicalPathfinder>(*this, 16, [](int32 Num, const std::function<void(int32)>& Body) { ParallelFor(Num, Body); });
+		Hierarchy->Build();
+	}
+	return *Hierarchy;
+}
+
+FJumpPointTable& FPathGrid::GetJumpPoints()
+{
+	FScopeLock Lock(&JumpPointsLock);
+	if (!JumpPoints.IsValid())
+	{
+		JumpPoints = MakeUnique<FJumpPointTable>(*this);
+		JumpPoints->Build();
+	}
+	return *JumpPoints;
+}
+
+TSharedPtr<const FLandmarkTable, ESPMode::ThreadSafe> FPathGrid::GetLandmarks() const
+{
+	FScopeLock Lock(&LandmarksLock);
+	return Landmarks;
+}
+
+bool FPathGrid::SetLandmarks(const TSharedPtr<const FLandmarkTable, ESPMode::ThreadSafe>& Table, uint32 BuiltEpoch)
+{
+	FScopeLock Lock(&LandmarksLock);
+	if (BuiltEpoch != WalkabilityEpoch)
+	{
+		return false;
+	}
+	Landmarks = Table;
+	return true;
+}
+
+TSharedPtr<FFlowField, ESPMode::ThreadSafe> FPathGrid::FindFlowField(int32 TargetId) const
+{
+	FScopeLock Lock(&FlowFieldsLock);
+	return FlowFields.FindRef(TargetId).Pin();
+}
+
+void FPathGrid::AddFlowField(const TSharedPtr<FFlowField, ESPMode::ThreadSafe>& Field)
+{
+	FScopeLock Lock(&FlowFieldsLock);
+	FlowFields.Add(Field->GetTargetId(), Field);
+}
+
+void FPathGrid::OnWalkabilityChanged(int32 CellId)
+{
+	RefreshWalkability(CellId);
+
+	// Blocking a cell only makes routes longer, so landmark distances keep bounding them from below. An opened cell may shorten them.
+	++WalkabilityEpoch;
+	if (IsWalkable(CellId))
+	{
+		FScopeLock Lock(&LandmarksLock);
+		Landmarks.Reset();
+	}
+
+	PropagateWalkabilityChange(CellId);
+}
+
+SIZE_T FPathGrid::GetAllocatedSize() const
+{
+	return Cells.GetAllocatedSize() + FGridGraph::GetAllocatedSize() + Components.GetAllocatedSize();
+}
+
+void FPathGrid::PropagateWalkabilityChange(int32 CellId)
+{
+	PathCache.InvalidateCell(CellId);
+	Components.OnWalkabilityChanged(CellId);
+
+	{
+		FScopeLock Lock(&HierarchyLock);
+		if (Hierarchy.IsValid())
+		{
+			Hierarchy->OnWalkabilityChanged(CellId);
+		}
+	}
+	{
+		FScopeLock Lock(&JumpPointsLock);
+		if (JumpPoints.IsValid())
+		{
+			JumpPoints->OnWalkabilityChanged(CellId);
+		}
+	}
+
+	const TArray<int32> ChangedCells = { CellId };
+	for (const TSharedPtr<FFlowField, ESPMode::ThreadSafe>& Field : GetLiveFlowFields())
+	{
+		Field->NotifyCellsChanged(ChangedCells);
+	}
+}
+
+TArray<TSharedPtr<FFlowField, ESPMode::ThreadSafe>> FPathGrid::GetLiveFlowFields()
+{
+	// Fields nobody holds anymore are dropped instead of updated
+	TArray<TSharedPtr<FFlowField, ESPMode::ThreadSafe>> LiveFields;
+	FScopeLock Lock(&FlowFieldsLock);
+	for (auto It = FlowFields.CreateIterator(); It; ++It)
+	{
+		TSharedPtr<FFlowField, ESPMode::ThreadSafe> Field = It.Value().Pin();
+		if (Field.IsValid())
+		{
+			LiveFields.Add(Field);
+		}
+		else
+		{
+			It.RemoveCurrent();
+		}
+	}
+	return LiveFields;
+}
@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathCache.h"
+#include "PathfindingCore/GridComponents.h"
+#include "PathfindingCore/GridGraph.h"
+
+class ACellBase;
+class ACellGrid;
+class AGridGenerator;
+class FFlowField;
+class FHierarchicalPathfinder;
+class FJumpPointTable;
+class FLandmarkTable;
+
+/**
+ * Flat index over the cells spawned by an AGridGenerator or stored in an ACellGrid.
+ * Every cell gets an integer id (Y * Width + X) so search state can live in plain arrays
+ * instead of on the cell actors. One grid is shared by all queries running on a generator.
+ * The search graph itself is the engine-independent FGridGraph, this layer maps it to the cell
+ * actors and owns the data derived from it (cached paths, the hierarchy, flow fields).
+ */
+class INVADED_API FPathGrid : public FGridGraph
+{
+public:
+	FPathGrid();
+	virtual ~FPathGrid();
+
+	/** Returns the grid of the generator, indexing its cells on first use */
+	static TSharedPtr<FPathGrid, ESPMode::ThreadSafe> FindOrBuild(AGridGenerator* GridGenerator, ACellBase* SeedCell);
+
+	/** Returns the grid of the packed cells, building it from their arrays on first use */
+	static TSharedPtr<FPathGrid, ESPMode::ThreadSafe> FindOrBuild(ACellGrid* CellGrid);
+
+	/** Drops the grid of the generator, call when the generator respawns or destroys its cells */
+	static void Release(AGridGenerator* GridGenerator);
+	static void Release(ACellGrid* CellGrid);
+
+	/**
+	 * Precomputes the landmark distances for the ALT heuristic on a background thread, plain A* queries on the
+	 * grid switch to it once it is ready. The table is saved under Saved/Pathfinding keyed by the grid layout,
+	 * so the next start with the same level loads it instead of running the Dijkstra searches again.
+	 * Meant for levels whose walls don't open, opening a cell drops the table until this is called again.
+	 */
+	static void BuildLandmarks(AGridGenerator* GridGenerator, ACellBase* SeedCell, int32 NumLandmarks = 8);
+	static void BuildLandmarks(ACellGrid* CellGrid, int32 NumLandmarks = 8);
+
+	/** Tells the grid of the generator that the cell became walkable or blocked */
+	static void NotifyWalkabilityChanged(AGridGenerator* GridGenerator, ACellBase* Cell);
+	static void NotifyWalkabilityChanged(ACellGrid* CellGrid, int32 CellId);
+
+	/** Grid currently at the given version, invalid once that grid was rebuilt, invalidated or released */
+	static TSharedPtr<FPathGrid, ESPMode::ThreadSafe> FindByVersion(uint32 Version);
+
+	/** Indexes every cell reachable from SeedCell through AGridGenerator::GetNeighbours */
+	void Build(AGridGenerator* GridGenerator, ACellBase* SeedCell);
+
+	/**
+	 * Lays the packed cells out as an 8-connected lattice weighted by their costs, no actor is touched.
+	 * A grid file cooked for the same layout is mapped and searched in place instead, see WriteGridFile.
+	 */
+	void Build(const ACellGrid* InCellGrid);
+
+	/**
+	 * Builds the grid of the packed cells from scratch, with its components and NumLandmarks landmarks, and writes it
+	 * where Build looks for it. Run by the grid cook commandlet, any later change to the cells' walkability or
+	 * costs makes the file stale and Build ignores it.
+	 */
+	static bool WriteGridFile(const ACellGrid* CellGrid, int32 NumLandmarks = 8);
+
+	/** Content/Pathfinding file named after the layout hash of the cells */
+	static FString GetGridFilename(const ACellGrid* CellGrid);
+
+	using FGridGraph::GetCellId;
+	int32 GetCellId(const ACellBase* Cell) const;
+	FIntPoint GetCoord(int32 CellId) const { return FIntPoint(CellId % Width, CellId / Width); }
+
+	/** Cell actor with the given id, nullptr for holes in the grid. Packed grids only know the actors they spawned, on the game thread. */
+	ACellBase* GetCell(int32 CellId) const;
+
+	/** Walkability as the level has it right now, the graph only follows once the change is reported */
+	bool IsCellWalkable(int32 CellId) const;
+
+	/** Fills the cells of a freshly acquired buffer from the cell ids a search wrote into it, paths on packed grids keep the ids only */
+	void ResolveCells(FPathBuffer& Path) const;
+
+	AGridGenerator* GetGenerator() const { return Generator; }
+	const ACellGrid* GetCellGrid() const { return CellGrid; }
+
+	/** Changes whenever the whole grid is rebuilt or invalidated, cached paths carry the version they were found on */
+	uint32 GetVersion() const { return Version; }
+
+	/**
+	 * Rereads the walkability (and the costs of packed cells) of every cell, rebuilds the hierarchy, the JPS+ table and live
+	 * flow fields and forgets every cached path, for changes too large to report cell by cell
+	 */
+	void Invalidate();
+
+	/** Writes the current walkability as a Moving AI map, the format the benchmark commandlet reads */
+	bool SaveMovingAIMap(const FString& Filename) const;
+
+	FPathCache& GetPathCache() { return PathCache; }
+
+	/** Connected components of the walkable cells, kept up to date with every walkability change */
+	const FGridComponents& GetComponents() const { return Components; }
+
+	/** HPA* layer over this grid, preprocessed on first use */
+	FHierarchicalPathfinder& GetHierarchy();
+
+	/** JPS+ jump distances over this grid, built on first use and updated with every walkability change after that */
+	FJumpPointTable& GetJumpPoints();
+
+	/** Landmark distances for FLandmarkHeuristic, invalid until BuildLandmarks finished and after a cell opened */
+	TSharedPtr<const FLandmarkTable, ESPMode::ThreadSafe> GetLandmarks() const;
+
+	/** Flow field towards the target that some agent still holds, nullptr if there is none */
+	TSharedPtr<FFlowField, ESPMode::ThreadSafe> FindFlowField(int32 TargetId) const;
+
+	/** Keeps the field up to date with walkability changes for as long as agents hold it */
+	void AddFlowField(const TSharedPtr<FFlowField, ESPMode::ThreadSafe>& Field);
+
+	/** Rereads the walkability of the cell and updates the precomputed search data that depends on it */
+	void OnWalkabilityChanged(int32 CellId);
+
+	/** Memory held by the cell index, the graph and its components, not counting the hierarchy, the JPS+ table, flow fields or cached paths */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/** Mapping of a grid file, shared with the landmark table read from it since queries may hold the table longer than the grid */
+	struct FMappedGridFile;
+
+	/** Precomputed data that follows the graph, once it was (re)built or invalidated. Components are labelled from ComponentLabels when given. */
+	void BuildDerivedData(const int32* ComponentLabels = nullptr);
+
+	void BuildFromCells(const ACellGrid* InCellGrid);
+
+	/** Maps the cooked file of the cells, false when there is none or it was cooked for another layout */
+	bool AttachGridFile(const ACellGrid* InCellGrid);
+
+	/** Loads the landmark table of the grid or builds it on a background thread */
+	static void StartLandmarksBuild(const TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& Grid, int32 NumLandmarks);
+
+	void RefreshWalkability();
+	void RefreshWalkability(int32 CellId);
+
+	/** Forgets cached paths through the cell and updates the hierarchy and flow fields */
+	void PropagateWalkabilityChange(int32 CellId);
+
+	/** Flow fields some agent still holds, forgetting the rest */
+	TArray<TSharedPtr<FFlowField, ESPMode::ThreadSafe>> GetLiveFlowFields();
+
+	/** Keeps a table built in the background unless the walkability changed while it was being built */
+	bool SetLandmarks(const TSharedPtr<const FLandmarkTable, ESPMode::ThreadSafe>& Table, uint32 BuiltEpoch);
+
+	AGridGenerator* Generator;
+	const ACellGrid* CellGrid;
+
+	TAtomic<uint32> Version;
+
+	FPathCache PathCache;
+
+	TArray<ACellBase*> Cells;
+
+	/** Backs the adjacency arrays while the graph is attached to a grid file */
+	TSharedPtr<FMappedGridFile, ESPMode::ThreadSafe> MappedFile;
+
+	FGridComponents Components;
+
+	/** Bumped on every walkability change, a landmark table built across a change may mix both states */
+	TAtomic<uint32> WalkabilityEpoch;
+
+	mutable FCriticalSection LandmarksLock;
+	TSharedPtr<const FLandmarkTable, ESPMode::ThreadSafe> Landmarks;
+
+	FCriticalSection HierarchyLock;
+	TUniquePtr<FHierarchicalPathfinder> Hierarchy;
+
+	FCriticalSection JumpPointsLock;
+	TUniquePtr<FJumpPointTable> JumpPoints;
+
+	mutable FCriticalSection FlowFieldsLock;
+	TMap<int32, TWeakPtr<FFlowField, ESPMode::ThreadSafe>> FlowFields;
+};
@@ -0,0 +1,262 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathQueryProfiler.h"
+#include "PathGrid.h"
+#include "PathfindingStats.h"
+#include "PathfindingCore/GridAStar.h"
+#include "PathfindingCore/GridBenchmark.h"
+#include "PathfindingCore/PathHeuristics.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/ThreadManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPathQueries, Log, All);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Queries"), STAT_PathQueries, STATGROUP_Pathfinding);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Nodes Expanded"), STAT_PathNodesExpanded, STATGROUP_Pathfinding);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Heap Pushes"), STAT_PathHeapPushes, STATGROUP_Pathfinding);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Heap Pops"), STAT_PathHeapPops, STATGROUP_Pathfinding);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Neighbour Evaluations"), STAT_PathNeighboursEvaluated, STATGROUP_Pathfinding);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Cells Returned"), STAT_PathCellsReturned, STATGROUP_Pathfinding);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Path Query Time (ms)"), STAT_PathQueryMilliseconds, STATGROUP_Pathfinding);
+
+namespace
+{
+	void DumpSlowQueries(const TArray<FString>& Args)
+	{
+		FPathQueryProfiler::Get().Dump(Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 20);
+	}
+
+	void ResetQueries(const TArray<FString>& Args)
+	{
+		FPathQueryProfiler::Get().Reset();
+	}
+
+	FAutoConsoleCommand DumpSlowQueriesCommand(
+		TEXT("Pathfinding.DumpSlowQueries"),
+		TEXT("Logs latency and expansion histograms of the recent path queries and the N slowest of them (20 by default), and saves those as a scenario for the benchmark commandlet"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&DumpSlowQueries));
+
+	FAutoConsoleCommand ResetQueriesCommand(
+		TEXT("Pathfinding.ResetQueryProfile"),
+		TEXT("Forgets the recorded path queries"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&ResetQueries));
+
+	FString GetThreadName(uint32 ThreadId)
+	{
+		if (ThreadId == GGameThreadId)
+		{
+			return TEXT("GameThread");
+		}
+		const FString& Name = FThreadManager::Get().GetThreadName(ThreadId);
+		return Name.IsEmpty() ? FString::Printf(TEXT("Thread %u"), ThreadId) : Name;
+	}
+
+	/** Bucket i covers [2^(i-1), 2^i) */
+	FString GetBucketRange(int32 Bucket)
+	{
+		if (Bucket == 0)
+		{
+			return TEXT("< 1");
+		}
+		if (Bucket == FPathQueryProfiler::NumBuckets - 1)
+		{
+			return FString::Printf(TEXT(">= %u"), 1u << (Bucket - 1));
+		}
+		return FString::Printf(TEXT("[%u, %u)"), 1u << (Bucket - 1), 1u << Bucket);
+	}
+
+	void LogHistogram(const TCHAR* Title, const TArray<int32>& Counts)
+	{
+		UE_LOG(LogPathQueries, Display, TEXT("%s"), Title);
+		for (int32 Bucket = 0; Bucket < Counts.Num(); ++Bucket)
+		{
+			if (Counts[Bucket] > 0)
+			{
+				UE_LOG(LogPathQueries, Display, TEXT("  %16s  %d"), *GetBucketRange(Bucket), Counts[Bucket]);
+			}
+		}
+	}
+
+	/** Length of an optimal path in cells, -1 without one, the reference the benchmark holds replayed queries to */
+	double GetOptimalLength(FPathGrid& Grid, const FPathQueryRecord& Query)
+	{
+		const int32 StartId = Grid.GetCellId(Query.Start.X, Query.Start.Y);
+		std::vector<int32> Path;
+		if (!FGridAStar::FindPath<FOctileHeuristic>(Grid, StartId, Grid.GetCellId(Query.Target.X, Query.Target.Y), Path))
+		{
+			return -1.0;
+		}
+
+		double Length = 0.0;
+		FIntPoint From = Query.Start;
+		for (int32 CellId : Path)
+		{
+			const FIntPoint Delta = Grid.GetCoord(CellId) - From;
+			Length += FMath::Sqrt(double(Delta.X) * Delta.X + double(Delta.Y) * Delta.Y);
+			From = Grid.GetCoord(CellId);
+		}
+		return Length;
+	}
+
+	/** Saves the queries made on one grid as a Moving AI scenario next to a map of the grid as it is now */
+	void SaveScenario(const TArray<FPathQueryRecord>& Queries, uint32 GridVersion)
+	{
+		TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid = FPathGrid::FindByVersion(GridVersion);
+		if (!Grid.IsValid())
+		{
+			UE_LOG(LogPathQueries, Display, TEXT("Grid %u is gone, its queries are not saved"), GridVersion);
+			return;
+		}
+
+		const FString Directory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Pathfinding"));
+		IFileManager::Get().MakeDirectory(*Directory, true);
+		const FString MapName = FString::Printf(TEXT("SlowQueries_%u.map"), GridVersion);
+		const FString MapFile = FPaths::Combine(Directory, MapName);
+		const FString ScenarioFile = FPaths::Combine(Directory, FString::Printf(TEXT("SlowQueries_%u.scen"), GridVersion));
+
+		TArray<FString> Lines;
+		Lines.Add(TEXT("version 1"));
+		for (const FPathQueryRecord& Query : Queries)
+		{
+			if (Query.GridVersion == GridVersion)
+			{
+				Lines.Add(FString::Printf(TEXT("0\t%s\t%d\t%d\t%d\t%d\t%d\t%d\t%.8f"), *MapName, Grid->GetWidth(), Grid->GetHeight(),
+					Query.Start.X, Query.Start.Y, Query.Target.X, Query.Target.Y, GetOptimalLength(*Grid, Query)));
+			}
+		}
+
+		if (Grid->SaveMovingAIMap(MapFile) && FFileHelper::SaveStringArrayToFile(Lines, *ScenarioFile))
+		{
+			UE_LOG(LogPathQueries, Display, TEXT("Saved for replay: -map=%s -scen=%s"), *MapFile, *ScenarioFile);
+		}
+	}
+}
+
+FPathQueryProfiler& FPathQueryProfiler::Get()
+{
+	static FPathQueryProfiler Profiler;
+	return Profiler;
+}
+
+FPathQueryProfiler::FPathQueryProfiler()
+{
+	Window.Reserve(WindowSize);
+	NextIndex = 0;
+	FMemory::Memzero(LatencyCounts);
+	FMemory::Memzero(ExpansionCounts);
+}
+
+int32 FPathQueryProfiler::GetBucket(double Value)
+{
+	if (Value < 1.0)
+	{
+		return 0;
+	}
+	const uint32 Whole = uint32(FMath::Min(Value, double(MAX_uint32)));
+	return FMath::Min(int32(FMath::FloorLog2(Whole)) + 1, NumBuckets - 1);
+}
+
+void FPathQueryProfiler::Record(const FPathQueryRecord& Query)
+{
+	INC_DWORD_STAT(STAT_PathQueries);
+	INC_DWORD_STAT_BY(STAT_PathNodesExpanded, Query.Search.NodesExpanded);
+	INC_DWORD_STAT_BY(STAT_PathHeapPushes, Query.Search.HeapPushes);
+	INC_DWORD_STAT_BY(STAT_PathHeapPops, Query.Search.HeapPops);
+	INC_DWORD_STAT_BY(STAT_PathNeighboursEvaluated, Query.Search.NeighboursEvaluated);
+	INC_DWORD_STAT_BY(STAT_PathCellsReturned, Query.PathLength);
+	INC_FLOAT_STAT_BY(STAT_PathQueryMilliseconds, Query.Milliseconds);
+
+	const int32 LatencyBucket = GetBucket(Query.Milliseconds * 1000.0);
+	const int32 ExpansionBucket = GetBucket(Query.Search.NodesExpanded);
+
+	FScopeLock ScopeLock(&Lock);
+	if (Window.Num() < WindowSize)
+	{
+		Window.Add(Query);
+	}
+	else
+	{
+		// The oldest query leaves the window and the histograms with it
+		FPathQueryRecord& Oldest = Window[NextIndex];
+		--LatencyCounts[GetBucket(Oldest.Milliseconds * 1000.0)];
+		--ExpansionCounts[GetBucket(Oldest.Search.NodesExpanded)];
+		Oldest = Query;
+	}
+	NextIndex = (NextIndex + 1) % WindowSize;
+	++LatencyCounts[LatencyBucket];
+	++ExpansionCounts[ExpansionBucket];
+}
+
+void FPathQueryProfiler::GetLatencyHistogram(TArray<int32>& OutCounts) const
+{
+	FScopeLock ScopeLock(&Lock);
+	OutCounts.Reset(NumBuckets);
+	OutCounts.Append(LatencyCounts, NumBuckets);
+}
+
+void FPathQueryProfiler::GetExpansionHistogram(TArray<int32>& OutCounts) const
+{
+	FScopeLock ScopeLock(&Lock);
+	OutCounts.Reset(NumBuckets);
+	OutCounts.Append(ExpansionCounts, NumBuckets);
+}
+
+void FPathQueryProfiler::GetSlowestQueries(int32 Num, TArray<FPathQueryRecord>& OutQueries) const
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		OutQueries = Window;
+	}
+	OutQueries.Sort([](const FPathQueryRecord& A, const FPathQueryRecord& B) { return A.Milliseconds > B.Milliseconds; });
+	if (OutQueries.Num() > Num)
+	{
+		OutQueries.SetNum(Num);
+	}
+}
+
+void FPathQueryProfiler::Dump(int32 NumSlowest) const
+{
+	TArray<int32> Counts;
+	GetLatencyHistogram(Counts);
+	UE_LOG(LogPathQueries, Display, TEXT("Last %d path queries"), GetNumQueries());
+	LogHistogram(TEXT("Latency (us):"), Counts);
+	GetExpansionHistogram(Counts);
+	LogHistogram(TEXT("Expanded nodes:"), Counts);
+
+	TArray<FPathQueryRecord> Slowest;
+	GetSlowestQueries(NumSlowest, Slowest);
+	UE_LOG(LogPathQueries, Display, TEXT("%d slowest:"), Slowest.Num());
+	TArray<uint32> GridVersions;
+	for (const FPathQueryRecord& Query : Slowest)
+	{
+		UE_LOG(LogPathQueries, Display, TEXT("  %9.3f ms %-13s (%d,%d) -> (%d,%d) expanded %d pushes %d pops %d neighbours %d length %d%s on %s"),
+			Query.Milliseconds, UTF8_TO_TCHAR(FGridBenchmark::GetModeName(Query.Mode)), Query.Start.X, Query.Start.Y, Query.Target.X, Query.Target.Y,
+			Query.Search.NodesExpanded, Query.Search.HeapPushes, Query.Search.HeapPops, Query.Search.NeighboursEvaluated, Query.PathLength,
+			Query.bCacheHit ? TEXT(" (no search)") : TEXT(""), *GetThreadName(Query.ThreadId));
+		GridVersions.AddUnique(Query.GridVersion);
+	}
+
+	for (uint32 GridVersion : GridVersions)
+	{
+		SaveScenario(Slowest, GridVersion);
+	}
+}
+
+void FPathQueryProfiler::Reset()
+{
+	FScopeLock ScopeLock(&Lock);
+	Window.Reset();
+	NextIndex = 0;
+	FMemory::Memzero(LatencyCounts);
+	FMemory::Memzero(ExpansionCounts);
+}
+
+int32 FPathQueryProfiler::GetNumQueries() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Window.Num();
+}
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathfindingTypes.h"
+
+/**
+ * What one path query did and how long it took. Queries come from UFAStarNT::GetPath, from each start of a
+ * UFAStarNT::GetPathsToTarget batch and from FTimeSlicedPathSearch once it finishes.
+ */
+struct FPathQueryRecord
+{
+	/** Version of the grid the query ran on, see FPathGrid::GetVersion */
+	uint32 GridVersion;
+
+	FIntPoint Start;
+	FIntPoint Target;
+
+	EPathSearchMode Mode;
+	float SuboptimalityBound;
+
+	/** Answered from the path cache or rejected up front, the search stats are all zero then */
+	bool bCacheHit;
+
+	FPathSearchStats Search;
+
+	/** Cells on the path (turning points for AnyAngle), zero when none was found */
+	int32 PathLength;
+
+	/** Wall time, for a time-sliced search including the frames between its slices */
+	double Milliseconds;
+	uint32 ThreadId;
+
+	FPathQueryRecord()
+		: GridVersion(0)
+		, Start(0, 0)
+		, Target(0, 0)
+		, Mode(EPathSearchMode::AStar)
+		, SuboptimalityBound(0.0f)
+		, bCacheHit(false)
+		, PathLength(0)
+		, Milliseconds(0.0)
+		, ThreadId(0)
+	{
+	}
+};
+
+/**
+ * Keeps the last WindowSize path queries, for finding out why some of them are slow.
+ * Every query also feeds the counters in STATGROUP_Pathfinding ("stat Pathfinding"), the window adds
+ * latency and expansion histograms over the recent queries and the slowest ones with their start and target.
+ * Pathfinding.DumpSlowQueries [N] logs both and writes the N slowest queries as a Moving AI scenario
+ * under Saved/Pathfinding, next to the map of their grid, so the benchmark commandlet can replay them.
+ */
+class INVADED_API FPathQueryProfiler
+{
+public:
+	static constexpr int32 WindowSize = 4096;
+
+	/** Bucket 0 counts values below one, bucket i values in [2^(i-1), 2^i), the last one everything above */
+	static constexpr int32 NumBuckets = 24;
+
+	static FPathQueryProfiler& Get();
+
+	void Record(const FPathQueryRecord& Query);
+
+	/** Queries in the window by latency in microseconds */
+	void GetLatencyHistogram(TArray<int32>& OutCounts) const;
+
+	/** Queries in the window by expanded nodes */
+	void GetExpansionHistogram(TArray<int32>& OutCounts) const;
+
+	/** Up to Num slowest queries in the window, slowest first */
+	void GetSlowestQueries(int32 Num, TArray<FPathQueryRecord>& OutQueries) const;
+
+	/** Logs the histograms and the NumSlowest slowest queries and saves those for replay */
+	void Dump(int32 NumSlowest) const;
+
+	/** Forgets every recorded query */
+	void Reset();
+
+	int32 GetNumQueries() const;
+
+	static int32 GetBucket(double Value);
+
+private:
+	FPathQueryProfiler();
+
+	mutable FCriticalSection Lock;
+
+	/** Ring buffer of the last queries, NextIndex is where the next one goes */
+	TArray<FPathQueryRecord> Window;
+	int32 NextIndex;
+
+	int32 LatencyCounts[NumBuckets];
+	int32 ExpansionCounts[NumBuckets];
+};
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathfindingBenchmarkCommandlet.h"
+#include "PathfindingCore/GridBenchmark.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPathfindingBenchmark, Log, All);
+
+UPathfindingBenchmarkCommandlet::UPathfindingBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UPathfindingBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString MapFile;
+	FString ScenarioFile;
+	FString Generate;
+	FString ModeList;
+	FString EpsilonList = TEXT("0.1");
+	int32 Size = 256;
+	int32 NumQueries = 0;
+	int32 Seed = 0;
+	int32 NumLandmarks = 0;
+	FParse::Value(*Params, TEXT("map="), MapFile);
+	FParse::Value(*Params, TEXT("scen="), ScenarioFile);
+	FParse::Value(*Params, TEXT("generate="), Generate);
+	FParse::Value(*Params, TEXT("modes="), ModeList, false);
+	FParse::Value(*Params, TEXT("epsilon="), EpsilonList, false);
+	FParse::Value(*Params, TEXT("size="), Size);
+	FParse::Value(*Params, TEXT("queries="), NumQueries);
+	FParse::Value(*Params, TEXT("seed="), Seed);
+	FParse::Value(*Params, TEXT("landmarks="), NumLandmarks);
+
+	FBenchmarkMap Map;
+	std::vector<FBenchmarkQuery> Queries;
+	if (!MapFile.IsEmpty())
+	{
+		if (!FGridBenchmark::LoadMovingAIMap(TCHAR_TO_UTF8(*MapFile), Map))
+		{
+			UE_LOG(LogPathfindingBenchmark, Error, TEXT("Can't read map %s"), *MapFile);
+			return 1;
+		}
+		if (!ScenarioFile.IsEmpty() && !FGridBenchmark::LoadMovingAIScenarios(TCHAR_TO_UTF8(*ScenarioFile), Map, Queries))
+		{
+			UE_LOG(LogPathfindingBenchmark, Error, TEXT("Can't read scenarios %s"), *ScenarioFile);
+			return 1;
+		}
+	}
+	else if (Generate == TEXT("maze"))
+	{
+		FGridBenchmark::GenerateMaze(Size, uint32(Seed), Map);
+	}
+	else if (Generate == TEXT("open"))
+	{
+		FGridBenchmark::GenerateOpenField(Size, uint32(Seed), Map);
+	}
+	else
+	{
+		UE_LOG(LogPathfindingBenchmark, Error, TEXT("Pass -map=<file.map> [-scen=<file.scen>] or -generate=maze|open [-size=N]"));
+		return 1;
+	}
+
+	// The searches themselves live in the engine-independent core, the standalone PathfindingBenchmark runs the same code
+	FGridBenchmark Benchmark(Map);
+	if (Queries.empty())
+	{
+		if (!Benchmark.GenerateQueries(NumQueries > 0 ? NumQueries : 1000, uint32(Seed)))
+		{
+			UE_LOG(LogPathfindingBenchmark, Error, TEXT("The map has no walkable cells"));
+			return 1;
+		}
+	}
+	else
+	{
+		if (NumQueries > 0 && int32(Queries.size()) > NumQueries)
+		{
+			Queries.resize(NumQueries);
+		}
+		Benchmark.SetQueries(Queries);
+	}
+
+	Benchmark.SetLandmarks(NumLandmarks, MapFile.IsEmpty() ? std::string() : std::string(TCHAR_TO_UTF8(*(MapFile + TEXT(".landmarks")))));
+
+	UE_LOG(LogPathfindingBenchmark, Display, TEXT("%dx%d grid, %d queries, grid index %.1f MB"),
+		Map.Width, Map.Height, Benchmark.GetNumQueries(), Benchmark.GetGraph().GetAllocatedSize() / (1024.0 * 1024.0));
+
+	// Whole names only, AStar must not pick up WeightedAStar
+	TArray<FString> ModeNames;
+	ModeList.ParseIntoArray(ModeNames, TEXT(","));
+	TArray<FString> EpsilonNames;
+	EpsilonList.ParseIntoArray(EpsilonNames, TEXT(","));
+
+	int32 NumWrong = 0;
+	double AStarExpansions = 0.0;
+	for (EPathSearchMode Mode : { EPathSearchMode::AStar, EPathSearchMode::JumpPoint, EPathSearchMode::Hierarchical, EPathSearchMode::AnyAngle, EPathSearchMode::JumpPointPlus,
+		EPathSearchMode::WeightedAStar, EPathSearchMode::Focal })
+	{
+		const FString ModeName(FGridBenchmark::GetModeName(Mode));
+		if (ModeNames.Num() > 0 && !ModeNames.Contains(ModeName))
+		{
+			continue;
+		}
+
+		// Bounded modes run once per epsilon, the others ignore it
+		const bool bBounded = Mode == EPathSearchMode::WeightedAStar || Mode == EPathSearchMode::Focal;
+		TArray<double> Epsilons;
+		if (bBounded)
+		{
+			for (const FString& EpsilonName : EpsilonNames)
+			{
+				Epsilons.Add(FCString::Atod(*EpsilonName));
+			}
+		}
+		else
+		{
+			Epsilons.Add(0.0);
+		}
+
+		for (double Epsilon : Epsilons)
+		{
+			Benchmark.SetSuboptimalityBound(Epsilon);
+			const FBenchmarkResult Result = Benchmark.Run(Mode);
+			if (Mode == EPathSearchMode::Hierarchical || Mode == EPathSearchMode::JumpPointPlus || (Mode == EPathSearchMode::AStar && NumLandmarks > 0))
+			{
+				UE_LOG(LogPathfindingBenchmark, Display, TEXT("%s preprocessing %.1f ms"), *ModeName, Result.PreprocessMilliseconds);
+			}
+			if (Mode == EPathSearchMode::AStar)
+			{
+				AStarExpansions = Result.ExpansionsPerQuery;
+			}
+
+			const double PeakMegabytes = FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0);
+			UE_LOG(LogPathfindingBenchmark, Display, TEXT("%-12s %10.0f queries/s %10.1f expansions/query %10.1f heap ops/query %10.1f neighbours/query %8.1f waypoints p50 %.3f ms p99 %.3f ms peak %.1f MB wrong %d"),
+				*ModeName, Result.QueriesPerSecond, Result.ExpansionsPerQuery, Result.HeapOperationsPerQuery, Result.NeighboursPerQuery, Result.WaypointsPerQuery, Result.P50Milliseconds, Result.P99Milliseconds, PeakMegabytes, Result.NumWrong);
+			if (bBounded && AStarExpansions > 0.0)
+			{
+				UE_LOG(LogPathfindingBenchmark, Display, TEXT("%-12s epsilon %.3f saves %.1f%% of A* expansions"),
+					*ModeName, Epsilon, 100.0 * (1.0 - Result.ExpansionsPerQuery / AStarExpansions));
+			}
+			if (Mode == EPathSearchMode::Hierarchical || Mode == EPathSearchMode::AnyAngle || bBounded)
+			{
+				UE_LOG(LogPathfindingBenchmark, Display, TEXT("%-12s path length %.4f of optimal on average, %.4f at worst"),
+					*ModeName, Result.MeanLengthRatio, Result.WorstLengthRatio);
+			}
+			NumWrong += Result.NumWrong;
+		}
+	}
+
+	return NumWrong > 0 ? 1 : 0;
+}
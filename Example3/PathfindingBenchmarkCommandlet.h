@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PathfindingBenchmarkCommandlet.generated.h"
+
+/**
+ * Runs every search mode over one set of queries on a grid built without actors and logs
+ * throughput, expansions, latency percentiles and memory for each. Maps are Moving AI benchmark
+ * maps (.map, with the matching .scen for known optimal lengths) or generated mazes and open fields.
+ *
+ *   -run=PathfindingBenchmark -map=arena.map -scen=arena.map.scen
+ *   -run=PathfindingBenchmark -generate=maze -size=512 -queries=1000 -seed=7
+ *
+ * -modes=AStar,JumpPoint,Hierarchical,AnyAngle,JumpPointPlus limits the modes, -queries caps the scenario count.
+ * -landmarks=8 runs A* with the ALT heuristic, the landmark table of a map file is cached next to it.
+ * -modes=AStar,WeightedAStar,Focal -epsilon=0.05,0.1,0.25 runs the bounded modes once per epsilon (0.1 by default)
+ * and logs the share of A* expansions each setting saves.
+ * Generated maps take plain A* as the reference. Returns non-zero when a mode finds an invalid
+ * path, an optimal mode finds a longer one than the reference or a bounded mode one over its bound.
+ */
+UCLASS()
+class INVADED_API UPathfindingBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UPathfindingBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
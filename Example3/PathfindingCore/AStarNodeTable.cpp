@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AStarNodeTable.h"
+#include <algorithm>
+
+FAStarNodeTable::FAStarNodeTable()
+{
+	CurrentGeneration = 0;
+}
+
+void FAStarNodeTable::Reset(int32 NumCells)
+{
+	if (int32(Generation.size()) < NumCells)
+	{
+		GCost.resize(NumCells);
+		HCost.resize(NumCells);
+		Parent.resize(NumCells);
+		HeapIndex.resize(NumCells);
+		Generation.resize(NumCells, 0);
+	}
+
+	++CurrentGeneration;
+	if (CurrentGeneration == 0)
+	{
+		// Stamps wrapped around, old entries could look current again
+		std::fill(Generation.begin(), Generation.end(), 0u);
+		CurrentGeneration = 1;
+	}
+}
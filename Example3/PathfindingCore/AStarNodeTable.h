@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <vector>
+
+/**
+ * Per-query A* state kept as parallel arrays indexed by cell id.
+ * An entry only counts when its generation stamp matches the current generation,
+ * so resetting the table between queries is a counter bump instead of a clear.
+ */
+class INVADED_API FAStarNodeTable
+{
+public:
+	/** HeapIndex value of nodes already expanded */
+	static const int32 ClosedIndex = -2;
+
+	FAStarNodeTable();
+
+	/** Starts a new query over a grid with NumCells cells */
+	void Reset(int32 NumCells);
+
+	/** True when the node was touched by the current query */
+	bool IsVisited(int32 CellId) const { return Generation[CellId] == CurrentGeneration; }
+
+	/** Makes the node part of the current query with unknown cost and no parent */
+	void Visit(int32 CellId)
+	{
+		Generation[CellId] = CurrentGeneration;
+		GCost[CellId] = MAX_int32;
+		HCost[CellId] = 0;
+		Parent[CellId] = INDEX_NONE;
+		HeapIndex[CellId] = INDEX_NONE;
+	}
+
+	int32 GetGCost(int32 CellId) const { return IsVisited(CellId) ? GCost[CellId] : MAX_int32; }
+	int32 GetHCost(int32 CellId) const { return HCost[CellId]; }
+	int32 GetFCost(int32 CellId) const { return GCost[CellId] + HCost[CellId]; }
+	int32 GetParent(int32 CellId) const { return Parent[CellId]; }
+	int32 GetHeapIndex(int32 CellId) const { return IsVisited(CellId) ? HeapIndex[CellId] : INDEX_NONE; }
+
+	bool IsClosed(int32 CellId) const { return IsVisited(CellId) && HeapIndex[CellId] == ClosedIndex; }
+
+	void SetGCost(int32 CellId, int32 Cost) { GCost[CellId] = Cost; }
+	void SetHCost(int32 CellId, int32 Cost) { HCost[CellId] = Cost; }
+	void SetParent(int32 CellId, int32 ParentId) { Parent[CellId] = ParentId; }
+	void SetHeapIndex(int32 CellId, int32 Index) { HeapIndex[CellId] = Index; }
+	void Close(int32 CellId) { HeapIndex[CellId] = ClosedIndex; }
+
+	/** Storage for the open set of the current query, kept with the table so its capacity carries over between queries */
+	std::vector<int32>& GetOpenHeap() { return OpenHeap; }
+
+private:
+	std::vector<int32> GCost;
+	std::vector<int32> HCost;
+	std::vector<int32> Parent;
+	std::vector<int32> HeapIndex;
+	std::vector<uint32> Generation;
+	std::vector<int32> OpenHeap;
+
+	uint32 CurrentGeneration;
+};
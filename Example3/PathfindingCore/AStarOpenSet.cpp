@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AStarOpenSet.h"
+#include "AStarNodeTable.h"
+
+bool FAStarComparator::operator()(int32 A, int32 B) const
+{
+	const int32 FCostA = Nodes.GetFCost(A);
+	const int32 FCostB = Nodes.GetFCost(B);
+	if (FCostA == FCostB)
+	{
+		return Nodes.GetHCost(A) < Nodes.GetHCost(B);
+	}
+	return FCostA < FCostB;
+}
+
+FAStarOpenSet::FAStarOpenSet(FAStarNodeTable& InNodes, FPathSearchStats* InStats)
+	: Nodes(InNodes)
+	, Less(InNodes)
+	, Heap(InNodes.GetOpenHeap())
+	, Stats(InStats)
+{
+	Heap.clear();
+}
+
+bool FAStarOpenSet::Contains(int32 CellId) const
+{
+	return Nodes.GetHeapIndex(CellId) >= 0;
+}
+
+void FAStarOpenSet::Push(int32 CellId)
+{
+	check(!Contains(CellId));
+	if (Stats)
+	{
+		++Stats->HeapPushes;
+	}
+	Heap.push_back(CellId);
+	Place(CellId, Num() - 1);
+	SiftUp(Num() - 1);
+}
+
+int32 FAStarOpenSet::Pop()
+{
+	check(!Heap.empty());
+	if (Stats)
+	{
+		++Stats->HeapPops;
+	}
+	const int32 Top = Heap[0];
+	const int32 Last = Heap.back();
+	Heap.pop_back();
+	if (!Heap.empty())
+	{
+		Place(Last, 0);
+		SiftDown(0);
+	}
+	Nodes.Close(Top);
+	return Top;
+}
+
+void FAStarOpenSet::Update(int32 CellId)
+{
+	check(Contains(CellId));
+	if (Stats)
+	{
+		++Stats->HeapPushes;
+	}
+	SiftUp(Nodes.GetHeapIndex(CellId));
+}
+
+void FAStarOpenSet::Reset()
+{
+	for (int32 CellId : Heap)
+	{
+		Nodes.SetHeapIndex(CellId, INDEX_NONE);
+	}
+	Heap.clear();
+}
+
+void FAStarOpenSet::SiftUp(int32 Index)
+{
+	const int32 CellId = Heap[Index];
+	while (Index > 0)
+	{
+		const int32 ParentIndex = (Index - 1) / 2;
+		if (!Less(CellId, Heap[ParentIndex]))
+		{
+			break;
+		}
+		Place(Heap[ParentIndex], Index);
+		Index = ParentIndex;
+	}
+	Place(CellId, Index);
+}
+
+void FAStarOpenSet::SiftDown(int32 Index)
+{
+	const int32 CellId = Heap[Index];
+	const int32 Count = Num();
+	while (true)
+	{
+		int32 Child = Index * 2 + 1;
+		if (Child >= Count)
+		{
+			break;
+		}
+		if (Child + 1 < Count && Less(Heap[Child + 1], Heap[Child]))
+		{
+			++Child;
+		}
+		if (!Less(Heap[Child], CellId))
+		{
+			break;
+		}
+		Place(Heap[Child], Index);
+		Index = Child;
+	}
+	Place(CellId, Index);
+}
+
+void FAStarOpenSet::Place(int32 CellId, int32 Index)
+{
+	Heap[Index] = CellId;
+	Nodes.SetHeapIndex(CellId, Index);
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <vector>
+
+class FAStarNodeTable;
+
+/** Orders nodes by F cost, ties go to the node with the lower H cost (the one closer to the target) */
+struct FAStarComparator
+{
+	const FAStarNodeTable& Nodes;
+
+	explicit FAStarComparator(const FAStarNodeTable& InNodes) : Nodes(InNodes) {}
+
+	bool operator()(int32 A, int32 B) const;
+};
+
+/**
+ * A* open list backed by an indexed binary min-heap of cell ids.
+ * Every node remembers its slot in the heap inside the node table, so membership
+ * tests are O(1) and both insertion and decrease-key cost O(log n). The heap itself
+ * lives in the node table too, one open set per table at a time.
+ */
+class INVADED_API FAStarOpenSet
+{
+public:
+	/** Heap operations are counted into Stats when it is given */
+	explicit FAStarOpenSet(FAStarNodeTable& InNodes, FPathSearchStats* InStats = nullptr);
+
+	int32 Num() const { return int32(Heap.size()); }
+
+	bool IsEmpty() const { return Heap.empty(); }
+
+	bool Contains(int32 CellId) const;
+
+	/** Adds a node which is not in the open set yet */
+	void Push(int32 CellId);
+
+	/** Removes and returns the node with the lowest F cost, the node is marked closed */
+	int32 Pop();
+
+	/** Restores heap order after the node's cost was lowered */
+	void Update(int32 CellId);
+
+	/** Empties the open set */
+	void Reset();
+
+private:
+	void SiftUp(int32 Index);
+	void SiftDown(int32 Index);
+	void Place(int32 CellId, int32 Index);
+
+	FAStarNodeTable& Nodes;
+	FAStarComparator Less;
+	std::vector<int32>& Heap;
+	FPathSearchStats* Stats;
+};
@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Headless benchmark for the pathfinding core, built by CMakeLists.txt only. Takes the same arguments as
+// UPathfindingBenchmarkCommandlet, so numbers from a perf / VTune run line up with the editor ones:
+//   PathfindingBenchmark -map=arena.map -scen=arena.map.scen -modes=AStar,JumpPoint,Hierarchical,AnyAngle,JumpPointPlus
+//   PathfindingBenchmark -generate=maze -size=512 -queries=1000 -seed=7
+//   PathfindingBenchmark -map=arena.map -scen=arena.map.scen -modes=AStar -landmarks=8
+//   PathfindingBenchmark -map=arena.map -scen=arena.map.scen -modes=AStar,WeightedAStar,Focal -epsilon=0.05,0.1,0.25
+#if PATHFINDING_CORE_STANDALONE
+
+#include "GridBenchmark.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+namespace
+{
+	/** Value of -Key=Value among the arguments */
+	bool ParseValue(int Argc, char** Argv, const char* Key, std::string& OutValue)
+	{
+		const size_t KeyLength = std::strlen(Key);
+		for (int Index = 1; Index < Argc; ++Index)
+		{
+			const char* Argument = Argv[Index];
+			if (Argument[0] == '-' && std::strncmp(Argument + 1, Key, KeyLength) == 0 && Argument[KeyLength + 1] == '=')
+			{
+				OutValue = Argument + KeyLength + 2;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int32 ParseInt(int Argc, char** Argv, const char* Key, int32 Default)
+	{
+		std::string Value;
+		return ParseValue(Argc, Argv, Key, Value) ? std::atoi(Value.c_str()) : Default;
+	}
+
+	/** Whether Name is one of the entries of the comma separated list, JumpPoint must not match JumpPointPlus */
+	bool HasMode(const std::string& Modes, const char* Name)
+	{
+		const std::string Entry = std::string(",") + Name + ",";
+		return ("," + Modes + ",").find(Entry) != std::string::npos;
+	}
+
+	/** Numbers of a comma separated list */
+	std::vector<double> ParseList(const std::string& List)
+	{
+		std::vector<double> Values;
+		for (size_t Begin = 0; Begin <= List.size();)
+		{
+			const size_t End = std::min(List.find(',', Begin), List.size());
+			if (End > Begin)
+			{
+				Values.push_back(std::atof(List.substr(Begin, End - Begin).c_str()));
+			}
+			Begin = End + 1;
+		}
+		return Values;
+	}
+
+	double GetPeakMemoryMB()
+	{
+		rusage Usage;
+		getrusage(RUSAGE_SELF, &Usage);
+		return Usage.ru_maxrss / 1024.0;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	std::string MapFile;
+	std::string ScenarioFile;
+	std::string Generate;
+	std::string Modes = "AStar,JumpPoint,Hierarchical,AnyAngle,JumpPointPlus";
+	std::string Epsilons = "0.1";
+	ParseValue(Argc, Argv, "map", MapFile);
+	ParseValue(Argc, Argv, "scen", ScenarioFile);
+	ParseValue(Argc, Argv, "generate", Generate);
+	ParseValue(Argc, Argv, "modes", Modes);
+	ParseValue(Argc, Argv, "epsilon", Epsilons);
+	const int32 Size = ParseInt(Argc, Argv, "size", 256);
+	const int32 NumQueries = ParseInt(Argc, Argv, "queries", 0);
+	const uint32 Seed = uint32(ParseInt(Argc, Argv, "seed", 0));
+	const int32 NumLandmarks = ParseInt(Argc, Argv, "landmarks", 0);
+
+	FBenchmarkMap Map;
+	if (!MapFile.empty())
+	{
+		if (!FGridBenchmark::LoadMovingAIMap(MapFile, Map))
+		{
+			std::printf("Failed to load map %s\n", MapFile.c_str());
+			return 1;
+		}
+	}
+	else if (Generate == "maze")
+	{
+		FGridBenchmark::GenerateMaze(Size, Seed, Map);
+	}
+	else if (Generate == "open")
+	{
+		FGridBenchmark::GenerateOpenField(Size, Seed, Map);
+	}
+	else
+	{
+		std::printf("Pass -map=<file.map> [-scen=<file.scen>] or -generate=maze|open [-size=N]\n");
+		return 1;
+	}
+
+	FGridBenchmark Benchmark(Map);
+	if (!ScenarioFile.empty())
+	{
+		std::vector<FBenchmarkQuery> Queries;
+		if (!FGridBenchmark::LoadMovingAIScenarios(ScenarioFile, Map, Queries))
+		{
+			std::printf("Failed to load scenarios %s\n", ScenarioFile.c_str());
+			return 1;
+		}
+		if (NumQueries > 0 && int32(Queries.size()) > NumQueries)
+		{
+			Queries.resize(NumQueries);
+		}
+		Benchmark.SetQueries(Queries);
+	}
+	else if (!Benchmark.GenerateQueries(NumQueries > 0 ? NumQueries : 1000, Seed))
+	{
+		std::printf("The map has no walkable cells\n");
+		return 1;
+	}
+
+	// Landmark tables of a map file are kept next to it, so only the first run pays for the Dijkstra searches
+	Benchmark.SetLandmarks(NumLandmarks, MapFile.empty() ? std::string() : MapFile + ".landmarks");
+
+	std::printf("%dx%d grid, %d queries, grid index %.1f MB\n", Map.Width, Map.Height, Benchmark.GetNumQueries(),
+		Benchmark.GetGraph().GetAllocatedSize() / (1024.0 * 1024.0));
+
+	int32 NumWrong = 0;
+	double AStarExpansions = 0.0;
+	for (EPathSearchMode Mode : { EPathSearchMode::AStar, EPathSearchMode::JumpPoint, EPathSearchMode::Hierarchical, EPathSearchMode::AnyAngle, EPathSearchMode::JumpPointPlus,
+		EPathSearchMode::WeightedAStar, EPathSearchMode::Focal })
+	{
+		if (!HasMode(Modes, FGridBenchmark::GetModeName(Mode)))
+		{
+			continue;
+		}
+
+		// Bounded modes run once per epsilon, the others ignore it
+		const bool bBounded = Mode == EPathSearchMode::WeightedAStar || Mode == EPathSearchMode::Focal;
+		for (double Epsilon : bBounded ? ParseList(Epsilons) : std::vector<double>(1, 0.0))
+		{
+			Benchmark.SetSuboptimalityBound(Epsilon);
+			const FBenchmarkResult Result = Benchmark.Run(Mode);
+			NumWrong += Result.NumWrong;
+			if (Mode == EPathSearchMode::AStar)
+			{
+				AStarExpansions = Result.ExpansionsPerQuery;
+			}
+
+			std::printf("%-12s %10.1f queries/s %10.1f expansions/query %10.1f heap ops/query %10.1f neighbours/query %8.1f waypoints  p50 %.3f ms  p99 %.3f ms  peak %.1f MB  wrong %d",
+				FGridBenchmark::GetModeName(Mode), Result.QueriesPerSecond, Result.ExpansionsPerQuery, Result.HeapOperationsPerQuery, Result.NeighboursPerQuery, Result.WaypointsPerQuery,
+				Result.P50Milliseconds, Result.P99Milliseconds, GetPeakMemoryMB(), Result.NumWrong);
+			if (Mode == EPathSearchMode::Hierarchical || Mode == EPathSearchMode::JumpPointPlus || (Mode == EPathSearchMode::AStar && NumLandmarks > 0))
+			{
+				std::printf("  build %.1f ms", Result.PreprocessMilliseconds);
+			}
+			if (bBounded)
+			{
+				std::printf("  epsilon %.3f", Epsilon);
+				if (AStarExpansions > 0.0)
+				{
+					std::printf("  saves %.1f%% of AStar expansions", 100.0 * (1.0 - Result.ExpansionsPerQuery / AStarExpansions));
+				}
+			}
+			if (Mode == EPathSearchMode::Hierarchical || Mode == EPathSearchMode::AnyAngle || bBounded)
+			{
+				std::printf("  length ratio mean %.4f worst %.4f", Result.MeanLengthRatio, Result.WorstLengthRatio);
+			}
+			std::printf("\n");
+		}
+	}
+	return NumWrong > 0 ? 1 : 0;
+}
+
+#endif
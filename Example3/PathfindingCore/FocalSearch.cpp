@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FocalSearch.h"
+#include "AStarNodeTable.h"
+#include "GridAStar.h"
+#include "GridGraph.h"
+#include "PathHeuristics.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <set>
+#include <tuple>
+
+namespace
+{
+	/** The node table's heap slot only tells open nodes apart here, both lists live outside it */
+	const int32 OpenIndex = 0;
+
+	/** F cost and cell */
+	typedef std::pair<int32, int32> FOpenEntry;
+
+	/** Weighted f cost, f cost and cell */
+	typedef std::tuple<int64, int32, int32> FFocalEntry;
+}
+
+bool FFocalSearch::FindPath(FGridGraph& Graph, int32 StartId, int32 TargetId, float Epsilon, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats)
+{
+	FPathSearchStats LocalStats;
+	FPathSearchStats& Stats = OutStats ? *OutStats : LocalStats;
+	Stats = FPathSearchStats();
+
+	FScopedNodeTable Nodes(Graph);
+	const FEdgeCostSnapshot EdgeCosts = Graph.GetEdgeCosts();
+	OutPath.clear();
+
+	const TGridHeuristic<FOctileHeuristic> Heuristic(Graph, TargetId);
+	const double Weight = 1.0 + std::max(Epsilon, 0.0f);
+
+	// Every open node sits in Open by f cost. Focal gets an entry once the node falls within the bound, entries
+	// outdated by a cost update stay behind and are skipped when they come up.
+	std::set<FOpenEntry> Open;
+	std::priority_queue<FFocalEntry, std::vector<FFocalEntry>, std::greater<FFocalEntry>> Focal;
+	int32 LowestFCost = INDEX_NONE;
+	int32 FocalBound = INDEX_NONE;
+
+	// Ordering the focal list by plain distance to the target makes it run ahead with poor costs and reopen most of the
+	// map on open ground, weighting the estimate the way weighted A* does keeps it close to the cheapest routes
+	auto GetFocalCost = [&Nodes, Weight](int32 CellId)
+	{
+		return Nodes->GetGCost(CellId) + int64(Nodes->GetHCost(CellId) * Weight);
+	};
+
+	// Only the focal list is a heap, its pushes and pops include the outdated entries it skips
+	auto Push = [&Nodes, &Open, &Focal, &FocalBound, &GetFocalCost, &Stats](int32 CellId)
+	{
+		const int32 FCost = Nodes->GetFCost(CellId);
+		Nodes->SetHeapIndex(CellId, OpenIndex);
+		Open.insert(FOpenEntry(FCost, CellId));
+		if (FCost <= FocalBound)
+		{
+			Focal.push(FFocalEntry(GetFocalCost(CellId), FCost, CellId));
+			++Stats.HeapPushes;
+		}
+	};
+
+	Nodes->Visit(StartId);
+	Nodes->SetGCost(StartId, 0);
+	Nodes->SetHCost(StartId, Heuristic.Get(StartId));
+	Push(StartId);
+	++Stats.NodesGenerated;
+
+	while (!Open.empty())
+	{
+		if (Cancellation && Cancellation->IsCancelled())
+		{
+			return false;
+		}
+
+		// With a consistent estimate the lowest f cost only grows, and every time it does more open nodes come within the bound
+		const int32 NewLowestFCost = Open.begin()->first;
+		if (NewLowestFCost > LowestFCost)
+		{
+			const int32 NewBound = int32(std::min(double(MAX_int32), std::floor(NewLowestFCost * Weight)));
+			for (std::set<FOpenEntry>::const_iterator It = Open.upper_bound(FOpenEntry(FocalBound, MAX_int32)); It != Open.end() && It->first <= NewBound; ++It)
+			{
+				Focal.push(FFocalEntry(GetFocalCost(It->second), It->first, It->second));
+				++Stats.HeapPushes;
+			}
+			LowestFCost = NewLowestFCost;
+			FocalBound = NewBound;
+		}
+
+		const FFocalEntry Entry = Focal.top();
+		Focal.pop();
+		++Stats.HeapPops;
+		const int32 CurrentId = std::get<2>(Entry);
+		const int32 CurrentFCost = std::get<1>(Entry);
+		if (Nodes->GetHeapIndex(CurrentId) != OpenIndex || Nodes->GetFCost(CurrentId) != CurrentFCost)
+		{
+			continue;
+		}
+
+		Open.erase(FOpenEntry(CurrentFCost, CurrentId));
+		Nodes->Close(CurrentId);
+		++Stats.NodesExpanded;
+
+		if (CurrentId == TargetId)
+		{
+			FGridAStar::RetracePath(*Nodes, StartId, TargetId, OutPath);
+			return true;
+		}
+
+		Stats.NeighboursEvaluated += Graph.GetEndEdge(CurrentId) - Graph.GetFirstEdge(CurrentId);
+		for (int32 Edge = Graph.GetFirstEdge(CurrentId); Edge < Graph.GetEndEdge(CurrentId); ++Edge)
+		{
+			const int32 NeighbourId = Graph.GetEdgeTarget(Edge);
+			const int32 MovementCost = Nodes->GetGCost(CurrentId) + EdgeCosts[Edge];
+			if (!Graph.IsWalkable(NeighbourId) || MovementCost >= Nodes->GetGCost(NeighbourId) || !Graph.IsMoveAllowed(CurrentId, NeighbourId))
+			{
+				continue;
+			}
+
+			if (!Nodes->IsVisited(NeighbourId))
+			{
+				Nodes->Visit(NeighbourId);
+				Nodes->SetHCost(NeighbourId, Heuristic.Get(NeighbourId));
+				++Stats.NodesGenerated;
+			}
+			else if (Nodes->GetHeapIndex(NeighbourId) == OpenIndex)
+			{
+				Open.erase(FOpenEntry(Nodes->GetFCost(NeighbourId), NeighbourId));
+			}
+
+			// Closed nodes reached more cheaply are reopened, expanding out of f order would otherwise lose the bound
+			Nodes->SetGCost(NeighbourId, MovementCost);
+			Nodes->SetParent(NeighbourId, CurrentId);
+			Push(NeighbourId);
+		}
+	}
+	return false;
+}
@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <vector>
+
+class FGridGraph;
+
+/**
+ * Focal search (A*epsilon) over an FGridGraph, for queries that may trade a bounded amount of path length for speed.
+ * Open nodes whose f cost is within 1 + Epsilon of the lowest one form the focal list, and the search expands the one
+ * of those with the lowest g + (1 + Epsilon) * h. Paths cost at most (1 + Epsilon) times the optimal one, like weighted
+ * A*, but the bound is checked against the open list instead of relying on the estimate, so closed nodes reached more
+ * cheaply are reopened and paths tend to stay closer to optimal for the same bound at the price of a few more expansions.
+ */
+class INVADED_API FFocalSearch
+{
+public:
+	/** Fills OutPath with the cells after StartId up to TargetId, false when the target can't be reached or the search was cancelled */
+	static bool FindPath(FGridGraph& Graph, int32 StartId, int32 TargetId, float Epsilon, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation = nullptr, FPathSearchStats* OutStats = nullptr);
+};
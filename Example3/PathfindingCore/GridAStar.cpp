@@ -0,0 +1,212 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GridAStar.h"
+#include "AStarNodeTable.h"
+#include "AStarOpenSet.h"
+#include "GridGraph.h"
+#include "LandmarkHeuristic.h"
+#include "PathHeuristics.h"
+#include <algorithm>
+
+template <typename HeuristicPolicy>
+bool FGridAStar::FindPath(FGridGraph& Graph, int32 StartId, int32 TargetId, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats)
+{
+	return FindPathWithHeuristic(Graph, StartId, TargetId, TGridHeuristic<HeuristicPolicy>(Graph, TargetId), OutPath, Cancellation, OutStats);
+}
+
+template <typename HeuristicType>
+bool FGridAStar::FindPathWithHeuristic(FGridGraph& Graph, int32 StartId, int32 TargetId, const HeuristicType& Heuristic, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats)
+{
+	FScopedNodeTable Nodes(Graph);
+	OutPath.clear();
+
+	FPathSearchStats Stats;
+	const bool bFound = Search(Graph, *Nodes, &StartId, 1, Heuristic, [TargetId](int32 CellId) { return CellId == TargetId; }, INDEX_NONE, Cancellation, Stats) != INDEX_NONE;
+	if (bFound)
+	{
+		RetracePath(*Nodes, StartId, TargetId, OutPath);
+	}
+
+	if (OutStats)
+	{
+		*OutStats = Stats;
+	}
+	return bFound;
+}
+
+bool FGridAStar::FindPathWeighted(FGridGraph& Graph, int32 StartId, int32 TargetId, float Epsilon, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats)
+{
+	const TGridHeuristic<FOctileHeuristic> Octile(Graph, TargetId);
+	const TWeightedHeuristic<TGridHeuristic<FOctileHeuristic>> Heuristic(Graph, Octile, 1.0f + std::max(Epsilon, 0.0f));
+	return FindPathWithHeuristic(Graph, StartId, TargetId, Heuristic, OutPath, Cancellation, OutStats);
+}
+
+bool FGridAStar::FindPathToNearest(FGridGraph& Graph, int32 StartId, const std::vector<int32>& TargetIds, std::vector<int32>& OutPath, int32& OutTargetIndex, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats)
+{
+	OutPath.clear();
+	OutTargetIndex = INDEX_NONE;
+
+	FPathSearchStats LocalStats;
+	FPathSearchStats& Stats = OutStats ? *OutStats : LocalStats;
+	Stats = FPathSearchStats();
+
+	// Same as a single target search, standing on a target needs no path even when the cell is blocked
+	const std::vector<int32>::const_iterator StartTarget = std::find(TargetIds.begin(), TargetIds.end(), StartId);
+	if (StartTarget != TargetIds.end())
+	{
+		OutTargetIndex = int32(StartTarget - TargetIds.begin());
+		return true;
+	}
+
+	std::vector<int32> WalkableTargets;
+	WalkableTargets.reserve(TargetIds.size());
+	for (int32 TargetId : TargetIds)
+	{
+		if (Graph.IsWalkable(TargetId))
+		{
+			WalkableTargets.push_back(TargetId);
+		}
+	}
+	if (WalkableTargets.empty())
+	{
+		return false;
+	}
+
+	FScopedNodeTable Nodes(Graph);
+	int32 ReachedId;
+	if (int32(WalkableTargets.size()) <= MaxHeuristicTargets)
+	{
+		const TNearestTargetHeuristic<FOctileHeuristic> Heuristic(Graph, WalkableTargets);
+		auto IsTarget = [&WalkableTargets](int32 CellId) { return std::find(WalkableTargets.begin(), WalkableTargets.end(), CellId) != WalkableTargets.end(); };
+		ReachedId = Search(Graph, *Nodes, &StartId, 1, Heuristic, IsTarget, INDEX_NONE, Cancellation, Stats);
+		if (ReachedId != INDEX_NONE)
+		{
+			RetracePath(*Nodes, StartId, ReachedId, OutPath);
+		}
+	}
+	else
+	{
+		const TGridHeuristic<FOctileHeuristic> Heuristic(Graph, StartId);
+		ReachedId = Search(Graph, *Nodes, WalkableTargets.data(), int32(WalkableTargets.size()), Heuristic, [StartId](int32 CellId) { return CellId == StartId; }, StartId, Cancellation, Stats);
+		if (ReachedId != INDEX_NONE)
+		{
+			for (int32 CellId = Nodes->GetParent(StartId); CellId != INDEX_NONE; CellId = Nodes->GetParent(CellId))
+			{
+				OutPath.push_back(CellId);
+			}
+			ReachedId = OutPath.back();
+		}
+	}
+
+	if (ReachedId == INDEX_NONE)
+	{
+		return false;
+	}
+	OutTargetIndex = int32(std::find(TargetIds.begin(), TargetIds.end(), ReachedId) - TargetIds.begin());
+	return true;
+}
+
+template <typename HeuristicType, typename GoalType>
+int32 FGridAStar::Search(FGridGraph& Graph, FAStarNodeTable& Nodes, const int32* SourceIds, int32 NumSources, const HeuristicType& Heuristic, const GoalType& IsGoal, int32 BlockedGoalId, const FPathCancellationToken* Cancellation, FPathSearchStats& Stats)
+{
+	FAStarOpenSet OpenSet(Nodes, &Stats);
+	const FEdgeCostSnapshot EdgeCosts = Graph.GetEdgeCosts();
+
+	int32 InlineHeuristics[8];
+	std::vector<int32> HeapHeuristics;
+	int32* NeighbourHeuristics = InlineHeuristics;
+	if (Graph.GetMaxEdges() > 8)
+	{
+		HeapHeuristics.resize(Graph.GetMaxEdges());
+		NeighbourHeuristics = HeapHeuristics.data();
+	}
+
+	for (int32 Source = 0; Source < NumSources; ++Source)
+	{
+		const int32 SourceId = SourceIds[Source];
+		if (Nodes.IsVisited(SourceId))
+		{
+			continue;
+		}
+		Nodes.Visit(SourceId);
+		Nodes.SetGCost(SourceId, 0);
+		Nodes.SetHCost(SourceId, Heuristic.Get(SourceId));
+		OpenSet.Push(SourceId);
+		++Stats.NodesGenerated;
+	}
+
+	while (!OpenSet.IsEmpty())
+	{
+		if (Cancellation && Cancellation->IsCancelled())
+		{
+			break;
+		}
+
+		const int32 CurrentId = OpenSet.Pop();
+		++Stats.NodesExpanded;
+
+		if (IsGoal(CurrentId))
+		{
+			return CurrentId;
+		}
+
+		const int32 FirstEdge = Graph.GetFirstEdge(CurrentId);
+		Heuristic.GetNeighbours(CurrentId, NeighbourHeuristics);
+		Stats.NeighboursEvaluated += Graph.GetEndEdge(CurrentId) - FirstEdge;
+
+		for (int32 Edge = FirstEdge; Edge < Graph.GetEndEdge(CurrentId); ++Edge)
+		{
+			const int32 NeighbourId = Graph.GetEdgeTarget(Edge);
+
+			if ((!Graph.IsWalkable(NeighbourId) && NeighbourId != BlockedGoalId) || Nodes.IsClosed(NeighbourId) || !Graph.IsMoveAllowed(CurrentId, NeighbourId))
+			{
+				continue;
+			}
+
+			if (!Nodes.IsVisited(NeighbourId))
+			{
+				Nodes.Visit(NeighbourId);
+			}
+
+			const bool bInOpenSet = OpenSet.Contains(NeighbourId);
+			const int32 MovementCost = Nodes.GetGCost(CurrentId) + EdgeCosts[Edge];
+			if (MovementCost < Nodes.GetGCost(NeighbourId) || !bInOpenSet)
+			{
+				Nodes.SetGCost(NeighbourId, MovementCost);
+				Nodes.SetHCost(NeighbourId, NeighbourHeuristics[Edge - FirstEdge]);
+				Nodes.SetParent(NeighbourId, CurrentId);
+
+				if (bInOpenSet)
+				{
+					OpenSet.Update(NeighbourId);
+				}
+				else
+				{
+					OpenSet.Push(NeighbourId);
+					++Stats.NodesGenerated;
+				}
+			}
+		}
+	}
+	return INDEX_NONE;
+}
+
+template bool FGridAStar::FindPath<FOctileHeuristic>(FGridGraph&, int32, int32, std::vector<int32>&, const FPathCancellationToken*, FPathSearchStats*);
+template bool FGridAStar::FindPath<FManhattanHeuristic>(FGridGraph&, int32, int32, std::vector<int32>&, const FPathCancellationToken*, FPathSearchStats*);
+template bool FGridAStar::FindPathWithHeuristic<FLandmarkHeuristic>(FGridGraph&, int32, int32, const FLandmarkHeuristic&, std::vector<int32>&, const FPathCancellationToken*, FPathSearchStats*);
+
+void FGridAStar::RetracePath(const FAStarNodeTable& Nodes, int32 StartId, int32 TargetId, std::vector<int32>& OutPath)
+{
+	// Count the steps first so the cells can be written straight into their final slots
+	int32 NumSteps = 0;
+	for (int32 CurrentId = TargetId; CurrentId != StartId; CurrentId = Nodes.GetParent(CurrentId))
+	{
+		++NumSteps;
+	}
+
+	OutPath.resize(NumSteps);
+	for (int32 CurrentId = TargetId; CurrentId != StartId; CurrentId = Nodes.GetParent(CurrentId))
+	{
+		OutPath[--NumSteps] = CurrentId;
+	}
+}
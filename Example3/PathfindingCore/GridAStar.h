@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <vector>
+
+class FGridGraph;
+class FAStarNodeTable;
+
+/** A* over an FGridGraph, on cell ids only */
+class INVADED_API FGridAStar
+{
+public:
+	/**
+	 * Fills OutPath with the cells after StartId up to TargetId, false when the target can't be reached or the search was cancelled.
+	 * HeuristicPolicy is FOctileHeuristic or FManhattanHeuristic from PathHeuristics.h.
+	 */
+	template <typename HeuristicPolicy>
+	static bool FindPath(FGridGraph& Graph, int32 StartId, int32 TargetId, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation = nullptr, FPathSearchStats* OutStats = nullptr);
+
+	/**
+	 * Same search with an estimate that needs more than the target coordinates, HeuristicType is
+	 * TGridHeuristic or FLandmarkHeuristic and has to be consistent for the path to be optimal.
+	 */
+	template <typename HeuristicType>
+	static bool FindPathWithHeuristic(FGridGraph& Graph, int32 StartId, int32 TargetId, const HeuristicType& Heuristic, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation = nullptr, FPathSearchStats* OutStats = nullptr);
+
+	/**
+	 * Weighted A*, estimates are inflated by 1 + Epsilon and closed nodes are never reopened. The path costs at
+	 * most (1 + Epsilon) times the optimal one and usually takes far fewer expansions to find.
+	 */
+	static bool FindPathWeighted(FGridGraph& Graph, int32 StartId, int32 TargetId, float Epsilon, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation = nullptr, FPathSearchStats* OutStats = nullptr);
+
+	/** Targets up to which FindPathToNearest estimates with the nearest one, past that the minimum costs more than it saves */
+	static constexpr int32 MaxHeuristicTargets = 16;
+
+	/**
+	 * Fills OutPath with the cells after StartId up to whichever of TargetIds is cheapest to reach and OutTargetIndex with its
+	 * index in TargetIds, false when none can be reached or the search was cancelled. Blocked targets are never reached.
+	 * Up to MaxHeuristicTargets targets this is A* estimating with the nearest target. With more, every target seeds one
+	 * multi-source search backwards to StartId, estimating with the distance to the start; moves on an FGridGraph are
+	 * symmetric, so the first time the start comes off the open set its parent chain is the path forwards.
+	 */
+	static bool FindPathToNearest(FGridGraph& Graph, int32 StartId, const std::vector<int32>& TargetIds, std::vector<int32>& OutPath, int32& OutTargetIndex, const FPathCancellationToken* Cancellation = nullptr, FPathSearchStats* OutStats = nullptr);
+
+	/** Follows parents from TargetId back to StartId, OutPath gets the cells after StartId in walking order */
+	static void RetracePath(const FAStarNodeTable& Nodes, int32 StartId, int32 TargetId, std::vector<int32>& OutPath);
+
+private:
+	/**
+	 * A* from every source at once until a cell IsGoal accepts comes off the open set, returns that cell or INDEX_NONE.
+	 * Blocked cells are never entered, except for BlockedGoalId, so a backward search can end on a blocked start.
+	 */
+	template <typename HeuristicType, typename GoalType>
+	static int32 Search(FGridGraph& Graph, FAStarNodeTable& Nodes, const int32* SourceIds, int32 NumSources, const HeuristicType& Heuristic, const GoalType& IsGoal, int32 BlockedGoalId, const FPathCancellationToken* Cancellation, FPathSearchStats& Stats);
+};
@@ -0,0 +1,436 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GridBenchmark.h"
+#include "FocalSearch.h"
+#include "GridAStar.h"
+#include "HierarchicalPathfinder.h"
+#include "JumpPointSearch.h"
+#include "JumpPointTable.h"
+#include "LandmarkHeuristic.h"
+#include "PathHeuristics.h"
+#include "ThetaStar.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace
+{
+	typedef std::chrono::steady_clock FBenchmarkClock;
+
+	double GetMilliseconds(FBenchmarkClock::time_point Begin, FBenchmarkClock::time_point End)
+	{
+		return std::chrono::duration<double, std::milli>(End - Begin).count();
+	}
+
+	double GetPercentile(const std::vector<double>& Sorted, int32 Percent)
+	{
+		return Sorted.empty() ? 0.0 : Sorted[(Sorted.size() - 1) * Percent / 100];
+	}
+
+	bool ReadLines(const std::string& Filename, std::vector<std::string>& OutLines)
+	{
+		std::ifstream File(Filename);
+		if (!File)
+		{
+			return false;
+		}
+
+		std::string Line;
+		while (std::getline(File, Line))
+		{
+			if (!Line.empty() && Line.back() == '\r')
+			{
+				Line.pop_back();
+			}
+			OutLines.push_back(Line);
+		}
+		return true;
+	}
+}
+
+constexpr int32 FGridBenchmark::StraightCost;
+constexpr int32 FGridBenchmark::DiagonalCost;
+constexpr double FGridBenchmark::LengthTolerance;
+
+bool FGridBenchmark::LoadMovingAIMap(const std::string& Filename, FBenchmarkMap& OutMap)
+{
+	std::vector<std::string> Lines;
+	if (!ReadLines(Filename, Lines))
+	{
+		return false;
+	}
+
+	// Header lines are "key value" up to a line that only says "map"
+	int32 Line = 0;
+	for (; Line < int32(Lines.size()) && Lines[Line] != "map"; ++Line)
+	{
+		std::istringstream Header(Lines[Line]);
+		std::string Key;
+		int32 Value = 0;
+		if (Header >> Key >> Value)
+		{
+			if (Key == "width")
+			{
+				OutMap.Width = Value;
+			}
+			else if (Key == "height")
+			{
+				OutMap.Height = Value;
+			}
+		}
+	}
+	if (OutMap.Width <= 0 || OutMap.Height <= 0 || int32(Lines.size()) - Line - 1 < OutMap.Height)
+	{
+		return false;
+	}
+
+	OutMap.Walkable.assign(OutMap.Width * OutMap.Height, false);
+	for (int32 Y = 0; Y < OutMap.Height; ++Y)
+	{
+		const std::string& Row = Lines[Line + 1 + Y];
+		for (int32 X = 0; X < std::min(OutMap.Width, int32(Row.size())); ++X)
+		{
+			// Ground, grass and swamp are passable, trees, water and out of bounds tiles are not
+			const char Tile = Row[X];
+			OutMap.Walkable[Y * OutMap.Width + X] = Tile == '.' || Tile == 'G' || Tile == 'S';
+		}
+	}
+	return true;
+}
+
+bool FGridBenchmark::LoadMovingAIScenarios(const std::string& Filename, const FBenchmarkMap& Map, std::vector<FBenchmarkQuery>& OutQueries)
+{
+	std::vector<std::string> Lines;
+	if (!ReadLines(Filename, Lines))
+	{
+		return false;
+	}
+
+	// bucket, map, map width, map height, start x, start y, goal x, goal y, optimal length
+	for (const std::string& Line : Lines)
+	{
+		std::istringstream Fields(Line);
+		int32 Bucket;
+		std::string MapName;
+		int32 MapWidth, MapHeight, StartX, StartY, TargetX, TargetY;
+		double OptimalLength;
+		if (!(Fields >> Bucket >> MapName >> MapWidth >> MapHeight >> StartX >> StartY >> TargetX >> TargetY >> OptimalLength))
+		{
+			continue;
+		}
+		if (MapWidth != Map.Width || MapHeight != Map.Height)
+		{
+			return false;
+		}
+		if (StartX < 0 || StartY < 0 || TargetX < 0 || TargetY < 0 ||
+			StartX >= Map.Width || StartY >= Map.Height || TargetX >= Map.Width || TargetY >= Map.Height)
+		{
+			continue;
+		}
+
+		FBenchmarkQuery Query;
+		Query.StartId = StartY * Map.Width + StartX;
+		Query.TargetId = TargetY * Map.Width + TargetX;
+		Query.OptimalLength = OptimalLength;
+		OutQueries.push_back(Query);
+	}
+	return !OutQueries.empty();
+}
+
+void FGridBenchmark::GenerateMaze(int32 Size, uint32 Seed, FBenchmarkMap& OutMap)
+{
+	Size = std::max(Size, 3);
+	OutMap.Width = Size;
+	OutMap.Height = Size;
+	OutMap.Walkable.assign(Size * Size, false);
+
+	// Rooms sit on odd coordinates, carving a step opens the wall cell between two rooms
+	std::mt19937 Random(Seed);
+	const int32 Rooms = (Size - 1) / 2;
+	const FGridCoord Steps[4] = { FGridCoord(1, 0), FGridCoord(-1, 0), FGridCoord(0, 1), FGridCoord(0, -1) };
+	std::vector<bool> Visited(Rooms * Rooms, false);
+	std::vector<FGridCoord> Stack;
+	Stack.push_back(FGridCoord(0, 0));
+	Visited[0] = true;
+	OutMap.Walkable[Size + 1] = true;
+	while (!Stack.empty())
+	{
+		const FGridCoord Room = Stack.back();
+		FGridCoord Options[4];
+		int32 NumOptions = 0;
+		for (const FGridCoord& Step : Steps)
+		{
+			const FGridCoord Next = Room + Step;
+			if (Next.X >= 0 && Next.Y >= 0 && Next.X < Rooms && Next.Y < Rooms && !Visited[Next.Y * Rooms + Next.X])
+			{
+				Options[NumOptions++] = Next;
+			}
+		}
+		if (NumOptions == 0)
+		{
+			Stack.pop_back();
+			continue;
+		}
+
+		const FGridCoord Next = Options[Random() % NumOptions];
+		Visited[Next.Y * Rooms + Next.X] = true;
+		OutMap.Walkable[(Room.Y + Next.Y + 1) * Size + Room.X + Next.X + 1] = true;
+		OutMap.Walkable[(Next.Y * 2 + 1) * Size + Next.X * 2 + 1] = true;
+		Stack.push_back(Next);
+	}
+}
+
+void FGridBenchmark::GenerateOpenField(int32 Size, uint32 Seed, FBenchmarkMap& OutMap)
+{
+	Size = std::max(Size, 1);
+	OutMap.Width = Size;
+	OutMap.Height = Size;
+	OutMap.Walkable.assign(Size * Size, false);
+
+	std::mt19937 Random(Seed);
+	std::uniform_real_distribution<float> Distribution(0.0f, 1.0f);
+	for (int32 CellId = 0; CellId < Size * Size; ++CellId)
+	{
+		OutMap.Walkable[CellId] = Distribution(Random) >= 0.2f;
+	}
+}
+
+const char* FGridBenchmark::GetModeName(EPathSearchMode Mode)
+{
+	switch (Mode)
+	{
+	case EPathSearchMode::JumpPoint:
+		return "JumpPoint";
+	case EPathSearchMode::Hierarchical:
+		return "Hierarchical";
+	case EPathSearchMode::AnyAngle:
+		return "AnyAngle";
+	case EPathSearchMode::JumpPointPlus:
+		return "JumpPointPlus";
+	case EPathSearchMode::WeightedAStar:
+		return "WeightedAStar";
+	case EPathSearchMode::Focal:
+		return "Focal";
+	default:
+		return "AStar";
+	}
+}
+
+FGridBenchmark::FGridBenchmark(const FBenchmarkMap& Map)
+{
+	NumLandmarks = 0;
+	SuboptimalityBound = 0.0;
+	Graph.BuildLattice(Map.Width, Map.Height, Map.Walkable, StraightCost, DiagonalCost);
+}
+
+FGridBenchmark::~FGridBenchmark()
+{
+}
+
+bool FGridBenchmark::GenerateQueries(int32 NumQueries, uint32 Seed)
+{
+	std::vector<int32> WalkableCells;
+	for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+	{
+		if (Graph.IsWalkable(CellId))
+		{
+			WalkableCells.push_back(CellId);
+		}
+	}
+	if (WalkableCells.empty())
+	{
+		return false;
+	}
+
+	std::mt19937 Random(Seed);
+	std::vector<int32> Path;
+	Queries.resize(NumQueries);
+	for (FBenchmarkQuery& Query : Queries)
+	{
+		Query.StartId = WalkableCells[Random() % WalkableCells.size()];
+		Query.TargetId = WalkableCells[Random() % WalkableCells.size()];
+		Query.OptimalLength = FGridAStar::FindPath<FOctileHeuristic>(Graph, Query.StartId, Query.TargetId, Path) ? GetPathLength(Query.StartId, Path) : -1.0;
+	}
+	return true;
+}
+
+void FGridBenchmark::SetLandmarks(int32 InNumLandmarks, const std::string& InCacheFile)
+{
+	NumLandmarks = InNumLandmarks;
+	LandmarksCacheFile = InCacheFile;
+	Landmarks.reset();
+}
+
+FBenchmarkResult FGridBenchmark::Run(EPathSearchMode Mode)
+{
+	FBenchmarkResult Result;
+	Result.Mode = Mode;
+
+	if (Mode == EPathSearchMode::Hierarchical && !Hierarchy)
+	{
+		const FBenchmarkClock::time_point Begin = FBenchmarkClock::now();
+		Hierarchy.reset(new FHierarchicalPathfinder(Graph));
+		Hierarchy->Build();
+		Result.PreprocessMilliseconds = GetMilliseconds(Begin, FBenchmarkClock::now());
+	}
+	if (Mode == EPathSearchMode::JumpPointPlus && !JumpPoints)
+	{
+		const FBenchmarkClock::time_point Begin = FBenchmarkClock::now();
+		JumpPoints.reset(new FJumpPointTable(Graph));
+		JumpPoints->Build();
+		Result.PreprocessMilliseconds = GetMilliseconds(Begin, FBenchmarkClock::now());
+	}
+	if (Mode == EPathSearchMode::AStar && NumLandmarks > 0 && !Landmarks)
+	{
+		const FBenchmarkClock::time_point Begin = FBenchmarkClock::now();
+		Landmarks.reset(new FLandmarkTable());
+		if (LandmarksCacheFile.empty() || !Landmarks->Load(LandmarksCacheFile, Graph) || Landmarks->GetNumLandmarks() != NumLandmarks)
+		{
+			Landmarks->Build(Graph, NumLandmarks);
+			if (!LandmarksCacheFile.empty())
+			{
+				Landmarks->Save(LandmarksCacheFile);
+			}
+		}
+		Result.PreprocessMilliseconds = GetMilliseconds(Begin, FBenchmarkClock::now());
+	}
+
+	const bool bOptimal = Mode == EPathSearchMode::AStar || Mode == EPathSearchMode::JumpPoint || Mode == EPathSearchMode::JumpPointPlus;
+	const bool bBounded = Mode == EPathSearchMode::WeightedAStar || Mode == EPathSearchMode::Focal;
+	const bool bAnyAngle = Mode == EPathSearchMode::AnyAngle;
+	if (bBounded)
+	{
+		Result.SuboptimalityBound = SuboptimalityBound;
+	}
+	std::vector<double> Latencies;
+	Latencies.reserve(Queries.size());
+	std::vector<int32> Path;
+	double TotalMilliseconds = 0.0;
+	int64 Expansions = 0;
+	int64 HeapOperations = 0;
+	int64 Neighbours = 0;
+	double SumRatio = 0.0;
+	double WorstRatio = 0.0;
+	int32 NumRatios = 0;
+	int64 Waypoints = 0;
+	int32 NumFound = 0;
+	for (const FBenchmarkQuery& Query : Queries)
+	{
+		FPathSearchStats Stats;
+		const FBenchmarkClock::time_point Begin = FBenchmarkClock::now();
+		const bool bFound = FindPath(Mode, Query, Path, Stats);
+		const FBenchmarkClock::time_point End = FBenchmarkClock::now();
+
+		const double Milliseconds = GetMilliseconds(Begin, End);
+		Latencies.push_back(Milliseconds);
+		TotalMilliseconds += Milliseconds;
+		Expansions += Stats.NodesExpanded;
+		HeapOperations += Stats.HeapPushes + Stats.HeapPops;
+		Neighbours += Stats.NeighboursEvaluated;
+
+		const bool bReachable = Query.OptimalLength >= 0.0;
+		if (bFound != bReachable || (bFound && !IsValidPath(Query, Path, bAnyAngle)))
+		{
+			++Result.NumWrong;
+			continue;
+		}
+		if (bFound)
+		{
+			Waypoints += Path.size();
+			++NumFound;
+		}
+		if (!bFound || Query.OptimalLength <= 0.0)
+		{
+			continue;
+		}
+
+		const double Length = GetPathLength(Query.StartId, Path);
+		if (bOptimal)
+		{
+			if (std::abs(Length - Query.OptimalLength) > LengthTolerance * Query.OptimalLength)
+			{
+				++Result.NumWrong;
+			}
+		}
+		else
+		{
+			const double Ratio = Length / Query.OptimalLength;
+			if (bBounded && Ratio > (1.0 + SuboptimalityBound) * (1.0 + LengthTolerance))
+			{
+				++Result.NumWrong;
+			}
+			SumRatio += Ratio;
+			WorstRatio = std::max(WorstRatio, Ratio);
+			++NumRatios;
+		}
+	}
+
+	std::sort(Latencies.begin(), Latencies.end());
+	Result.QueriesPerSecond = TotalMilliseconds > 0.0 ? Queries.size() * 1000.0 / TotalMilliseconds : 0.0;
+	Result.ExpansionsPerQuery = Queries.empty() ? 0.0 : double(Expansions) / Queries.size();
+	Result.HeapOperationsPerQuery = Queries.empty() ? 0.0 : double(HeapOperations) / Queries.size();
+	Result.NeighboursPerQuery = Queries.empty() ? 0.0 : double(Neighbours) / Queries.size();
+	Result.P50Milliseconds = GetPercentile(Latencies, 50);
+	Result.P99Milliseconds = GetPercentile(Latencies, 99);
+	Result.MeanLengthRatio = NumRatios > 0 ? SumRatio / NumRatios : 1.0;
+	Result.WorstLengthRatio = NumRatios > 0 ? WorstRatio : 1.0;
+	Result.WaypointsPerQuery = NumFound > 0 ? double(Waypoints) / NumFound : 0.0;
+	return Result;
+}
+
+double FGridBenchmark::GetPathLength(int32 StartId, const std::vector<int32>& Path) const
+{
+	double Length = 0.0;
+	FGridCoord Previous = Graph.GetCoord(StartId);
+	for (int32 CellId : Path)
+	{
+		const FGridCoord Delta = Graph.GetCoord(CellId) - Previous;
+		Length += std::sqrt(double(Delta.X) * Delta.X + double(Delta.Y) * Delta.Y);
+		Previous = Graph.GetCoord(CellId);
+	}
+	return Length;
+}
+
+bool FGridBenchmark::IsValidPath(const FBenchmarkQuery& Query, const std::vector<int32>& Path, bool bAnyAngle) const
+{
+	int32 PreviousId = Query.StartId;
+	for (int32 CellId : Path)
+	{
+		// For single steps line of sight is the same as a walkable neighbour reached without cutting a corner
+		const FGridCoord Delta = Graph.GetCoord(CellId) - Graph.GetCoord(PreviousId);
+		if ((!bAnyAngle && (std::abs(Delta.X) > 1 || std::abs(Delta.Y) > 1)) || !FThetaStar::HasLineOfSight(Graph, PreviousId, CellId))
+		{
+			return false;
+		}
+		PreviousId = CellId;
+	}
+	return PreviousId == Query.TargetId;
+}
+
+bool FGridBenchmark::FindPath(EPathSearchMode Mode, const FBenchmarkQuery& Query, std::vector<int32>& OutPath, FPathSearchStats& OutStats)
+{
+	switch (Mode)
+	{
+	case EPathSearchMode::JumpPoint:
+		return FJumpPointSearch::FindPath(Graph, Query.StartId, Query.TargetId, OutPath, nullptr, &OutStats);
+	case EPathSearchMode::Hierarchical:
+		return Hierarchy->FindPath(Query.StartId, Query.TargetId, OutPath, nullptr, &OutStats);
+	case EPathSearchMode::AnyAngle:
+		return FThetaStar::FindPath(Graph, Query.StartId, Query.TargetId, OutPath, nullptr, &OutStats);
+	case EPathSearchMode::JumpPointPlus:
+		return FJumpPointSearch::FindPath(*JumpPoints, Query.StartId, Query.TargetId, OutPath, nullptr, &OutStats);
+	case EPathSearchMode::WeightedAStar:
+		return FGridAStar::FindPathWeighted(Graph, Query.StartId, Query.TargetId, float(SuboptimalityBound), OutPath, nullptr, &OutStats);
+	case EPathSearchMode::Focal:
+		return FFocalSearch::FindPath(Graph, Query.StartId, Query.TargetId, float(SuboptimalityBound), OutPath, nullptr, &OutStats);
+	default:
+		if (Landmarks)
+		{
+			return FGridAStar::FindPathWithHeuristic(Graph, Query.StartId, Query.TargetId, FLandmarkHeuristic(Graph, *Landmarks, Query.TargetId), OutPath, nullptr, &OutStats);
+		}
+		return FGridAStar::FindPath<FOctileHeuristic>(Graph, Query.StartId, Query.TargetId, OutPath, nullptr, &OutStats);
+	}
+}
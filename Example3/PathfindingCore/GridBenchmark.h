@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include "GridGraph.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+class FHierarchicalPathfinder;
+class FJumpPointTable;
+class FLandmarkTable;
+
+/** Grid to benchmark on, one walkable flag per cell id */
+struct FBenchmarkMap
+{
+	int32 Width = 0;
+	int32 Height = 0;
+	std::vector<bool> Walkable;
+};
+
+struct FBenchmarkQuery
+{
+	int32 StartId;
+	int32 TargetId;
+
+	/** Shortest length with diagonal steps of sqrt(2), negative when the target can't be reached */
+	double OptimalLength;
+};
+
+/** What one mode did over the whole query set */
+struct FBenchmarkResult
+{
+	EPathSearchMode Mode = EPathSearchMode::AStar;
+	double QueriesPerSecond = 0.0;
+	double ExpansionsPerQuery = 0.0;
+
+	/** Open list pushes and pops, and neighbours looked at, per query */
+	double HeapOperationsPerQuery = 0.0;
+	double NeighboursPerQuery = 0.0;
+	double P50Milliseconds = 0.0;
+	double P99Milliseconds = 0.0;
+
+	/** Time spent preprocessing before the first query, HPA*, JPS+ and A* with landmarks only */
+	double PreprocessMilliseconds = 0.0;
+
+	/** Epsilon the bounded modes ran with, paths may be up to 1 + epsilon times the reference */
+	double SuboptimalityBound = 0.0;
+
+	/** Invalid paths, reachability mismatches, for optimal modes lengths off the reference and for bounded modes lengths over the bound */
+	int32 NumWrong = 0;
+
+	/** Path length over the reference, near-optimal, bounded and any-angle modes only, any-angle paths can beat the 8-connected reference */
+	double MeanLengthRatio = 1.0;
+	double WorstLengthRatio = 1.0;
+
+	/** Points per found path, one per cell except for the any-angle mode which keeps the turning points only */
+	double WaypointsPerQuery = 0.0;
+};
+
+/**
+ * Runs the search modes over one set of queries on a grid and measures them.
+ * Maps are Moving AI benchmark maps (.map, with the matching .scen for known optimal lengths)
+ * or generated mazes and open fields. Without scenarios plain A* serves as the reference.
+ */
+class INVADED_API FGridBenchmark
+{
+public:
+	/** Fine enough that a path optimal in these units is optimal in true length to well within the tolerance */
+	static constexpr int32 StraightCost = 1000;
+	static constexpr int32 DiagonalCost = 1414;
+
+	static constexpr double LengthTolerance = 1e-3;
+
+	static bool LoadMovingAIMap(const std::string& Filename, FBenchmarkMap& OutMap);
+	static bool LoadMovingAIScenarios(const std::string& Filename, const FBenchmarkMap& Map, std::vector<FBenchmarkQuery>& OutQueries);
+
+	/** Perfect maze carved by a randomized depth-first walk, corridors and walls one cell wide */
+	static void GenerateMaze(int32 Size, uint32 Seed, FBenchmarkMap& OutMap);
+
+	/** Open ground with scattered single-cell obstacles */
+	static void GenerateOpenField(int32 Size, uint32 Seed, FBenchmarkMap& OutMap);
+
+	static const char* GetModeName(EPathSearchMode Mode);
+
+	explicit FGridBenchmark(const FBenchmarkMap& Map);
+	~FGridBenchmark();
+
+	/** Uses queries with known optimal lengths, from a scenario file */
+	void SetQueries(const std::vector<FBenchmarkQuery>& InQueries) { Queries = InQueries; }
+
+	/** Random pairs of walkable cells with plain A* as the reference, false when nothing is walkable */
+	bool GenerateQueries(int32 NumQueries, uint32 Seed);
+
+	int32 GetNumQueries() const { return int32(Queries.size()); }
+
+	FGridGraph& GetGraph() { return Graph; }
+
+	/**
+	 * Makes A* estimate with landmarks (ALT) instead of octile distances, the table is built before the first
+	 * A* run. With a cache file the table is read from it when it was written for this map, and written to it otherwise.
+	 */
+	void SetLandmarks(int32 InNumLandmarks, const std::string& InCacheFile = std::string());
+
+	/** Epsilon for the bounded suboptimal modes, weighted A* and focal search */
+	void SetSuboptimalityBound(double InSuboptimalityBound) { SuboptimalityBound = InSuboptimalityBound; }
+
+	/** Answers every query with the mode and checks the paths */
+	FBenchmarkResult Run(EPathSearchMode Mode);
+
+	/** Euclidean length of the path, diagonal steps count sqrt(2) */
+	double GetPathLength(int32 StartId, const std::vector<int32>& Path) const;
+
+	/**
+	 * Every step goes to a walkable neighbour without cutting corners and the path ends on the target.
+	 * With bAnyAngle steps may be longer straight segments, as long as they have line of sight.
+	 */
+	bool IsValidPath(const FBenchmarkQuery& Query, const std::vector<int32>& Path, bool bAnyAngle = false) const;
+
+private:
+	bool FindPath(EPathSearchMode Mode, const FBenchmarkQuery& Query, std::vector<int32>& OutPath, FPathSearchStats& OutStats);
+
+	FGridGraph Graph;
+	std::unique_ptr<FHierarchicalPathfinder> Hierarchy;
+	std::unique_ptr<FJumpPointTable> JumpPoints;
+
+	int32 NumLandmarks;
+	std::string LandmarksCacheFile;
+	std::unique_ptr<FLandmarkTable> Landmarks;
+
+	double SuboptimalityBound;
+
+	std::vector<FBenchmarkQuery> Queries;
+};
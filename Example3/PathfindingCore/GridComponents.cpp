@@ -0,0 +1,407 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GridComponents.h"
+#include "GridGraph.h"
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+
+FGridComponents::FGridComponents(FGridGraph& InGraph)
+	: Graph(InGraph)
+	, VisitStamp(0)
+{
+}
+
+void FGridComponents::Build()
+{
+	std::unique_lock<std::shared_mutex> WriteLock(Lock);
+
+	Labels.assign(Graph.Num(), INDEX_NONE);
+	Sizes.clear();
+	FreeLabels.clear();
+	VisitStamps.clear();
+	VisitOwners.clear();
+	VisitStamp = 0;
+
+	for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+	{
+		if (Graph.IsWalkable(CellId) && Labels[CellId] == INDEX_NONE)
+		{
+			const int32 Label = AllocateLabel();
+			Labels[CellId] = Label;
+			Sizes[Label] = 1 + Relabel(CellId, INDEX_NONE, Label);
+		}
+	}
+}
+
+void FGridComponents::Build(const int32* InLabels)
+{
+	std::unique_lock<std::shared_mutex> WriteLock(Lock);
+
+	Labels.assign(InLabels, InLabels + Graph.Num());
+	Sizes.clear();
+	FreeLabels.clear();
+	VisitStamps.clear();
+	VisitOwners.clear();
+	VisitStamp = 0;
+
+	for (int32 Label : Labels)
+	{
+		if (Label != INDEX_NONE)
+		{
+			if (Label >= int32(Sizes.size()))
+			{
+				Sizes.resize(Label + 1, 0);
+			}
+			++Sizes[Label];
+		}
+	}
+
+	// Labels freed before the file was written leave gaps, those go back on the free list
+	for (int32 Label = 0; Label < int32(Sizes.size()); ++Label)
+	{
+		if (Sizes[Label] == 0)
+		{
+			FreeLabels.push_back(Label);
+		}
+	}
+}
+
+void FGridComponents::OnWalkabilityChanged(int32 CellId)
+{
+	std::unique_lock<std::shared_mutex> WriteLock(Lock);
+
+	const bool bWalkable = Graph.IsWalkable(CellId);
+	if (bWalkable == (Labels[CellId] != INDEX_NONE))
+	{
+		return;
+	}
+
+	if (bWalkable)
+	{
+		// Every move the cell enables runs through it or past its corner, between two of its own neighbours
+		std::vector<int32> Merged;
+		int32 KeptLabel = INDEX_NONE;
+		for (int32 Edge = Graph.GetFirstEdge(CellId); Edge < Graph.GetEndEdge(CellId); ++Edge)
+		{
+			const int32 NeighbourId = Graph.GetEdgeTarget(Edge);
+			const int32 Label = Labels[NeighbourId];
+			if (Label == INDEX_NONE || !Graph.IsMoveAllowed(CellId, NeighbourId) || std::find(Merged.begin(), Merged.end(), Label) != Merged.end())
+			{
+				continue;
+			}
+			Merged.push_back(Label);
+			if (KeptLabel == INDEX_NONE || Sizes[Label] > Sizes[KeptLabel])
+			{
+				KeptLabel = Label;
+			}
+		}
+
+		if (KeptLabel == INDEX_NONE)
+		{
+			KeptLabel = AllocateLabel();
+		}
+		Labels[CellId] = KeptLabel;
+		++Sizes[KeptLabel];
+
+		// The cell carries the kept label already, relabelling the others from it reaches every one of them
+		for (int32 Label : Merged)
+		{
+			if (Label != KeptLabel)
+			{
+				Sizes[KeptLabel] += Relabel(CellId, Label, KeptLabel);
+				FreeLabel(Label);
+			}
+		}
+		return;
+	}
+
+	const int32 Label = Labels[CellId];
+	Labels[CellId] = INDEX_NONE;
+	if (--Sizes[Label] == 0)
+	{
+		FreeLabel(Label);
+		return;
+	}
+
+	// Blocking the cell also forbids diagonal moves past its corners, all of them between its neighbours
+	std::vector<int32> Seeds;
+	for (int32 Edge = Graph.GetFirstEdge(CellId); Edge < Graph.GetEndEdge(CellId); ++Edge)
+	{
+		const int32 NeighbourId = Graph.GetEdgeTarget(Edge);
+		if (Labels[NeighbourId] == Label)
+		{
+			Seeds.push_back(NeighbourId);
+		}
+	}
+	if (Seeds.size() > 1)
+	{
+		SplitComponent(Label, Seeds);
+	}
+}
+
+int32 FGridComponents::GetComponent(int32 CellId) const
+{
+	std::shared_lock<std::shared_mutex> ReadLock(Lock);
+	return Labels[CellId];
+}
+
+bool FGridComponents::AreConnected(int32 StartId, int32 TargetId) const
+{
+	if (StartId == TargetId)
+	{
+		return true;
+	}
+
+	std::shared_lock<std::shared_mutex> ReadLock(Lock);
+	const int32 TargetLabel = Labels[TargetId];
+	if (TargetLabel == INDEX_NONE)
+	{
+		return false;
+	}
+	if (Labels[StartId] != INDEX_NONE)
+	{
+		return Labels[StartId] == TargetLabel;
+	}
+
+	std::vector<int32> StartLabels;
+	GetStartComponents(StartId, StartLabels);
+	return std::find(StartLabels.begin(), StartLabels.end(), TargetLabel) != StartLabels.end();
+}
+
+int32 FGridComponents::FindNearestReachableCell(int32 StartId, int32 TargetId) const
+{
+	if (StartId == TargetId)
+	{
+		return TargetId;
+	}
+
+	std::shared_lock<std::shared_mutex> ReadLock(Lock);
+	std::vector<int32> StartLabels;
+	GetStartComponents(StartId, StartLabels);
+	if (StartLabels.empty())
+	{
+		return INDEX_NONE;
+	}
+
+	// Walk square rings outwards from the target, no cell on ring R is closer than R
+	const FGridCoord Target = Graph.GetCoord(TargetId);
+	const int32 MaxRadius = std::max(Graph.GetWidth(), Graph.GetHeight());
+	int64 BestDistance = MAX_int32;
+	int32 BestId = INDEX_NONE;
+	auto Consider = [this, &StartLabels, &Target, &BestDistance, &BestId](int32 X, int32 Y)
+	{
+		if (!Graph.IsValidCoord(X, Y))
+		{
+			return;
+		}
+		const int32 CellId = Graph.GetCellId(X, Y);
+		const int64 Distance = int64(X - Target.X) * (X - Target.X) + int64(Y - Target.Y) * (Y - Target.Y);
+		if (Distance < BestDistance && Labels[CellId] != INDEX_NONE && std::find(StartLabels.begin(), StartLabels.end(), Labels[CellId]) != StartLabels.end())
+		{
+			BestDistance = Distance;
+			BestId = CellId;
+		}
+	};
+
+	for (int32 Radius = 0; Radius <= MaxRadius && int64(Radius) * Radius <= BestDistance; ++Radius)
+	{
+		for (int32 X = Target.X - Radius; X <= Target.X + Radius; ++X)
+		{
+			Consider(X, Target.Y - Radius);
+			if (Radius > 0)
+			{
+				Consider(X, Target.Y + Radius);
+			}
+		}
+		for (int32 Y = Target.Y - Radius + 1; Y < Target.Y + Radius; ++Y)
+		{
+			Consider(Target.X - Radius, Y);
+			Consider(Target.X + Radius, Y);
+		}
+	}
+	return BestId;
+}
+
+int32 FGridComponents::GetNumComponents() const
+{
+	std::shared_lock<std::shared_mutex> ReadLock(Lock);
+	return int32(Sizes.size() - FreeLabels.size());
+}
+
+SIZE_T FGridComponents::GetAllocatedSize() const
+{
+	std::shared_lock<std::shared_mutex> ReadLock(Lock);
+	return (Labels.capacity() + Sizes.capacity() + FreeLabels.capacity() + VisitOwners.capacity()) * sizeof(int32) + VisitStamps.capacity() * sizeof(uint32);
+}
+
+void FGridComponents::GetStartComponents(int32 CellId, std::vector<int32>& OutLabels) const
+{
+	OutLabels.clear();
+	if (Labels[CellId] != INDEX_NONE)
+	{
+		OutLabels.push_back(Labels[CellId]);
+		return;
+	}
+
+	for (int32 Edge = Graph.GetFirstEdge(CellId); Edge < Graph.GetEndEdge(CellId); ++Edge)
+	{
+		const int32 NeighbourId = Graph.GetEdgeTarget(Edge);
+		const int32 Label = Labels[NeighbourId];
+		if (Label != INDEX_NONE && Graph.IsMoveAllowed(CellId, NeighbourId) && std::find(OutLabels.begin(), OutLabels.end(), Label) == OutLabels.end())
+		{
+			OutLabels.push_back(Label);
+		}
+	}
+}
+
+int32 FGridComponents::AllocateLabel()
+{
+	if (!FreeLabels.empty())
+	{
+		const int32 Label = FreeLabels.back();
+		FreeLabels.pop_back();
+		return Label;
+	}
+	Sizes.push_back(0);
+	return int32(Sizes.size()) - 1;
+}
+
+void FGridComponents::FreeLabel(int32 Label)
+{
+	Sizes[Label] = 0;
+	FreeLabels.push_back(Label);
+}
+
+int32 FGridComponents::Relabel(int32 SeedId, int32 OldLabel, int32 NewLabel)
+{
+	int32 NumRelabelled = 0;
+	std::vector<int32> Queue(1, SeedId);
+	while (!Queue.empty())
+	{
+		const int32 CurrentId = Queue.back();
+		Queue.pop_back();
+		for (int32 Edge = Graph.GetFirstEdge(CurrentId); Edge < Graph.GetEndEdge(CurrentId); ++Edge)
+		{
+			const int32 NeighbourId = Graph.GetEdgeTarget(Edge);
+			if (Labels[NeighbourId] == OldLabel && Graph.IsWalkable(NeighbourId) && Graph.IsMoveAllowed(CurrentId, NeighbourId))
+			{
+				Labels[NeighbourId] = NewLabel;
+				Queue.push_back(NeighbourId);
+				++NumRelabelled;
+			}
+		}
+	}
+	return NumRelabelled;
+}
+
+void FGridComponents::SplitComponent(int32 Label, const std::vector<int32>& Seeds)
+{
+	if (VisitStamps.size() != Labels.size())
+	{
+		VisitStamps.assign(Labels.size(), 0);
+		VisitOwners.assign(Labels.size(), INDEX_NONE);
+	}
+	if (++VisitStamp == 0)
+	{
+		std::fill(VisitStamps.begin(), VisitStamps.end(), 0);
+		VisitStamp = 1;
+	}
+
+	// One breadth-first search per seed, run in lockstep. Searches that meet belong to the same part,
+	// a part whose searches all run dry is cut off. Once a single part is left it keeps the old label.
+	const int32 NumSeeds = int32(Seeds.size());
+	std::vector<std::vector<int32>> Visited(NumSeeds);
+	std::vector<int32> Heads(NumSeeds, 0);
+	std::vector<int32> Parts(NumSeeds);
+	std::vector<bool> PartsDone(NumSeeds, false);
+	std::iota(Parts.begin(), Parts.end(), 0);
+	for (int32 Seed = 0; Seed < NumSeeds; ++Seed)
+	{
+		VisitStamps[Seeds[Seed]] = VisitStamp;
+		VisitOwners[Seeds[Seed]] = Seed;
+		Visited[Seed].push_back(Seeds[Seed]);
+	}
+
+	auto FindPart = [&Parts](int32 Seed)
+	{
+		while (Parts[Seed] != Seed)
+		{
+			Seed = Parts[Seed] = Parts[Parts[Seed]];
+		}
+		return Seed;
+	};
+
+	int32 NumParts = NumSeeds;
+	while (NumParts > 1)
+	{
+		for (int32 Seed = 0; Seed < NumSeeds && NumParts > 1; ++Seed)
+		{
+			if (Heads[Seed] == int32(Visited[Seed].size()))
+			{
+				continue;
+			}
+
+			const int32 CurrentId = Visited[Seed][Heads[Seed]++];
+			for (int32 Edge = Graph.GetFirstEdge(CurrentId); Edge < Graph.GetEndEdge(CurrentId) && NumParts > 1; ++Edge)
+			{
+				const int32 NeighbourId = Graph.GetEdgeTarget(Edge);
+				if (Labels[NeighbourId] != Label || !Graph.IsMoveAllowed(CurrentId, NeighbourId))
+				{
+					continue;
+				}
+
+				if (VisitStamps[NeighbourId] != VisitStamp)
+				{
+					VisitStamps[NeighbourId] = VisitStamp;
+					VisitOwners[NeighbourId] = Seed;
+					Visited[Seed].push_back(NeighbourId);
+					continue;
+				}
+
+				const int32 Part = FindPart(Seed);
+				const int32 OtherPart = FindPart(VisitOwners[NeighbourId]);
+				if (Part != OtherPart)
+				{
+					Parts[OtherPart] = Part;
+					--NumParts;
+				}
+			}
+		}
+
+		// A part is cut off once none of its searches has anything left to expand
+		for (int32 Part = 0; Part < NumSeeds && NumParts > 1; ++Part)
+		{
+			if (FindPart(Part) != Part || PartsDone[Part])
+			{
+				continue;
+			}
+
+			bool bExhausted = true;
+			for (int32 Seed = 0; Seed < NumSeeds && bExhausted; ++Seed)
+			{
+				bExhausted = FindPart(Seed) != Part || Heads[Seed] == int32(Visited[Seed].size());
+			}
+			if (!bExhausted)
+			{
+				continue;
+			}
+
+			const int32 NewLabel = AllocateLabel();
+			for (int32 Seed = 0; Seed < NumSeeds; ++Seed)
+			{
+				if (FindPart(Seed) == Part)
+				{
+					for (int32 CellId : Visited[Seed])
+					{
+						Labels[CellId] = NewLabel;
+					}
+					Sizes[NewLabel] += int32(Visited[Seed].size());
+				}
+			}
+			Sizes[Label] -= Sizes[NewLabel];
+			PartsDone[Part] = true;
+			--NumParts;
+		}
+	}
+}
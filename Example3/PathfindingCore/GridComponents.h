@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <shared_mutex>
+#include <vector>
+
+class FGridGraph;
+
+/**
+ * Connected components of the walkable cells of an FGridGraph, under the same moves the searches make.
+ * Lets queries between cells that can never reach each other fail before they flood everything reachable.
+ * Labels follow walkability changes incrementally: opening a cell merges the components around it into
+ * the largest one, blocking a cell searches outwards from its neighbours in lockstep and relabels only
+ * the parts that got cut off, so the work is bounded by the smaller side of a split.
+ * Safe to query from several threads while the owner of the graph reports changes.
+ */
+class INVADED_API FGridComponents
+{
+public:
+	explicit FGridComponents(FGridGraph& InGraph);
+
+	/** Labels every walkable cell from scratch */
+	void Build();
+
+	/** Takes labels computed earlier for the same walkability, a grid file's for one, instead of flooding the grid */
+	void Build(const int32* InLabels);
+
+	/** Updates the labels after the walkability of the cell changed in the graph, does nothing when it didn't */
+	void OnWalkabilityChanged(int32 CellId);
+
+	/** Component of a walkable cell, INDEX_NONE for blocked cells */
+	int32 GetComponent(int32 CellId) const;
+
+	/**
+	 * True when a search from StartId can reach TargetId. Searches may leave a blocked start cell,
+	 * so a blocked start is connected to whatever its walkable neighbours are connected to.
+	 */
+	bool AreConnected(int32 StartId, int32 TargetId) const;
+
+	/**
+	 * TargetId when a search from StartId reaches it, otherwise the reachable cell closest to it in
+	 * straight-line distance. INDEX_NONE when StartId can't be left at all.
+	 */
+	int32 FindNearestReachableCell(int32 StartId, int32 TargetId) const;
+
+	int32 GetNumComponents() const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/** Labels of the components a search from the cell can enter, at most one per edge */
+	void GetStartComponents(int32 CellId, std::vector<int32>& OutLabels) const;
+
+	int32 AllocateLabel();
+	void FreeLabel(int32 Label);
+
+	/** Gives every cell connected to SeedId that carries OldLabel the label NewLabel, returns how many there were */
+	int32 Relabel(int32 SeedId, int32 OldLabel, int32 NewLabel);
+
+	/** Finds the parts Label fell apart into after a cell between the seeds got blocked */
+	void SplitComponent(int32 Label, const std::vector<int32>& Seeds);
+
+	FGridGraph& Graph;
+
+	mutable std::shared_mutex Lock;
+
+	std::vector<int32> Labels;
+
+	/** Cells per label, zero for labels on the free list */
+	std::vector<int32> Sizes;
+	std::vector<int32> FreeLabels;
+
+	/** Which split search reached a cell first, valid where VisitStamps holds the current stamp */
+	std::vector<uint32> VisitStamps;
+	std::vector<int32> VisitOwners;
+	uint32 VisitStamp;
+};
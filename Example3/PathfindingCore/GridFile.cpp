@@ -0,0 +1,316 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GridFile.h"
+#include "GridComponents.h"
+#include "GridGraph.h"
+#include "LandmarkHeuristic.h"
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+	uint64 AlignOffset(uint64 Offset)
+	{
+		return (Offset + FGridFile::Alignment - 1) / FGridFile::Alignment * FGridFile::Alignment;
+	}
+}
+
+bool FGridFile::Write(const std::string& Filename, const FGridGraph& Graph, uint64 SourceHash, const FGridComponents* Components, const FLandmarkTable* Landmarks)
+{
+	std::vector<uint32> WalkableBits((Graph.Num() + 31) / 32, 0);
+	std::vector<int32> EdgeOffsets(Graph.Num() + 1);
+	std::vector<int32> EdgeTargets;
+	std::vector<int32> EdgeCosts;
+	std::vector<int8> EdgeDeltas;
+	const FEdgeCostSnapshot GraphEdgeCosts = Graph.GetEdgeCosts();
+	for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+	{
+		if (Graph.IsWalkable(CellId))
+		{
+			WalkableBits[CellId >> 5] |= 1u << (CellId & 31);
+		}
+		EdgeOffsets[CellId] = Graph.GetFirstEdge(CellId);
+		for (int32 Edge = Graph.GetFirstEdge(CellId); Edge < Graph.GetEndEdge(CellId); ++Edge)
+		{
+			const FGridCoord Delta = Graph.GetEdgeDelta(Edge);
+			EdgeTargets.push_back(Graph.GetEdgeTarget(Edge));
+			EdgeCosts.push_back(GraphEdgeCosts[Edge]);
+			EdgeDeltas.push_back(int8(Delta.X));
+			EdgeDeltas.push_back(int8(Delta.Y));
+		}
+	}
+	EdgeOffsets[Graph.Num()] = int32(EdgeTargets.size());
+
+	std::vector<int32> ComponentLabels;
+	if (Components)
+	{
+		ComponentLabels.resize(Graph.Num());
+		for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+		{
+			ComponentLabels[CellId] = Components->GetComponent(CellId);
+		}
+	}
+
+	std::vector<int32> LandmarkCells;
+	const int32* LandmarkDistances = nullptr;
+	if (Landmarks && Landmarks->GetNumLandmarks() > 0)
+	{
+		for (int32 Index = 0; Index < Landmarks->GetNumLandmarks(); ++Index)
+		{
+			LandmarkCells.push_back(Landmarks->GetLandmark(Index));
+		}
+		LandmarkDistances = Landmarks->GetDistances(0);
+	}
+
+	FHeader Header = {};
+	Header.Magic = Magic;
+	Header.Version = Version;
+	Header.Width = Graph.GetWidth();
+	Header.Height = Graph.GetHeight();
+	Header.StraightCost = Graph.GetStraightCost();
+	Header.DiagonalCost = Graph.GetDiagonalCost();
+	Header.NumEdges = int32(EdgeTargets.size());
+	Header.MaxEdges = Graph.GetMaxEdges();
+	Header.NumLandmarks = int32(LandmarkCells.size());
+	Header.LandmarkStride = LandmarkDistances ? Landmarks->GetStride() : 0;
+	Header.bUniformCosts = Graph.HasUniformCosts() ? 1 : 0;
+	Header.bHasComponents = Components ? 1 : 0;
+	Header.SourceHash = SourceHash;
+	Header.LandmarkGraphHash = LandmarkDistances ? FLandmarkTable::GetGraphHash(Graph) : 0;
+
+	const void* Sections[NumSections] = { WalkableBits.data(), EdgeOffsets.data(), EdgeTargets.data(), EdgeCosts.data(), EdgeDeltas.data(), ComponentLabels.data(), LandmarkCells.data(), LandmarkDistances };
+	Header.SectionSizes[WalkableBitsSection] = WalkableBits.size() * sizeof(uint32);
+	Header.SectionSizes[EdgeOffsetsSection] = EdgeOffsets.size() * sizeof(int32);
+	Header.SectionSizes[EdgeTargetsSection] = EdgeTargets.size() * sizeof(int32);
+	Header.SectionSizes[EdgeCostsSection] = EdgeCosts.size() * sizeof(int32);
+	Header.SectionSizes[EdgeDeltasSection] = EdgeDeltas.size() * sizeof(int8);
+	Header.SectionSizes[ComponentLabelsSection] = ComponentLabels.size() * sizeof(int32);
+	Header.SectionSizes[LandmarksSection] = LandmarkCells.size() * sizeof(int32);
+	Header.SectionSizes[LandmarkDistancesSection] = LandmarkDistances ? uint64(Graph.Num()) * Header.LandmarkStride * sizeof(int32) : 0;
+
+	uint64 Offset = AlignOffset(sizeof(FHeader));
+	for (int32 Section = 0; Section < NumSections; ++Section)
+	{
+		Header.SectionOffsets[Section] = Offset;
+		Offset = AlignOffset(Offset + Header.SectionSizes[Section]);
+	}
+
+	std::ofstream File(Filename, std::ios::binary | std::ios::trunc);
+	if (!File)
+	{
+		return false;
+	}
+
+	const char Padding[Alignment] = {};
+	File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+	uint64 Written = sizeof(Header);
+	for (int32 Section = 0; Section < NumSections; ++Section)
+	{
+		File.write(Padding, std::streamsize(Header.SectionOffsets[Section] - Written));
+		File.write(static_cast<const char*>(Sections[Section]), std::streamsize(Header.SectionSizes[Section]));
+		Written = Header.SectionOffsets[Section] + Header.SectionSizes[Section];
+	}
+	return bool(File);
+}
+
+FGridFile::FGridFile()
+{
+	Data = nullptr;
+	Header = nullptr;
+}
+
+bool FGridFile::Open(const void* InData, SIZE_T Size)
+{
+	Data = nullptr;
+	Header = nullptr;
+
+	const FHeader* NewHeader = static_cast<const FHeader*>(InData);
+	if (!InData || reinterpret_cast<uintptr_t>(InData) % Alignment != 0 || Size < sizeof(FHeader)
+		|| NewHeader->Magic != Magic || NewHeader->Version != Version
+		|| NewHeader->Width < 0 || NewHeader->Height < 0 || NewHeader->NumEdges < 0
+		|| NewHeader->NumLandmarks < 0 || NewHeader->NumLandmarks > FLandmarkTable::MaxLandmarks
+		|| NewHeader->LandmarkStride < NewHeader->NumLandmarks || NewHeader->LandmarkStride > FLandmarkTable::MaxLandmarks || NewHeader->LandmarkStride % 4 != 0)
+	{
+		return false;
+	}
+
+	// Cell ids are int32 throughout the graph
+	const uint64 NumCells = uint64(NewHeader->Width) * NewHeader->Height;
+	if (NumCells > uint64(MAX_int32))
+	{
+		return false;
+	}
+
+	// Each section has to hold exactly the array the graph expects and lie within the file
+	const uint64 ExpectedSizes[NumSections] =
+	{
+		(NumCells + 31) / 32 * sizeof(uint32),
+		(NumCells + 1) * sizeof(int32),
+		uint64(NewHeader->NumEdges) * sizeof(int32),
+		uint64(NewHeader->NumEdges) * sizeof(int32),
+		uint64(NewHeader->NumEdges) * 2 * sizeof(int8),
+		NewHeader->bHasComponents ? NumCells * sizeof(int32) : 0,
+		uint64(NewHeader->NumLandmarks) * sizeof(int32),
+		NewHeader->NumLandmarks > 0 ? NumCells * NewHeader->LandmarkStride * sizeof(int32) : 0,
+	};
+	for (int32 Section = 0; Section < NumSections; ++Section)
+	{
+		if (NewHeader->SectionSizes[Section] != ExpectedSizes[Section] || NewHeader->SectionOffsets[Section] % Alignment != 0
+			|| NewHeader->SectionOffsets[Section] > Size || NewHeader->SectionSizes[Section] > Size - NewHeader->SectionOffsets[Section])
+		{
+			return false;
+		}
+	}
+
+	Data = static_cast<const uint8*>(InData);
+	Header = NewHeader;
+	if (!HasValidIndices())
+	{
+		Data = nullptr;
+		Header = nullptr;
+		return false;
+	}
+	return true;
+}
+
+bool FGridFile::HasValidIndices() const
+{
+	// Searches index by these without checking, so a file that lies about them must not open
+	const int32 NumCells = Num();
+	const int32* EdgeOffsets = GetEdgeOffsets();
+	const int32* EdgeTargets = GetEdgeTargets();
+	if (EdgeOffsets[0] != 0 || EdgeOffsets[NumCells] != Header->NumEdges)
+	{
+		return false;
+	}
+	for (int32 CellId = 0; CellId < NumCells; ++CellId)
+	{
+		if (EdgeOffsets[CellId + 1] < EdgeOffsets[CellId] || EdgeOffsets[CellId + 1] - EdgeOffsets[CellId] > Header->MaxEdges)
+		{
+			return false;
+		}
+	}
+	for (int32 Edge = 0; Edge < Header->NumEdges; ++Edge)
+	{
+		if (EdgeTargets[Edge] < 0 || EdgeTargets[Edge] >= NumCells)
+		{
+			return false;
+		}
+	}
+
+	if (const int32* ComponentLabels = GetComponentLabels())
+	{
+		for (int32 CellId = 0; CellId < NumCells; ++CellId)
+		{
+			if (ComponentLabels[CellId] < INDEX_NONE || ComponentLabels[CellId] >= NumCells)
+			{
+				return false;
+			}
+		}
+	}
+	const int32* Landmarks = GetLandmarks();
+	for (int32 Index = 0; Index < Header->NumLandmarks; ++Index)
+	{
+		if (Landmarks[Index] < 0 || Landmarks[Index] >= NumCells)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int32 FGridFile::GetWidth() const
+{
+	return Header->Width;
+}
+
+int32 FGridFile::GetHeight() const
+{
+	return Header->Height;
+}
+
+int32 FGridFile::GetStraightCost() const
+{
+	return Header->StraightCost;
+}
+
+int32 FGridFile::GetDiagonalCost() const
+{
+	return Header->DiagonalCost;
+}
+
+int32 FGridFile::GetNumEdges() const
+{
+	return Header->NumEdges;
+}
+
+int32 FGridFile::GetMaxEdges() const
+{
+	return Header->MaxEdges;
+}
+
+bool FGridFile::HasUniformCosts() const
+{
+	return Header->bUniformCosts != 0;
+}
+
+uint64 FGridFile::GetSourceHash() const
+{
+	return Header->SourceHash;
+}
+
+const uint32* FGridFile::GetWalkableBits() const
+{
+	return GetSection<uint32>(WalkableBitsSection);
+}
+
+const int32* FGridFile::GetEdgeOffsets() const
+{
+	return GetSection<int32>(EdgeOffsetsSection);
+}
+
+const int32* FGridFile::GetEdgeTargets() const
+{
+	return GetSection<int32>(EdgeTargetsSection);
+}
+
+const int32* FGridFile::GetEdgeCosts() const
+{
+	return GetSection<int32>(EdgeCostsSection);
+}
+
+const int8* FGridFile::GetEdgeDeltas() const
+{
+	return GetSection<int8>(EdgeDeltasSection);
+}
+
+const int32* FGridFile::GetComponentLabels() const
+{
+	return GetSection<int32>(ComponentLabelsSection);
+}
+
+int32 FGridFile::GetNumLandmarks() const
+{
+	return Header->NumLandmarks;
+}
+
+int32 FGridFile::GetLandmarkStride() const
+{
+	return Header->LandmarkStride;
+}
+
+const int32* FGridFile::GetLandmarks() const
+{
+	return GetSection<int32>(LandmarksSection);
+}
+
+const int32* FGridFile::GetLandmarkDistances() const
+{
+	return GetSection<int32>(LandmarkDistancesSection);
+}
+
+uint64 FGridFile::GetLandmarkGraphHash() const
+{
+	return Header->LandmarkGraphHash;
+}
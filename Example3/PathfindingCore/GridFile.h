@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <string>
+
+class FGridComponents;
+class FGridGraph;
+class FLandmarkTable;
+
+/**
+ * Versioned binary image of an FGridGraph and the data precomputed over it: walkability, the CSR adjacency with its
+ * step costs, component labels and landmark distances. Every section starts on an Alignment boundary and holds the
+ * arrays exactly as the graph keeps them in memory, so a mapped file is searched in place, see FGridGraph::Attach
+ * and FLandmarkTable::Attach. Written and read on little-endian targets only.
+ */
+class INVADED_API FGridFile
+{
+public:
+	static constexpr uint32 Magic = 0x52474650; // "PFGR"
+	static constexpr uint32 Version = 1;
+
+	/** Sections start at multiples of this, mapped files are page aligned so their arrays can be read where they are */
+	static constexpr uint32 Alignment = 16;
+
+	/**
+	 * Writes the graph and optionally its components and a landmark table built for it. SourceHash identifies
+	 * whatever the graph was built from, so whoever opens the file can tell whether it still describes the level.
+	 */
+	static bool Write(const std::string& Filename, const FGridGraph& Graph, uint64 SourceHash, const FGridComponents* Components = nullptr, const FLandmarkTable* Landmarks = nullptr);
+
+	FGridFile();
+
+	/**
+	 * Checks the header, that every section lies within Size bytes and that every offset, edge target and label
+	 * indexes within the graph, nothing is copied or parsed. Data has to be Alignment aligned and stay valid for
+	 * as long as a graph or table attached to this file is used.
+	 */
+	bool Open(const void* Data, SIZE_T Size);
+
+	bool IsOpen() const { return Header != nullptr; }
+
+	int32 GetWidth() const;
+	int32 GetHeight() const;
+	int32 Num() const { return GetWidth() * GetHeight(); }
+	int32 GetStraightCost() const;
+	int32 GetDiagonalCost() const;
+	int32 GetNumEdges() const;
+	int32 GetMaxEdges() const;
+	bool HasUniformCosts() const;
+	uint64 GetSourceHash() const;
+
+	/** One bit per cell id, in the layout of FGridGraph */
+	const uint32* GetWalkableBits() const;
+
+	const int32* GetEdgeOffsets() const;
+	const int32* GetEdgeTargets() const;
+	const int32* GetEdgeCosts() const;
+	const int8* GetEdgeDeltas() const;
+
+	/** Component label per cell id, nullptr when the file was written without components */
+	const int32* GetComponentLabels() const;
+
+	/** Zero when the file was written without landmarks */
+	int32 GetNumLandmarks() const;
+	int32 GetLandmarkStride() const;
+	const int32* GetLandmarks() const;
+	const int32* GetLandmarkDistances() const;
+
+	/** FLandmarkTable::GetGraphHash of the graph the landmarks were built for */
+	uint64 GetLandmarkGraphHash() const;
+
+private:
+	enum ESection
+	{
+		WalkableBitsSection,
+		EdgeOffsetsSection,
+		EdgeTargetsSection,
+		EdgeCostsSection,
+		EdgeDeltasSection,
+		ComponentLabelsSection,
+		LandmarksSection,
+		LandmarkDistancesSection,
+		NumSections,
+	};
+
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		int32 Width;
+		int32 Height;
+		int32 StraightCost;
+		int32 DiagonalCost;
+		int32 NumEdges;
+		int32 MaxEdges;
+		int32 NumLandmarks;
+		int32 LandmarkStride;
+		uint32 bUniformCosts;
+		uint32 bHasComponents;
+		uint64 SourceHash;
+		uint64 LandmarkGraphHash;
+
+		/** Byte offset and size of every section, from the start of the file */
+		uint64 SectionOffsets[NumSections];
+		uint64 SectionSizes[NumSections];
+	};
+
+	/** One pass over the integer arrays: offsets in order, no cell with more than MaxEdges edges, every id a cell */
+	bool HasValidIndices() const;
+
+	template <typename ElementType>
+	const ElementType* GetSection(ESection Section) const
+	{
+		return Header->SectionSizes[Section] > 0 ? reinterpret_cast<const ElementType*>(Data + Header->SectionOffsets[Section]) : nullptr;
+	}
+
+	const uint8* Data;
+	const FHeader* Header;
+};
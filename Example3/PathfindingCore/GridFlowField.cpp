@@ -0,0 +1,292 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GridFlowField.h"
+#include "GridGraph.h"
+#include <algorithm>
+
+namespace
+{
+	// Odd directions are diagonal
+	const FGridCoord DirectionOffsets[8] =
+	{
+		FGridCoord(1, 0), FGridCoord(1, 1), FGridCoord(0, 1), FGridCoord(-1, 1),
+		FGridCoord(-1, 0), FGridCoord(-1, -1), FGridCoord(0, -1), FGridCoord(1, -1)
+	};
+
+	int32 GetStepCost(int32 Direction)
+	{
+		return (Direction & 1) ? FGridFlowField::DiagonalCost : FGridFlowField::StraightCost;
+	}
+}
+
+FGridFlowField::FGridFlowField(const FGridGraph& InGraph, int32 InTargetId)
+	: Graph(InGraph)
+	, TargetId(InTargetId)
+{
+}
+
+void FGridFlowField::Build()
+{
+	std::vector<int32>().swap(WideDistances);
+	Distances.assign(Graph.Num(), NarrowUnreachable);
+	Directions.assign(Graph.Num(), NoDirection);
+
+	if (!Graph.IsWalkable(TargetId))
+	{
+		return;
+	}
+
+	std::vector<FOpenEntry> Open;
+	std::vector<int32> Changed;
+	SetDistance(TargetId, 0);
+	Open.push_back(FOpenEntry(0, TargetId));
+	Propagate(Open, Changed);
+
+	for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+	{
+		UpdateDirection(CellId);
+	}
+}
+
+void FGridFlowField::NotifyCellsChanged(const std::vector<int32>& ChangedCells)
+{
+	std::vector<int32> Changed;
+	for (int32 CellId : ChangedCells)
+	{
+		if (Graph.IsWalkable(CellId))
+		{
+			OnCellOpened(CellId, Changed);
+		}
+		else
+		{
+			OnCellBlocked(CellId, Changed);
+		}
+		Changed.push_back(CellId);
+	}
+
+	// A cell picks its direction from its neighbours, so those of every changed cell are refreshed too
+	std::vector<bool> Refreshed(Graph.Num(), false);
+	for (int32 CellId : Changed)
+	{
+		for (int32 Direction = -1; Direction < 8; ++Direction)
+		{
+			const int32 RefreshId = Direction < 0 ? CellId : GetNeighbourId(CellId, Direction);
+			if (RefreshId != INDEX_NONE && !Refreshed[RefreshId])
+			{
+				Refreshed[RefreshId] = true;
+				UpdateDirection(RefreshId);
+			}
+		}
+	}
+}
+
+int32 FGridFlowField::GetNextCell(int32 CellId) const
+{
+	const uint8 Direction = Directions[CellId];
+	return Direction == NoDirection ? INDEX_NONE : GetNeighbourId(CellId, Direction);
+}
+
+SIZE_T FGridFlowField::GetAllocatedSize() const
+{
+	return Distances.capacity() * sizeof(uint16) + WideDistances.capacity() * sizeof(int32) + Directions.capacity() * sizeof(uint8);
+}
+
+void FGridFlowField::SetDistance(int32 CellId, int32 Distance)
+{
+	if (WideDistances.empty() && Distance >= NarrowUnreachable && Distance != Unreachable)
+	{
+		WideDistances.resize(Distances.size());
+		for (size_t Index = 0; Index < Distances.size(); ++Index)
+		{
+			WideDistances[Index] = Distances[Index] == NarrowUnreachable ? Unreachable : Distances[Index];
+		}
+		std::vector<uint16>().swap(Distances);
+	}
+
+	if (!WideDistances.empty())
+	{
+		WideDistances[CellId] = Distance;
+	}
+	else
+	{
+		Distances[CellId] = Distance == Unreachable ? NarrowUnreachable : uint16(Distance);
+	}
+}
+
+int32 FGridFlowField::GetNeighbourId(int32 CellId, int32 Direction) const
+{
+	const FGridCoord Coord = Graph.GetCoord(CellId) + DirectionOffsets[Direction];
+	return Graph.IsValidCoord(Coord.X, Coord.Y) ? Graph.GetCellId(Coord.X, Coord.Y) : INDEX_NONE;
+}
+
+int32 FGridFlowField::Step(int32 CellId, int32 Direction) const
+{
+	const int32 NeighbourId = GetNeighbourId(CellId, Direction);
+	if (NeighbourId == INDEX_NONE || !Graph.IsWalkable(NeighbourId) || !Graph.IsMoveAllowed(CellId, NeighbourId))
+	{
+		return INDEX_NONE;
+	}
+	return NeighbourId;
+}
+
+void FGridFlowField::Propagate(std::vector<FOpenEntry>& Open, std::vector<int32>& OutChanged)
+{
+	// Min-heap through std::push_heap / std::pop_heap with the comparison flipped
+	std::make_heap(Open.begin(), Open.end(), FOpenEntry::Greater);
+	while (!Open.empty())
+	{
+		std::pop_heap(Open.begin(), Open.end(), FOpenEntry::Greater);
+		const FOpenEntry Current = Open.back();
+		Open.pop_back();
+
+		// Stale entry, the cell was lowered again after being queued
+		if (Current.Distance > GetDistance(Current.CellId))
+		{
+			continue;
+		}
+
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			const int32 NeighbourId = Step(Current.CellId, Direction);
+			if (NeighbourId == INDEX_NONE)
+			{
+				continue;
+			}
+
+			const int32 Distance = Current.Distance + GetStepCost(Direction);
+			if (Distance < GetDistance(NeighbourId))
+			{
+				SetDistance(NeighbourId, Distance);
+				Directions[NeighbourId] = uint8((Direction + 4) % 8);
+				Open.push_back(FOpenEntry(Distance, NeighbourId));
+				std::push_heap(Open.begin(), Open.end(), FOpenEntry::Greater);
+				OutChanged.push_back(NeighbourId);
+			}
+		}
+	}
+}
+
+void FGridFlowField::UpdateDirection(int32 CellId)
+{
+	Directions[CellId] = NoDirection;
+	if (CellId == TargetId || GetDistance(CellId) == Unreachable)
+	{
+		return;
+	}
+
+	int32 BestDistance = MAX_int32;
+	for (int32 Direction = 0; Direction < 8; ++Direction)
+	{
+		const int32 NeighbourId = Step(CellId, Direction);
+		if (NeighbourId != INDEX_NONE && GetDistance(NeighbourId) != Unreachable && GetDistance(NeighbourId) + GetStepCost(Direction) < BestDistance)
+		{
+			BestDistance = GetDistance(NeighbourId) + GetStepCost(Direction);
+			Directions[CellId] = uint8(Direction);
+		}
+	}
+}
+
+void FGridFlowField::OnCellBlocked(int32 CellId, std::vector<int32>& OutChanged)
+{
+	if (CellId == TargetId)
+	{
+		Build();
+		return;
+	}
+
+	// Seed with the cell itself and the neighbours whose distance no longer follows from their direction,
+	// either because their diagonal now cuts its corner or because an earlier change left them pointing elsewhere
+	std::vector<bool> InRegion(Graph.Num(), false);
+	std::vector<int32> Region;
+	Region.push_back(CellId);
+	InRegion[CellId] = true;
+	for (int32 Direction = 0; Direction < 8; ++Direction)
+	{
+		const int32 NeighbourId = GetNeighbourId(CellId, Direction);
+		if (NeighbourId == INDEX_NONE || NeighbourId == TargetId || GetDistance(NeighbourId) == Unreachable)
+		{
+			continue;
+		}
+
+		const uint8 NeighbourDirection = Directions[NeighbourId];
+		const int32 NextId = NeighbourDirection != NoDirection ? Step(NeighbourId, NeighbourDirection) : INDEX_NONE;
+		if (NextId == INDEX_NONE || GetDistance(NextId) == Unreachable || GetDistance(NextId) + GetStepCost(NeighbourDirection) != GetDistance(NeighbourId))
+		{
+			Region.push_back(NeighbourId);
+			InRegion[NeighbourId] = true;
+		}
+	}
+
+	// Every cell whose flow runs through the seeds lost its distance as well
+	for (size_t i = 0; i < Region.size(); ++i)
+	{
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			const int32 UpstreamId = GetNeighbourId(Region[i], Direction);
+			if (UpstreamId != INDEX_NONE && !InRegion[UpstreamId] && Directions[UpstreamId] != NoDirection
+				&& GetNeighbourId(UpstreamId, Directions[UpstreamId]) == Region[i])
+			{
+				Region.push_back(UpstreamId);
+				InRegion[UpstreamId] = true;
+			}
+		}
+	}
+
+	for (int32 RegionId : Region)
+	{
+		SetDistance(RegionId, Unreachable);
+		Directions[RegionId] = NoDirection;
+		OutChanged.push_back(RegionId);
+	}
+
+	// Refill the region from the distances still valid around it
+	std::vector<FOpenEntry> Open;
+	for (int32 RegionId : Region)
+	{
+		if (!Graph.IsWalkable(RegionId))
+		{
+			continue;
+		}
+
+		int32 Distance = Unreachable;
+		for (int32 Direction = 0; Direction < 8; ++Direction)
+		{
+			const int32 NeighbourId = Step(RegionId, Direction);
+			if (NeighbourId != INDEX_NONE && !InRegion[NeighbourId] && GetDistance(NeighbourId) != Unreachable && GetDistance(NeighbourId) + GetStepCost(Direction) < Distance)
+			{
+				Distance = GetDistance(NeighbourId) + GetStepCost(Direction);
+				Directions[RegionId] = uint8(Direction);
+			}
+		}
+		if (Distance != Unreachable)
+		{
+			SetDistance(RegionId, Distance);
+			Open.push_back(FOpenEntry(Distance, RegionId));
+		}
+		else
+		{
+			Directions[RegionId] = NoDirection;
+		}
+	}
+	Propagate(Open, OutChanged);
+}
+
+void FGridFlowField::OnCellOpened(int32 CellId, std::vector<int32>& OutChanged)
+{
+	std::vector<FOpenEntry> Open;
+	if (CellId == TargetId)
+	{
+		SetDistance(CellId, 0);
+	}
+
+	// The cell and the diagonals it no longer blocks can only shorten routes, lowering distances is enough
+	for (int32 Direction = -1; Direction < 8; ++Direction)
+	{
+		const int32 SourceId = Direction < 0 ? CellId : Step(CellId, Direction);
+		if (SourceId != INDEX_NONE && GetDistance(SourceId) != Unreachable)
+		{
+			Open.push_back(FOpenEntry(GetDistance(SourceId), SourceId));
+		}
+	}
+	Propagate(Open, OutChanged);
+}
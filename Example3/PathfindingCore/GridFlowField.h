@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <vector>
+
+class FGridGraph;
+
+/**
+ * Flow field towards one target cell of an FGridGraph.
+ * A Dijkstra pass from the target fills an integration field of distances and a uint8 direction
+ * per cell pointing at the next cell downhill, so an agent just follows the direction of the cell
+ * it stands on. Distances use 2 per straight and 3 per diagonal step and are kept in 16 bits;
+ * a field whose farthest cell lies beyond that switches to 32 bit distances instead of losing it.
+ */
+class INVADED_API FGridFlowField
+{
+public:
+	static constexpr int32 Unreachable = MAX_int32;
+	static constexpr uint8 NoDirection = MAX_uint8;
+
+	static constexpr int32 StraightCost = 2;
+	static constexpr int32 DiagonalCost = 3;
+
+	FGridFlowField(const FGridGraph& InGraph, int32 InTargetId);
+
+	/** Computes both fields from scratch */
+	void Build();
+
+	/** Patches the fields around cells whose walkability changed, only cells whose distance depends on them are recomputed */
+	void NotifyCellsChanged(const std::vector<int32>& ChangedCells);
+
+	int32 GetTargetId() const { return TargetId; }
+
+	/** Steps to the target in field units, Unreachable where it can't be reached */
+	int32 GetDistance(int32 CellId) const
+	{
+		if (!WideDistances.empty())
+		{
+			return WideDistances[CellId];
+		}
+		return Distances[CellId] == NarrowUnreachable ? Unreachable : Distances[CellId];
+	}
+
+	uint8 GetDirection(int32 CellId) const { return Directions[CellId]; }
+
+	/** Cell to step to from CellId, INDEX_NONE at the target or where the target can't be reached */
+	int32 GetNextCell(int32 CellId) const;
+
+	/** True once some distance outgrew 16 bits */
+	bool HasWideDistances() const { return !WideDistances.empty(); }
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/** Marks unreachable cells while the distances are 16 bits, any distance below it fits */
+	static constexpr uint16 NarrowUnreachable = MAX_uint16;
+
+	struct FOpenEntry
+	{
+		int32 Distance;
+		int32 CellId;
+
+		FOpenEntry(int32 InDistance, int32 InCellId) : Distance(InDistance), CellId(InCellId) {}
+
+		static bool Greater(const FOpenEntry& A, const FOpenEntry& B) { return A.Distance > B.Distance; }
+	};
+
+	/** Stores the distance, moving every distance to 32 bits first when it doesn't fit 16 */
+	void SetDistance(int32 CellId, int32 Distance);
+
+	/** Cell one step from CellId in the given direction, INDEX_NONE off the grid */
+	int32 GetNeighbourId(int32 CellId, int32 Direction) const;
+
+	/** Cell one step from CellId in the given direction, INDEX_NONE when the step is blocked */
+	int32 Step(int32 CellId, int32 Direction) const;
+
+	/** Lowers distances from the queued cells outwards, appending every lowered cell to OutChanged */
+	void Propagate(std::vector<FOpenEntry>& Open, std::vector<int32>& OutChanged);
+
+	void UpdateDirection(int32 CellId);
+
+	void OnCellBlocked(int32 CellId, std::vector<int32>& OutChanged);
+	void OnCellOpened(int32 CellId, std::vector<int32>& OutChanged);
+
+	const FGridGraph& Graph;
+	int32 TargetId;
+
+	std::vector<uint16> Distances;
+
+	/** Takes over from Distances once a distance outgrows 16 bits, empty until then */
+	std::vector<int32> WideDistances;
+
+	std::vector<uint8> Directions;
+};
@@ -0,0 +1,253 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GridGraph.h"
+#include "AStarNodeTable.h"
+#include "GridFile.h"
+#include "PathHeuristics.h"
+#include <algorithm>
+#include <cstdlib>
+
+FGridGraph::FGridGraph()
+{
+	Width = 0;
+	Height = 0;
+	StraightCost = 1;
+	DiagonalCost = 1;
+	EdgeOffsets = nullptr;
+	EdgeTargets = nullptr;
+	EdgeDeltas = nullptr;
+	NumWalkableWords = 0;
+	NumEdges = 0;
+	MaxEdges = 0;
+	bUniformCosts = true;
+}
+
+FGridGraph::~FGridGraph()
+{
+	for (FAStarNodeTable* Table : FreeNodeTables)
+	{
+		delete Table;
+	}
+}
+
+void FGridGraph::BuildLattice(int32 InWidth, int32 InHeight, const std::vector<bool>& Walkable, int32 InStraightCost, int32 InDiagonalCost)
+{
+	check(int32(Walkable.size()) == InWidth * InHeight);
+
+	std::vector<int32> Offsets(InWidth * InHeight + 1, 0);
+	std::vector<int32> Targets;
+	Targets.reserve(InWidth * InHeight * 8);
+	for (int32 CellId = 0; CellId < InWidth * InHeight; ++CellId)
+	{
+		Offsets[CellId] = int32(Targets.size());
+
+		const int32 X = CellId % InWidth;
+		const int32 Y = CellId / InWidth;
+		for (int32 DY = -1; DY <= 1; ++DY)
+		{
+			for (int32 DX = -1; DX <= 1; ++DX)
+			{
+				if ((DX != 0 || DY != 0) && X + DX >= 0 && Y + DY >= 0 && X + DX < InWidth && Y + DY < InHeight)
+				{
+					Targets.push_back((Y + DY) * InWidth + X + DX);
+				}
+			}
+		}
+	}
+	Offsets[InWidth * InHeight] = int32(Targets.size());
+
+	BuildAdjacency(InWidth, InHeight, Offsets, Targets, InStraightCost, InDiagonalCost);
+	for (int32 CellId = 0; CellId < Num(); ++CellId)
+	{
+		SetWalkable(CellId, Walkable[CellId]);
+	}
+}
+
+void FGridGraph::BuildAdjacency(int32 InWidth, int32 InHeight, const std::vector<int32>& Offsets, const std::vector<int32>& Targets, int32 InStraightCost, int32 InDiagonalCost)
+{
+	check(int32(Offsets.size()) == InWidth * InHeight + 1);
+
+	Width = InWidth;
+	Height = InHeight;
+	StraightCost = InStraightCost;
+	DiagonalCost = InDiagonalCost;
+
+	EdgeOffsetStorage = Offsets;
+	EdgeTargetStorage = Targets;
+	std::shared_ptr<std::vector<int32>> CostStorage = std::make_shared<std::vector<int32>>(Targets.size());
+	EdgeDeltaStorage.resize(Targets.size() * 2);
+	EdgeOffsets = EdgeOffsetStorage.data();
+	EdgeTargets = EdgeTargetStorage.data();
+	EdgeDeltas = EdgeDeltaStorage.data();
+	NumEdges = int32(Targets.size());
+	MaxEdges = 0;
+	for (int32 CellId = 0; CellId < Num(); ++CellId)
+	{
+		const FGridCoord Coord = GetCoord(CellId);
+		for (int32 Edge = GetFirstEdge(CellId); Edge < GetEndEdge(CellId); ++Edge)
+		{
+			const FGridCoord Delta = GetCoord(EdgeTargets[Edge]) - Coord;
+			check(std::abs(Delta.X) <= MAX_int8 && std::abs(Delta.Y) <= MAX_int8);
+			(*CostStorage)[Edge] = Delta.X != 0 && Delta.Y != 0 ? DiagonalCost : StraightCost;
+			EdgeDeltaStorage[Edge * 2] = int8(Delta.X);
+			EdgeDeltaStorage[Edge * 2 + 1] = int8(Delta.Y);
+		}
+		MaxEdges = std::max(MaxEdges, GetEndEdge(CellId) - GetFirstEdge(CellId));
+	}
+
+	ResetWalkableBits();
+	bUniformCosts = true;
+
+	std::lock_guard<std::mutex> Lock(EdgeCostsLock);
+	EdgeCosts = std::shared_ptr<const int32>(CostStorage, CostStorage->data());
+	EdgeCostStorage = std::move(CostStorage);
+}
+
+void FGridGraph::Attach(const FGridFile& File)
+{
+	Width = File.GetWidth();
+	Height = File.GetHeight();
+	StraightCost = File.GetStraightCost();
+	DiagonalCost = File.GetDiagonalCost();
+
+	// Walkability changes at runtime, the bits are the one array the graph keeps a copy of
+	ResetWalkableBits();
+	for (int32 Word = 0; Word < NumWalkableWords; ++Word)
+	{
+		WalkableBits[Word].store(File.GetWalkableBits()[Word], std::memory_order_relaxed);
+	}
+
+	EdgeOffsets = File.GetEdgeOffsets();
+	EdgeTargets = File.GetEdgeTargets();
+	EdgeDeltas = File.GetEdgeDeltas();
+	NumEdges = File.GetNumEdges();
+	MaxEdges = File.GetMaxEdges();
+	bUniformCosts = File.HasUniformCosts();
+
+	std::vector<int32>().swap(EdgeOffsetStorage);
+	std::vector<int32>().swap(EdgeTargetStorage);
+	std::vector<int8>().swap(EdgeDeltaStorage);
+
+	// The file's costs are owned by whoever mapped it, snapshots only alias them
+	std::lock_guard<std::mutex> Lock(EdgeCostsLock);
+	EdgeCosts = std::shared_ptr<const int32>(std::shared_ptr<const int32>(), File.GetEdgeCosts());
+	EdgeCostStorage.reset();
+}
+
+void FGridGraph::SetCellCosts(const std::vector<uint8>& Costs)
+{
+	check(int32(Costs.size()) == Num());
+
+	// Searches hold a snapshot of the current array, an attached file's included, which outlives the swap below
+	std::shared_ptr<std::vector<int32>> CostStorage = std::make_shared<std::vector<int32>>(NumEdges);
+
+	bool bUniform = true;
+	for (int32 CellId = 0; CellId < Num(); ++CellId)
+	{
+		const int32 CellCost = std::max<int32>(Costs[CellId], 1);
+		for (int32 Edge = GetFirstEdge(CellId); Edge < GetEndEdge(CellId); ++Edge)
+		{
+			const FGridCoord Delta = GetEdgeDelta(Edge);
+			const int32 StepCost = Delta.X != 0 && Delta.Y != 0 ? DiagonalCost : StraightCost;
+			const int32 Multiplier = CellCost + std::max<int32>(Costs[EdgeTargets[Edge]], 1);
+			(*CostStorage)[Edge] = StepCost * Multiplier / 2;
+			bUniform &= Multiplier == 2;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(EdgeCostsLock);
+		EdgeCosts = std::shared_ptr<const int32>(CostStorage, CostStorage->data());
+		EdgeCostStorage = std::move(CostStorage);
+	}
+	bUniformCosts = bUniform;
+}
+
+FEdgeCostSnapshot FGridGraph::GetEdgeCosts() const
+{
+	std::lock_guard<std::mutex> Lock(EdgeCostsLock);
+	return FEdgeCostSnapshot(EdgeCosts);
+}
+
+void FGridGraph::SetWalkable(int32 CellId, bool bWalkable)
+{
+	const uint32 Mask = 1u << (CellId & 31);
+	if (bWalkable)
+	{
+		WalkableBits[CellId >> 5].fetch_or(Mask, std::memory_order_relaxed);
+	}
+	else
+	{
+		WalkableBits[CellId >> 5].fetch_and(~Mask, std::memory_order_relaxed);
+	}
+}
+
+void FGridGraph::ResetWalkableBits()
+{
+	NumWalkableWords = (Num() + 31) / 32;
+	WalkableBits.reset(new std::atomic<uint32>[NumWalkableWords]);
+	for (int32 Word = 0; Word < NumWalkableWords; ++Word)
+	{
+		WalkableBits[Word].store(0, std::memory_order_relaxed);
+	}
+}
+
+bool FGridGraph::IsMoveAllowed(int32 FromId, int32 ToId) const
+{
+	const FGridCoord From = GetCoord(FromId);
+	const FGridCoord To = GetCoord(ToId);
+	if (From.X == To.X || From.Y == To.Y)
+	{
+		return true;
+	}
+	return IsWalkable(To.X, From.Y) && IsWalkable(From.X, To.Y);
+}
+
+int32 FGridGraph::GetOctileDistance(int32 FromId, int32 ToId) const
+{
+	const FGridCoord Delta = GetCoord(ToId) - GetCoord(FromId);
+	return FOctileHeuristic::Get(std::abs(Delta.X), std::abs(Delta.Y), StraightCost, DiagonalCost);
+}
+
+SIZE_T FGridGraph::GetAllocatedSize() const
+{
+	std::lock_guard<std::mutex> Lock(EdgeCostsLock);
+	return NumWalkableWords * sizeof(uint32) + EdgeOffsetStorage.capacity() * sizeof(int32) + EdgeTargetStorage.capacity() * sizeof(int32) +
+		(EdgeCostStorage ? EdgeCostStorage->capacity() * sizeof(int32) : 0) + EdgeDeltaStorage.capacity() * sizeof(int8);
+}
+
+FAStarNodeTable* FGridGraph::AcquireNodeTable()
+{
+	FAStarNodeTable* Table = nullptr;
+	{
+		std::lock_guard<std::mutex> Lock(NodeTablesLock);
+		if (!FreeNodeTables.empty())
+		{
+			Table = FreeNodeTables.back();
+			FreeNodeTables.pop_back();
+		}
+	}
+	if (!Table)
+	{
+		Table = new FAStarNodeTable();
+	}
+	Table->Reset(Num());
+	return Table;
+}
+
+void FGridGraph::ReleaseNodeTable(FAStarNodeTable* Table)
+{
+	std::lock_guard<std::mutex> Lock(NodeTablesLock);
+	FreeNodeTables.push_back(Table);
+}
+
+FScopedNodeTable::FScopedNodeTable(FGridGraph& InGraph)
+	: Graph(InGraph)
+	, Table(InGraph.AcquireNodeTable())
+{
+}
+
+FScopedNodeTable::~FScopedNodeTable()
+{
+	Graph.ReleaseNodeTable(Table);
+}
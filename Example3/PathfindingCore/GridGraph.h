@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class FAStarNodeTable;
+class FGridFile;
+
+/** Step cost per edge id as of one moment, the array stays alive for as long as a snapshot holds it */
+class FEdgeCostSnapshot
+{
+public:
+	FEdgeCostSnapshot() : Costs(nullptr) {}
+	explicit FEdgeCostSnapshot(std::shared_ptr<const int32> InOwner) : Owner(std::move(InOwner)), Costs(Owner.get()) {}
+
+	int32 operator[](int32 Edge) const { return Costs[Edge]; }
+
+private:
+	std::shared_ptr<const int32> Owner;
+	const int32* Costs;
+};
+
+/**
+ * Search graph over a rectangular grid of cells with integer ids (Y * Width + X).
+ * Adjacency is flattened into CSR arrays and walkability is one bit per cell, so the searches
+ * never touch anything but plain arrays. Holds the node tables the searches borrow, so one graph
+ * can be searched from several threads at once.
+ */
+class INVADED_API FGridGraph
+{
+public:
+	FGridGraph();
+	virtual ~FGridGraph();
+
+	FGridGraph(const FGridGraph&) = delete;
+	FGridGraph& operator=(const FGridGraph&) = delete;
+
+	/** 8-connected lattice, Walkable holds one entry per cell id */
+	void BuildLattice(int32 InWidth, int32 InHeight, const std::vector<bool>& Walkable, int32 InStraightCost, int32 InDiagonalCost);
+
+	/**
+	 * Arbitrary adjacency between lattice cells, the edges of a cell are Targets[Offsets[CellId]] up to
+	 * Targets[Offsets[CellId + 1]]. Every cell starts blocked, step costs follow from the lattice offsets.
+	 */
+	void BuildAdjacency(int32 InWidth, int32 InHeight, const std::vector<int32>& Offsets, const std::vector<int32>& Targets, int32 InStraightCost, int32 InDiagonalCost);
+
+	/**
+	 * Takes size, costs and walkability from a grid file and reads its adjacency where it lies, so a mapped file
+	 * is searched without a copy. The file's memory has to outlive the graph or its next build.
+	 */
+	void Attach(const FGridFile& File);
+
+	/**
+	 * Weights the steps by terrain, Costs holds one multiplier per cell id and a step costs its plain cost times the mean
+	 * of the two cells it joins, so moves stay symmetric. Multipliers below 1 count as 1, which keeps the octile estimates
+	 * admissible. Only the searches that relax edges honour the weights, see HasUniformCosts.
+	 * May run while searches do, from one thread at a time: the costs go into a new array, and searches that took a
+	 * snapshot before keep reading the old one until they let go of it.
+	 */
+	void SetCellCosts(const std::vector<uint8>& Costs);
+
+	/** Every step costs the plain straight or diagonal cost, jump points, any-angle lines and the hierarchy rely on it */
+	bool HasUniformCosts() const { return bUniformCosts; }
+
+	int32 Num() const { return Width * Height; }
+	int32 GetWidth() const { return Width; }
+	int32 GetHeight() const { return Height; }
+
+	bool IsValidCoord(int32 X, int32 Y) const { return X >= 0 && Y >= 0 && X < Width && Y < Height; }
+	int32 GetCellId(int32 X, int32 Y) const { return Y * Width + X; }
+	FGridCoord GetCoord(int32 CellId) const { return FGridCoord(CellId % Width, CellId / Width); }
+
+	bool IsWalkable(int32 CellId) const { return (WalkableBits[CellId >> 5].load(std::memory_order_relaxed) >> (CellId & 31)) & 1; }
+	bool IsWalkable(int32 X, int32 Y) const { return IsValidCoord(X, Y) && IsWalkable(GetCellId(X, Y)); }
+
+	/**
+	 * Only flips the bit, whoever owns data derived from the graph (hierarchies, caches) has to be told separately.
+	 * The bits are updated atomically, so searches running meanwhile see each cell either before or after the change.
+	 */
+	void SetWalkable(int32 CellId, bool bWalkable);
+
+	/** Edges of a cell are [GetFirstEdge, GetEndEdge), walkable or not, each carries its neighbour id and step cost */
+	int32 GetFirstEdge(int32 CellId) const { return EdgeOffsets[CellId]; }
+	int32 GetEndEdge(int32 CellId) const { return EdgeOffsets[CellId + 1]; }
+	int32 GetEdgeTarget(int32 Edge) const { return EdgeTargets[Edge]; }
+
+	/** Step costs indexed by edge, a search takes one snapshot up front and reads every cost through it */
+	FEdgeCostSnapshot GetEdgeCosts() const;
+
+	/** Lattice step from the cell to the edge target, lets heuristics skip dividing the target id by the width */
+	FGridCoord GetEdgeDelta(int32 Edge) const { return FGridCoord(EdgeDeltas[Edge * 2], EdgeDeltas[Edge * 2 + 1]); }
+
+	/** Most edges any cell has, for sizing per-expansion scratch buffers */
+	int32 GetMaxEdges() const { return MaxEdges; }
+
+	/** Diagonal steps may not cut the corner of an unwalkable cell */
+	bool IsMoveAllowed(int32 FromId, int32 ToId) const;
+
+	/** Cost of one orthogonal / diagonal step */
+	int32 GetStraightCost() const { return StraightCost; }
+	int32 GetDiagonalCost() const { return DiagonalCost; }
+
+	/** Cost of the cheapest 8-connected route between two cells on an empty grid */
+	int32 GetOctileDistance(int32 FromId, int32 ToId) const;
+
+	/** Memory held by the walkable bits and adjacency, an attached file's arrays are not counted */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Hands out a search table sized for this graph, tables are recycled so concurrent queries never share one */
+	FAStarNodeTable* AcquireNodeTable();
+	void ReleaseNodeTable(FAStarNodeTable* Table);
+
+protected:
+	int32 Width;
+	int32 Height;
+
+	int32 StraightCost;
+	int32 DiagonalCost;
+
+	/** One bit per cell id, words are read and written atomically as searches run while cells change */
+	std::unique_ptr<std::atomic<uint32>[]> WalkableBits;
+	int32 NumWalkableWords;
+
+	/** Adjacency arrays, pointing into the storage below or into an attached grid file */
+	const int32* EdgeOffsets;
+	const int32* EdgeTargets;
+	const int8* EdgeDeltas;
+	int32 NumEdges;
+	int32 MaxEdges;
+	std::atomic<bool> bUniformCosts;
+
+private:
+	/** Makes every word zero, sized for the current width and height */
+	void ResetWalkableBits();
+
+	std::vector<int32> EdgeOffsetStorage;
+	std::vector<int32> EdgeTargetStorage;
+	std::vector<int8> EdgeDeltaStorage;
+
+	/** Costs handed to new snapshots, owned by EdgeCostStorage or pointing into an attached grid file */
+	std::shared_ptr<const int32> EdgeCosts;
+	std::shared_ptr<const std::vector<int32>> EdgeCostStorage;
+	mutable std::mutex EdgeCostsLock;
+
+	std::mutex NodeTablesLock;
+	std::vector<FAStarNodeTable*> FreeNodeTables;
+};
+
+/** Borrows a node table from the graph for the duration of a query */
+class FScopedNodeTable
+{
+public:
+	explicit FScopedNodeTable(FGridGraph& InGraph);
+	~FScopedNodeTable();
+
+	FAStarNodeTable& operator*() const { return *Table; }
+	FAStarNodeTable* operator->() const { return Table; }
+
+private:
+	FGridGraph& Graph;
+	FAStarNodeTable* Table;
+};
@@ -0,0 +1,473 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HierarchicalPathfinder.h"
+#include "AStarNodeTable.h"
+#include "AStarOpenSet.h"
+#include "GridGraph.h"
+#include <algorithm>
+#include <mutex>
+
+namespace
+{
+	/** Runs shorter than this get a single entrance in the middle, longer ones one at each end */
+	const int32 MaxSingleEntranceLength = 6;
+
+	struct FRectOpenEntry
+	{
+		int32 Cost;
+		int32 CellId;
+
+		FRectOpenEntry(int32 InCost, int32 InCellId) : Cost(InCost), CellId(InCellId) {}
+
+		static bool Greater(const FRectOpenEntry& A, const FRectOpenEntry& B) { return A.Cost > B.Cost; }
+	};
+}
+
+FHierarchicalPathfinder::FHierarchicalPathfinder(FGridGraph& InGraph, int32 InClusterSize, FParallelFor InParallelFor)
+	: Graph(InGraph)
+	, ParallelFor(InParallelFor)
+{
+	ClusterSize = std::max(InClusterSize, 2);
+	ClustersX = (Graph.GetWidth() + ClusterSize - 1) / ClusterSize;
+	ClustersY = (Graph.GetHeight() + ClusterSize - 1) / ClusterSize;
+}
+
+void FHierarchicalPathfinder::Build()
+{
+	// Queries keep reading the old clusters until the whole new set is ready
+	std::vector<FCluster> NewClusters(ClustersX * ClustersY);
+	RunParallel(ClustersX * ClustersY, [this, &NewClusters](int32 ClusterIndex)
+	{
+		NewClusters[ClusterIndex] = MakeCluster(ClusterIndex);
+	});
+
+	std::unique_lock<std::shared_mutex> Lock(ClustersLock);
+	Clusters.swap(NewClusters);
+}
+
+void FHierarchicalPathfinder::OnWalkabilityChanged(int32 CellId)
+{
+	const FGridCoord Coord = Graph.GetCoord(CellId);
+	const int32 ClusterIndex = GetClusterIndex(CellId);
+	const FRect Rect = GetClusterRect(ClusterIndex);
+
+	// Inner cells only change costs inside their cluster, border cells also change the entrances of the neighbour
+	std::vector<int32> Touched;
+	Touched.reserve(5);
+	Touched.push_back(ClusterIndex);
+	if (Coord.X == Rect.MinX && Rect.MinX > 0)
+	{
+		Touched.push_back(ClusterIndex - 1);
+	}
+	if (Coord.X == Rect.MaxX - 1 && Rect.MaxX < Graph.GetWidth())
+	{
+		Touched.push_back(ClusterIndex + 1);
+	}
+	if (Coord.Y == Rect.MinY && Rect.MinY > 0)
+	{
+		Touched.push_back(ClusterIndex - ClustersX);
+	}
+	if (Coord.Y == Rect.MaxY - 1 && Rect.MaxY < Graph.GetHeight())
+	{
+		Touched.push_back(ClusterIndex + ClustersX);
+	}
+
+	std::vector<FCluster> NewClusters(Touched.size());
+	RunParallel(int32(Touched.size()), [this, &Touched, &NewClusters](int32 Index)
+	{
+		NewClusters[Index] = MakeCluster(Touched[Index]);
+	});
+
+	std::unique_lock<std::shared_mutex> Lock(ClustersLock);
+	for (int32 Index = 0; Index < int32(Touched.size()); ++Index)
+	{
+		Clusters[Touched[Index]] = std::move(NewClusters[Index]);
+	}
+}
+
+bool FHierarchicalPathfinder::FindPath(int32 StartId, int32 TargetId, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats) const
+{
+	// Only the abstract search is counted, refinement is bounded by the cluster size
+	FPathSearchStats LocalStats;
+	FPathSearchStats& Stats = OutStats ? *OutStats : LocalStats;
+	Stats = FPathSearchStats();
+
+	OutPath.clear();
+	if (StartId == TargetId)
+	{
+		return true;
+	}
+	if (!Graph.IsWalkable(TargetId))
+	{
+		return false;
+	}
+
+	std::shared_lock<std::shared_mutex> Lock(ClustersLock);
+
+	const int32 StartClusterIndex = GetClusterIndex(StartId);
+	const int32 TargetClusterIndex = GetClusterIndex(TargetId);
+	const FRect StartRect = GetClusterRect(StartClusterIndex);
+	const FRect TargetRect = GetClusterRect(TargetClusterIndex);
+	if (StartClusterIndex == TargetClusterIndex && RefineSegment(StartRect, StartId, TargetId, OutPath))
+	{
+		return true;
+	}
+
+	// Hook the start and the target up to the entrances of their clusters
+	const FCluster& StartCluster = Clusters[StartClusterIndex];
+	const FCluster& TargetCluster = Clusters[TargetClusterIndex];
+	std::vector<int32> RectCosts;
+	std::vector<int32> StartCosts;
+	std::vector<int32> TargetCosts;
+	SearchRect(StartRect, StartId, INDEX_NONE, RectCosts, nullptr);
+	for (int32 NodeId : StartCluster.Nodes)
+	{
+		const FGridCoord Coord = Graph.GetCoord(NodeId);
+		StartCosts.push_back(RectCosts[(Coord.Y - StartRect.MinY) * StartRect.GetWidth() + Coord.X - StartRect.MinX]);
+	}
+	SearchRect(TargetRect, TargetId, INDEX_NONE, RectCosts, nullptr);
+	for (int32 NodeId : TargetCluster.Nodes)
+	{
+		const FGridCoord Coord = Graph.GetCoord(NodeId);
+		TargetCosts.push_back(RectCosts[(Coord.Y - TargetRect.MinY) * TargetRect.GetWidth() + Coord.X - TargetRect.MinX]);
+	}
+
+	// A* over the abstract graph, nodes keep their cell ids
+	FScopedNodeTable Nodes(Graph);
+	FAStarOpenSet OpenSet(*Nodes, &Stats);
+
+	auto Relax = [&](int32 FromId, int32 ToId, int32 EdgeCost)
+	{
+		++Stats.NeighboursEvaluated;
+		if (EdgeCost == MAX_int32 || Nodes->IsClosed(ToId))
+		{
+			return;
+		}
+		if (!Nodes->IsVisited(ToId))
+		{
+			Nodes->Visit(ToId);
+		}
+		const bool bInOpenSet = OpenSet.Contains(ToId);
+		const int32 MovementCost = Nodes->GetGCost(FromId) + EdgeCost;
+		if (MovementCost < Nodes->GetGCost(ToId) || !bInOpenSet)
+		{
+			Nodes->SetGCost(ToId, MovementCost);
+			Nodes->SetHCost(ToId, Graph.GetOctileDistance(ToId, TargetId));
+			Nodes->SetParent(ToId, FromId);
+			if (bInOpenSet)
+			{
+				OpenSet.Update(ToId);
+			}
+			else
+			{
+				OpenSet.Push(ToId);
+				++Stats.NodesGenerated;
+			}
+		}
+	};
+
+	Nodes->Visit(StartId);
+	Nodes->SetGCost(StartId, 0);
+	Nodes->SetHCost(StartId, Graph.GetOctileDistance(StartId, TargetId));
+	OpenSet.Push(StartId);
+	++Stats.NodesGenerated;
+
+	bool bFound = false;
+	while (!OpenSet.IsEmpty())
+	{
+		if (Cancellation && Cancellation->IsCancelled())
+		{
+			return false;
+		}
+
+		const int32 CurrentId = OpenSet.Pop();
+		++Stats.NodesExpanded;
+		if (CurrentId == TargetId)
+		{
+			bFound = true;
+			break;
+		}
+
+		if (CurrentId == StartId)
+		{
+			for (int32 i = 0; i < int32(StartCluster.Nodes.size()); ++i)
+			{
+				Relax(CurrentId, StartCluster.Nodes[i], StartCosts[i]);
+			}
+		}
+
+		const int32 ClusterIndex = GetClusterIndex(CurrentId);
+		const FCluster& Cluster = Clusters[ClusterIndex];
+		const auto Found = std::find(Cluster.Nodes.begin(), Cluster.Nodes.end(), CurrentId);
+		if (Found == Cluster.Nodes.end())
+		{
+			continue;
+		}
+		const int32 LocalIndex = int32(Found - Cluster.Nodes.begin());
+
+		const int32 NumNodes = int32(Cluster.Nodes.size());
+		for (int32 i = 0; i < NumNodes; ++i)
+		{
+			if (i != LocalIndex)
+			{
+				Relax(CurrentId, Cluster.Nodes[i], Cluster.Costs[LocalIndex * NumNodes + i]);
+			}
+		}
+		for (const FGridCoord& Transition : Cluster.Transitions)
+		{
+			if (Transition.X == LocalIndex)
+			{
+				Relax(CurrentId, Transition.Y, Graph.GetStraightCost());
+			}
+		}
+		if (ClusterIndex == TargetClusterIndex)
+		{
+			Relax(CurrentId, TargetId, TargetCosts[LocalIndex]);
+		}
+	}
+
+	if (!bFound)
+	{
+		return false;
+	}
+
+	std::vector<int32> AbstractPath;
+	for (int32 CellId = TargetId; CellId != INDEX_NONE; CellId = Nodes->GetParent(CellId))
+	{
+		AbstractPath.push_back(CellId);
+	}
+	std::reverse(AbstractPath.begin(), AbstractPath.end());
+
+	// Refine only the clusters the abstract path crosses
+	for (int32 i = 1; i < int32(AbstractPath.size()); ++i)
+	{
+		const int32 FromId = AbstractPath[i - 1];
+		const int32 ToId = AbstractPath[i];
+		const int32 ClusterIndex = GetClusterIndex(FromId);
+		if (ClusterIndex != GetClusterIndex(ToId))
+		{
+			OutPath.push_back(ToId);
+		}
+		else if (!RefineSegment(GetClusterRect(ClusterIndex), FromId, ToId, OutPath))
+		{
+			OutPath.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+int32 FHierarchicalPathfinder::GetClusterIndex(int32 CellId) const
+{
+	const FGridCoord Coord = Graph.GetCoord(CellId);
+	return (Coord.Y / ClusterSize) * ClustersX + Coord.X / ClusterSize;
+}
+
+FHierarchicalPathfinder::FRect FHierarchicalPathfinder::GetClusterRect(int32 ClusterIndex) const
+{
+	FRect Rect;
+	Rect.MinX = (ClusterIndex % ClustersX) * ClusterSize;
+	Rect.MinY = (ClusterIndex / ClustersX) * ClusterSize;
+	Rect.MaxX = std::min(Rect.MinX + ClusterSize, Graph.GetWidth());
+	Rect.MaxY = std::min(Rect.MinY + ClusterSize, Graph.GetHeight());
+	return Rect;
+}
+
+FHierarchicalPathfinder::FCluster FHierarchicalPathfinder::MakeCluster(int32 ClusterIndex) const
+{
+	const FRect Rect = GetClusterRect(ClusterIndex);
+
+	// Pairs of (cell inside, cell across the border)
+	std::vector<FGridCoord> Pairs;
+	if (Rect.MinX > 0)
+	{
+		ScanBorder(Rect.MinX, Rect.MinY, Rect.MinX, Rect.MaxY, FGridCoord(-1, 0), Pairs);
+	}
+	if (Rect.MaxX < Graph.GetWidth())
+	{
+		ScanBorder(Rect.MaxX - 1, Rect.MinY, Rect.MaxX - 1, Rect.MaxY, FGridCoord(1, 0), Pairs);
+	}
+	if (Rect.MinY > 0)
+	{
+		ScanBorder(Rect.MinX, Rect.MinY, Rect.MaxX, Rect.MinY, FGridCoord(0, -1), Pairs);
+	}
+	if (Rect.MaxY < Graph.GetHeight())
+	{
+		ScanBorder(Rect.MinX, Rect.MaxY - 1, Rect.MaxX, Rect.MaxY - 1, FGridCoord(0, 1), Pairs);
+	}
+
+	FCluster Cluster;
+	for (const FGridCoord& Pair : Pairs)
+	{
+		auto Found = std::find(Cluster.Nodes.begin(), Cluster.Nodes.end(), Pair.X);
+		if (Found == Cluster.Nodes.end())
+		{
+			Found = Cluster.Nodes.insert(Cluster.Nodes.end(), Pair.X);
+		}
+		Cluster.Transitions.push_back(FGridCoord(int32(Found - Cluster.Nodes.begin()), Pair.Y));
+	}
+
+	const int32 NumNodes = int32(Cluster.Nodes.size());
+	Cluster.Costs.resize(NumNodes * NumNodes);
+	std::vector<int32> RectCosts;
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		SearchRect(Rect, Cluster.Nodes[i], INDEX_NONE, RectCosts, nullptr);
+		for (int32 j = 0; j < NumNodes; ++j)
+		{
+			const FGridCoord Coord = Graph.GetCoord(Cluster.Nodes[j]);
+			Cluster.Costs[i * NumNodes + j] = RectCosts[(Coord.Y - Rect.MinY) * Rect.GetWidth() + Coord.X - Rect.MinX];
+		}
+	}
+
+	return Cluster;
+}
+
+void FHierarchicalPathfinder::RunParallel(int32 Num, const std::function<void(int32 Index)>& Body) const
+{
+	if (ParallelFor)
+	{
+		ParallelFor(Num, Body);
+		return;
+	}
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		Body(Index);
+	}
+}
+
+void FHierarchicalPathfinder::ScanBorder(int32 X0, int32 Y0, int32 X1, int32 Y1, const FGridCoord& Normal, std::vector<FGridCoord>& OutPairs) const
+{
+	// Both clusters scan a shared border in the same direction, so they agree on where the entrances are
+	const FGridCoord Step(X0 == X1 ? 0 : 1, X0 == X1 ? 1 : 0);
+	const int32 Length = std::max(X1 - X0, Y1 - Y0);
+
+	auto AddEntrance = [&](int32 Index)
+	{
+		const FGridCoord Inside(X0 + Step.X * Index, Y0 + Step.Y * Index);
+		const FGridCoord Outside = Inside + Normal;
+		OutPairs.push_back(FGridCoord(Graph.GetCellId(Inside.X, Inside.Y), Graph.GetCellId(Outside.X, Outside.Y)));
+	};
+
+	int32 RunStart = INDEX_NONE;
+	for (int32 i = 0; i <= Length; ++i)
+	{
+		bool bOpen = false;
+		if (i < Length)
+		{
+			const FGridCoord Inside(X0 + Step.X * i, Y0 + Step.Y * i);
+			const FGridCoord Outside = Inside + Normal;
+			bOpen = Graph.IsWalkable(Inside.X, Inside.Y) && Graph.IsWalkable(Outside.X, Outside.Y);
+		}
+
+		if (bOpen && RunStart == INDEX_NONE)
+		{
+			RunStart = i;
+		}
+		else if (!bOpen && RunStart != INDEX_NONE)
+		{
+			const int32 RunLength = i - RunStart;
+			if (RunLength < MaxSingleEntranceLength)
+			{
+				AddEntrance(RunStart + RunLength / 2);
+			}
+			else
+			{
+				AddEntrance(RunStart);
+				AddEntrance(i - 1);
+			}
+			RunStart = INDEX_NONE;
+		}
+	}
+}
+
+void FHierarchicalPathfinder::SearchRect(const FRect& Rect, int32 SourceId, int32 TargetId, std::vector<int32>& OutCosts, std::vector<int32>* OutParents) const
+{
+	const int32 RectWidth = Rect.GetWidth();
+	auto ToLocal = [&Rect, RectWidth](const FGridCoord& Coord)
+	{
+		return (Coord.Y - Rect.MinY) * RectWidth + Coord.X - Rect.MinX;
+	};
+
+	OutCosts.assign(RectWidth * Rect.GetHeight(), MAX_int32);
+	if (OutParents)
+	{
+		OutParents->assign(RectWidth * Rect.GetHeight(), INDEX_NONE);
+	}
+
+	// Min-heap through std::push_heap / std::pop_heap with the comparison flipped
+	std::vector<FRectOpenEntry> Open;
+	OutCosts[ToLocal(Graph.GetCoord(SourceId))] = 0;
+	Open.push_back(FRectOpenEntry(0, SourceId));
+	while (!Open.empty())
+	{
+		std::pop_heap(Open.begin(), Open.end(), FRectOpenEntry::Greater);
+		const FRectOpenEntry Entry = Open.back();
+		Open.pop_back();
+
+		const FGridCoord Coord = Graph.GetCoord(Entry.CellId);
+		if (Entry.Cost > OutCosts[ToLocal(Coord)])
+		{
+			continue;
+		}
+		if (Entry.CellId == TargetId)
+		{
+			break;
+		}
+
+		for (int32 DY = -1; DY <= 1; ++DY)
+		{
+			for (int32 DX = -1; DX <= 1; ++DX)
+			{
+				const FGridCoord Next(Coord.X + DX, Coord.Y + DY);
+				if ((DX == 0 && DY == 0) || !Rect.Contains(Next.X, Next.Y) || !Graph.IsWalkable(Next.X, Next.Y))
+				{
+					continue;
+				}
+
+				const int32 NextId = Graph.GetCellId(Next.X, Next.Y);
+				if (!Graph.IsMoveAllowed(Entry.CellId, NextId))
+				{
+					continue;
+				}
+
+				const int32 Cost = Entry.Cost + (DX != 0 && DY != 0 ? Graph.GetDiagonalCost() : Graph.GetStraightCost());
+				int32& NextCost = OutCosts[ToLocal(Next)];
+				if (Cost < NextCost)
+				{
+					NextCost = Cost;
+					if (OutParents)
+					{
+						(*OutParents)[ToLocal(Next)] = Entry.CellId;
+					}
+					Open.push_back(FRectOpenEntry(Cost, NextId));
+					std::push_heap(Open.begin(), Open.end(), FRectOpenEntry::Greater);
+				}
+			}
+		}
+	}
+}
+
+bool FHierarchicalPathfinder::RefineSegment(const FRect& Rect, int32 FromId, int32 ToId, std::vector<int32>& OutPath) const
+{
+	std::vector<int32> Costs;
+	std::vector<int32> Parents;
+	SearchRect(Rect, FromId, ToId, Costs, &Parents);
+
+	const FGridCoord To = Graph.GetCoord(ToId);
+	const int32 LocalTo = (To.Y - Rect.MinY) * Rect.GetWidth() + To.X - Rect.MinX;
+	if (Costs[LocalTo] == MAX_int32)
+	{
+		return false;
+	}
+
+	const int32 FirstIndex = int32(OutPath.size());
+	for (int32 CellId = ToId; CellId != FromId; )
+	{
+		OutPath.push_back(CellId);
+		const FGridCoord Coord = Graph.GetCoord(CellId);
+		CellId = Parents[(Coord.Y - Rect.MinY) * Rect.GetWidth() + Coord.X - Rect.MinX];
+	}
+	std::reverse(OutPath.begin() + FirstIndex, OutPath.end());
+	return true;
+}
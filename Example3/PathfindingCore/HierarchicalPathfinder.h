@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <functional>
+#include <shared_mutex>
+#include <vector>
+
+class FGridGraph;
+
+/**
+ * HPA* abstraction over an FGridGraph.
+ * The grid is cut into square clusters; walkable runs along cluster borders become entrance
+ * nodes and the cost between every pair of entrances of a cluster is precomputed. Queries search
+ * this small abstract graph first and only refine the clusters the abstract path goes through.
+ * Paths are near-optimal, not optimal.
+ */
+class INVADED_API FHierarchicalPathfinder
+{
+public:
+	/** Runs Body for every index in [0, Num), possibly in parallel, the engine passes its task graph ParallelFor */
+	typedef std::function<void(int32 Num, const std::function<void(int32 Index)>& Body)> FParallelFor;
+
+	explicit FHierarchicalPathfinder(FGridGraph& InGraph, int32 InClusterSize = 16, FParallelFor InParallelFor = FParallelFor());
+
+	/** Preprocesses every cluster, spread across ParallelFor when there is one. Running queries keep the old clusters until the new ones are swapped in. */
+	void Build();
+
+	/** Rebuilds the clusters whose entrances or inner costs depend on the cell */
+	void OnWalkabilityChanged(int32 CellId);
+
+	/** Fills OutPath with the cells after StartId up to TargetId, false when the target can't be reached or the search was cancelled */
+	bool FindPath(int32 StartId, int32 TargetId, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation = nullptr, FPathSearchStats* OutStats = nullptr) const;
+
+	int32 GetClusterSize() const { return ClusterSize; }
+	int32 GetNumClusters() const { return int32(Clusters.size()); }
+
+private:
+	struct FCluster
+	{
+		/** Entrance cells, the nodes of the abstract graph */
+		std::vector<int32> Nodes;
+
+		/** Cost between each pair of nodes through the cluster, row-major, MAX_int32 when not connected */
+		std::vector<int32> Costs;
+
+		/** Links to entrances across the border, X is the local node index and Y the cell on the other side */
+		std::vector<FGridCoord> Transitions;
+	};
+
+	struct FRect
+	{
+		int32 MinX;
+		int32 MinY;
+		int32 MaxX;
+		int32 MaxY;
+
+		bool Contains(int32 X, int32 Y) const { return X >= MinX && Y >= MinY && X < MaxX && Y < MaxY; }
+		int32 GetWidth() const { return MaxX - MinX; }
+		int32 GetHeight() const { return MaxY - MinY; }
+	};
+
+	int32 GetClusterIndex(int32 CellId) const;
+	FRect GetClusterRect(int32 ClusterIndex) const;
+
+	/** Finds the entrances of the cluster and the costs between them, reads only the graph */
+	FCluster MakeCluster(int32 ClusterIndex) const;
+
+	/** ParallelFor when one was given, a plain loop otherwise */
+	void RunParallel(int32 Num, const std::function<void(int32 Index)>& Body) const;
+
+	/** Adds entrance pairs found on the border between (X0, Y0)-(X1, Y1) and the cells one step along Normal */
+	void ScanBorder(int32 X0, int32 Y0, int32 X1, int32 Y1, const FGridCoord& Normal, std::vector<FGridCoord>& OutPairs) const;
+
+	/**
+	 * Dijkstra restricted to a rectangle. OutCosts is indexed by position inside the rectangle.
+	 * Stops early once TargetId is settled, OutParents is filled with cell ids when given.
+	 */
+	void SearchRect(const FRect& Rect, int32 SourceId, int32 TargetId, std::vector<int32>& OutCosts, std::vector<int32>* OutParents) const;
+
+	/** Appends the cells after FromId up to ToId, both inside the rectangle */
+	bool RefineSegment(const FRect& Rect, int32 FromId, int32 ToId, std::vector<int32>& OutPath) const;
+
+	FGridGraph& Graph;
+
+	int32 ClusterSize;
+	int32 ClustersX;
+	int32 ClustersY;
+
+	FParallelFor ParallelFor;
+
+	std::vector<FCluster> Clusters;
+
+	/** Queries read the clusters from worker threads while walkability changes rebuild them */
+	mutable std::shared_mutex ClustersLock;
+};
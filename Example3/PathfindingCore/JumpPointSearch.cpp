@@ -0,0 +1,265 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "JumpPointSearch.h"
+#include "AStarNodeTable.h"
+#include "AStarOpenSet.h"
+#include "GridGraph.h"
+#include "JumpPointTable.h"
+#include <algorithm>
+#include <cstdlib>
+#include <shared_mutex>
+
+namespace
+{
+	int32 Sign(int32 Value)
+	{
+		return (Value > 0) - (Value < 0);
+	}
+}
+
+bool FJumpPointSearch::FindPath(FGridGraph& Graph, int32 StartId, int32 TargetId, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats)
+{
+	auto WalkJump = [&Graph, TargetId](int32 /*CurrentId*/, const FGridCoord& Current, int32 DX, int32 DY)
+	{
+		return Jump(Graph, Current.X, Current.Y, DX, DY, TargetId);
+	};
+	return Search(Graph, StartId, TargetId, WalkJump, OutPath, Cancellation, OutStats);
+}
+
+bool FJumpPointSearch::FindPath(const FJumpPointTable& Table, int32 StartId, int32 TargetId, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats)
+{
+	std::shared_lock<std::shared_mutex> ReadLock(Table.Lock);
+
+	FGridGraph& Graph = Table.GetGraph();
+	const FGridCoord Target = Graph.GetCoord(TargetId);
+	auto TableJump = [&Table, &Target](int32 CurrentId, const FGridCoord& Current, int32 DX, int32 DY)
+	{
+		return LookUpJump(Table, CurrentId, Current, DX, DY, Target);
+	};
+	return Search(Graph, StartId, TargetId, TableJump, OutPath, Cancellation, OutStats);
+}
+
+template<typename JumpFunctionType>
+bool FJumpPointSearch::Search(FGridGraph& Graph, int32 StartId, int32 TargetId, const JumpFunctionType& Jump, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats)
+{
+	FPathSearchStats LocalStats;
+	FPathSearchStats& Stats = OutStats ? *OutStats : LocalStats;
+	Stats = FPathSearchStats();
+
+	FScopedNodeTable Nodes(Graph);
+	FAStarOpenSet OpenSet(*Nodes, &Stats);
+	OutPath.clear();
+
+	Nodes->Visit(StartId);
+	Nodes->SetGCost(StartId, 0);
+	Nodes->SetHCost(StartId, Graph.GetOctileDistance(StartId, TargetId));
+	OpenSet.Push(StartId);
+	++Stats.NodesGenerated;
+
+	FGridCoord Directions[8];
+	while (!OpenSet.IsEmpty())
+	{
+		if (Cancellation && Cancellation->IsCancelled())
+		{
+			return false;
+		}
+
+		const int32 CurrentId = OpenSet.Pop();
+		++Stats.NodesExpanded;
+		if (CurrentId == TargetId)
+		{
+			RetracePath(Graph, *Nodes, StartId, TargetId, OutPath);
+			return true;
+		}
+
+		const FGridCoord Current = Graph.GetCoord(CurrentId);
+		const int32 NumDirections = GetPrunedDirections(Graph, *Nodes, CurrentId, Directions);
+		Stats.NeighboursEvaluated += NumDirections;
+		for (int32 i = 0; i < NumDirections; ++i)
+		{
+			const int32 JumpId = Jump(CurrentId, Current, Directions[i].X, Directions[i].Y);
+			if (JumpId == INDEX_NONE || Nodes->IsClosed(JumpId))
+			{
+				continue;
+			}
+
+			if (!Nodes->IsVisited(JumpId))
+			{
+				Nodes->Visit(JumpId);
+			}
+
+			const bool bInOpenSet = OpenSet.Contains(JumpId);
+			const int32 MovementCost = Nodes->GetGCost(CurrentId) + Graph.GetOctileDistance(CurrentId, JumpId);
+			if (MovementCost < Nodes->GetGCost(JumpId) || !bInOpenSet)
+			{
+				Nodes->SetGCost(JumpId, MovementCost);
+				Nodes->SetHCost(JumpId, Graph.GetOctileDistance(JumpId, TargetId));
+				Nodes->SetParent(JumpId, CurrentId);
+
+				if (bInOpenSet)
+				{
+					OpenSet.Update(JumpId);
+				}
+				else
+				{
+					OpenSet.Push(JumpId);
+					++Stats.NodesGenerated;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+int32 FJumpPointSearch::Jump(const FGridGraph& Graph, int32 X, int32 Y, int32 DX, int32 DY, int32 TargetId)
+{
+	while (true)
+	{
+		// Diagonal steps can't squeeze past a blocked corner
+		if (DX != 0 && DY != 0 && !(Graph.IsWalkable(X + DX, Y) && Graph.IsWalkable(X, Y + DY)))
+		{
+			return INDEX_NONE;
+		}
+
+		X += DX;
+		Y += DY;
+		if (!Graph.IsWalkable(X, Y))
+		{
+			return INDEX_NONE;
+		}
+
+		const int32 CellId = Graph.GetCellId(X, Y);
+		if (CellId == TargetId)
+		{
+			return CellId;
+		}
+
+		if (DX != 0 && DY != 0)
+		{
+			// A diagonal node is a jump point when one of its straight scans finds something
+			if (Jump(Graph, X, Y, DX, 0, TargetId) != INDEX_NONE || Jump(Graph, X, Y, 0, DY, TargetId) != INDEX_NONE)
+			{
+				return CellId;
+			}
+		}
+		else if (DX != 0)
+		{
+			if ((Graph.IsWalkable(X, Y - 1) && !Graph.IsWalkable(X - DX, Y - 1)) ||
+				(Graph.IsWalkable(X, Y + 1) && !Graph.IsWalkable(X - DX, Y + 1)))
+			{
+				return CellId;
+			}
+		}
+		else
+		{
+			if ((Graph.IsWalkable(X - 1, Y) && !Graph.IsWalkable(X - 1, Y - DY)) ||
+				(Graph.IsWalkable(X + 1, Y) && !Graph.IsWalkable(X + 1, Y - DY)))
+			{
+				return CellId;
+			}
+		}
+	}
+}
+
+int32 FJumpPointSearch::LookUpJump(const FJumpPointTable& Table, int32 CurrentId, const FGridCoord& Current, int32 DX, int32 DY, const FGridCoord& Target)
+{
+	const FGridGraph& Graph = Table.GetGraph();
+	const int32 Distance = Table.Distances[size_t(CurrentId) * FJumpPointTable::NumDirections + FJumpPointTable::GetDirectionIndex(DX, DY)];
+	const int32 Reach = std::abs(Distance);
+
+	// The table knows nothing about the target, so a run that gets to it or level with it stops there.
+	// From the level cell a straight run reaches the target, the cell gets expanded like any other jump point
+	const FGridCoord ToTarget = Target - Current;
+	if (DX == 0 || DY == 0)
+	{
+		const bool bAhead = DX != 0 ? ToTarget.Y == 0 && Sign(ToTarget.X) == DX : ToTarget.X == 0 && Sign(ToTarget.Y) == DY;
+		if (bAhead && std::abs(ToTarget.X + ToTarget.Y) <= Reach)
+		{
+			return Graph.GetCellId(Target.X, Target.Y);
+		}
+	}
+	else if (Sign(ToTarget.X) == DX && Sign(ToTarget.Y) == DY)
+	{
+		const int32 Steps = std::min(std::abs(ToTarget.X), std::abs(ToTarget.Y));
+		if (Steps <= Reach)
+		{
+			return Graph.GetCellId(Current.X + DX * Steps, Current.Y + DY * Steps);
+		}
+	}
+	return Distance > 0 ? Graph.GetCellId(Current.X + DX * Distance, Current.Y + DY * Distance) : INDEX_NONE;
+}
+
+int32 FJumpPointSearch::GetPrunedDirections(const FGridGraph& Graph, const FAStarNodeTable& Nodes, int32 CellId, FGridCoord* OutDirections)
+{
+	const int32 ParentId = Nodes.GetParent(CellId);
+	int32 Count = 0;
+	if (ParentId == INDEX_NONE)
+	{
+		for (int32 DY = -1; DY <= 1; ++DY)
+		{
+			for (int32 DX = -1; DX <= 1; ++DX)
+			{
+				if (DX != 0 || DY != 0)
+				{
+					OutDirections[Count++] = FGridCoord(DX, DY);
+				}
+			}
+		}
+		return Count;
+	}
+
+	const FGridCoord Delta = Graph.GetCoord(CellId) - Graph.GetCoord(ParentId);
+	const int32 DX = Sign(Delta.X);
+	const int32 DY = Sign(Delta.Y);
+	if (DX != 0 && DY != 0)
+	{
+		OutDirections[Count++] = FGridCoord(DX, 0);
+		OutDirections[Count++] = FGridCoord(0, DY);
+		OutDirections[Count++] = FGridCoord(DX, DY);
+	}
+	else if (DX != 0)
+	{
+		OutDirections[Count++] = FGridCoord(DX, 0);
+		OutDirections[Count++] = FGridCoord(DX, 1);
+		OutDirections[Count++] = FGridCoord(DX, -1);
+		OutDirections[Count++] = FGridCoord(0, 1);
+		OutDirections[Count++] = FGridCoord(0, -1);
+	}
+	else
+	{
+		OutDirections[Count++] = FGridCoord(0, DY);
+		OutDirections[Count++] = FGridCoord(1, DY);
+		OutDirections[Count++] = FGridCoord(-1, DY);
+		OutDirections[Count++] = FGridCoord(1, 0);
+		OutDirections[Count++] = FGridCoord(-1, 0);
+	}
+	return Count;
+}
+
+void FJumpPointSearch::RetracePath(const FGridGraph& Graph, const FAStarNodeTable& Nodes, int32 StartId, int32 TargetId, std::vector<int32>& OutPath)
+{
+	// Jump points are joined by straight or diagonal runs, as many cells long as the larger offset. Counting them
+	// first lets the cells in between be written straight into their final slots.
+	int32 NumSteps = 0;
+	for (int32 CurrentId = TargetId; CurrentId != StartId; CurrentId = Nodes.GetParent(CurrentId))
+	{
+		const FGridCoord Delta = Graph.GetCoord(Nodes.GetParent(CurrentId)) - Graph.GetCoord(CurrentId);
+		NumSteps += std::max(std::abs(Delta.X), std::abs(Delta.Y));
+	}
+
+	OutPath.resize(NumSteps);
+	int32 CurrentId = TargetId;
+	while (CurrentId != StartId)
+	{
+		const int32 ParentId = Nodes.GetParent(CurrentId);
+		const FGridCoord Parent = Graph.GetCoord(ParentId);
+		FGridCoord Cell = Graph.GetCoord(CurrentId);
+		const FGridCoord Step(Sign(Parent.X - Cell.X), Sign(Parent.Y - Cell.Y));
+		while (Cell != Parent)
+		{
+			OutPath[--NumSteps] = Graph.GetCellId(Cell.X, Cell.Y);
+			Cell = Cell + Step;
+		}
+		CurrentId = ParentId;
+	}
+}
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <vector>
+
+class FGridGraph;
+class FAStarNodeTable;
+class FJumpPointTable;
+
+/**
+ * Jump Point Search for uniform-cost 8-connected grids.
+ * Symmetric neighbours are pruned and the search jumps along straight and diagonal
+ * lines, so only jump points ever reach the open set. Paths cost the same as the ones
+ * from FGridAStar and are expanded back to one cell per step.
+ * With an FJumpPointTable (JPS+) the jumps are looked up instead of walked.
+ */
+class INVADED_API FJumpPointSearch
+{
+public:
+	/** Fills OutPath with the cells after StartId up to TargetId, false when the target can't be reached or the search was cancelled */
+	static bool FindPath(FGridGraph& Graph, int32 StartId, int32 TargetId, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation = nullptr, FPathSearchStats* OutStats = nullptr);
+
+	/** Same search over the precomputed jump distances of the table, which has to be up to date with its graph */
+	static bool FindPath(const FJumpPointTable& Table, int32 StartId, int32 TargetId, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation = nullptr, FPathSearchStats* OutStats = nullptr);
+
+private:
+	/** The search both variants share, Jump(CurrentId, Current, DX, DY) returns the next jump point or INDEX_NONE */
+	template<typename JumpFunctionType>
+	static bool Search(FGridGraph& Graph, int32 StartId, int32 TargetId, const JumpFunctionType& Jump, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats);
+
+	/** Walks from (X, Y) in direction (DX, DY) and returns the first jump point, INDEX_NONE when a wall comes first */
+	static int32 Jump(const FGridGraph& Graph, int32 X, int32 Y, int32 DX, int32 DY, int32 TargetId);
+
+	/** Jump from the table, stops early on the target or on the cell level with it when the run passes one */
+	static int32 LookUpJump(const FJumpPointTable& Table, int32 CurrentId, const FGridCoord& Current, int32 DX, int32 DY, const FGridCoord& Target);
+
+	/** Directions worth jumping in from a node given the direction it was reached from */
+	static int32 GetPrunedDirections(const FGridGraph& Graph, const FAStarNodeTable& Nodes, int32 CellId, FGridCoord* OutDirections);
+
+	static void RetracePath(const FGridGraph& Graph, const FAStarNodeTable& Nodes, int32 StartId, int32 TargetId, std::vector<int32>& OutPath);
+};
@@ -0,0 +1,357 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "JumpPointTable.h"
+#include "GridGraph.h"
+#include <algorithm>
+#include <mutex>
+
+#if PATHFINDING_CORE_STANDALONE && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+	const int32 DirectionX[FJumpPointTable::NumDirections] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+	const int32 DirectionY[FJumpPointTable::NumDirections] = { 0, 0, 1, -1, 1, 1, -1, -1 };
+
+	/** Direction index by (DY + 1) * 3 + DX + 1 */
+	const int32 DirectionIndices[9] = { 7, 3, 6, 1, INDEX_NONE, 0, 5, 2, 4 };
+
+	const int32 FirstDiagonal = 4;
+
+	/** Only called with a word that has a bit set */
+	int32 CountLeadingZeros(uint64 Bits)
+	{
+#if !PATHFINDING_CORE_STANDALONE
+		return int32(FPlatformMath::CountLeadingZeros64(Bits));
+#elif defined(_MSC_VER)
+		unsigned long Index;
+		_BitScanReverse64(&Index, Bits);
+		return 63 - int32(Index);
+#else
+		return __builtin_clzll(Bits);
+#endif
+	}
+
+	int32 CountTrailingZeros(uint64 Bits)
+	{
+#if !PATHFINDING_CORE_STANDALONE
+		return int32(FPlatformMath::CountTrailingZeros64(Bits));
+#elif defined(_MSC_VER)
+		unsigned long Index;
+		_BitScanForward64(&Index, Bits);
+		return int32(Index);
+#else
+		return __builtin_ctzll(Bits);
+#endif
+	}
+
+	/** First set bit after Position, NumWords * 64 when there is none */
+	int32 FindNextStop(const uint64* Stops, int32 NumWords, int32 Position)
+	{
+		const int32 Next = Position + 1;
+		int32 Word = Next >> 6;
+		if (Word >= NumWords)
+		{
+			return NumWords * 64;
+		}
+
+		uint64 Bits = Stops[Word] & (~uint64(0) << (Next & 63));
+		while (Bits == 0)
+		{
+			if (++Word == NumWords)
+			{
+				return NumWords * 64;
+			}
+			Bits = Stops[Word];
+		}
+		return Word * 64 + CountTrailingZeros(Bits);
+	}
+
+	/** Last set bit before Position, INDEX_NONE when there is none */
+	int32 FindPreviousStop(const uint64* Stops, int32 Position)
+	{
+		if (Position == 0)
+		{
+			return INDEX_NONE;
+		}
+
+		const int32 Previous = Position - 1;
+		int32 Word = Previous >> 6;
+		uint64 Bits = Stops[Word] & (~uint64(0) >> (63 - (Previous & 63)));
+		while (Bits == 0)
+		{
+			if (--Word < 0)
+			{
+				return INDEX_NONE;
+			}
+			Bits = Stops[Word];
+		}
+		return Word * 64 + 63 - CountLeadingZeros(Bits);
+	}
+}
+
+FJumpPointTable::FJumpPointTable(FGridGraph& InGraph)
+	: Graph(InGraph)
+	, Width(0)
+	, Height(0)
+	, RowWords(0)
+	, ColumnWords(0)
+{
+}
+
+void FJumpPointTable::Build()
+{
+	std::unique_lock<std::shared_mutex> WriteLock(Lock);
+
+	Width = Graph.GetWidth();
+	Height = Graph.GetHeight();
+	check(Width <= MAX_int16 && Height <= MAX_int16);
+
+	RowWords = (Width + 63) / 64;
+	ColumnWords = (Height + 63) / 64;
+	RowBits.assign(size_t(Height) * RowWords, 0);
+	ColumnBits.assign(size_t(Width) * ColumnWords, 0);
+	for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+	{
+		if (Graph.IsWalkable(CellId))
+		{
+			SetWalkableBit(CellId % Width, CellId / Width, true);
+		}
+	}
+
+	Distances.assign(size_t(Graph.Num()) * NumDirections, 0);
+	for (int32 Y = 0; Y < Height; ++Y)
+	{
+		UpdateLine(false, Y, nullptr);
+	}
+	for (int32 X = 0; X < Width; ++X)
+	{
+		UpdateLine(true, X, nullptr);
+	}
+
+	// Rows are filled starting from the far end of each diagonal, so the next cell is always done first
+	for (int32 Direction = FirstDiagonal; Direction < NumDirections; ++Direction)
+	{
+		for (int32 Step = 0; Step < Height; ++Step)
+		{
+			const int32 Y = DirectionY[Direction] > 0 ? Height - 1 - Step : Step;
+			for (int32 X = 0; X < Width; ++X)
+			{
+				Distances[size_t(Y * Width + X) * NumDirections + Direction] = ComputeDiagonal(X, Y, Direction);
+			}
+		}
+	}
+}
+
+void FJumpPointTable::OnWalkabilityChanged(int32 CellId)
+{
+	std::unique_lock<std::shared_mutex> WriteLock(Lock);
+
+	const FGridCoord Coord = Graph.GetCoord(CellId);
+	const bool bWalkable = Graph.IsWalkable(CellId);
+	if (bWalkable == IsWalkable(Coord.X, Coord.Y))
+	{
+		return;
+	}
+	SetWalkableBit(Coord.X, Coord.Y, bWalkable);
+
+	// Forced neighbours are decided by the lines to either side, so the lines next to the cell are rescanned too
+	std::vector<int32> Changed;
+	for (int32 Offset = -1; Offset <= 1; ++Offset)
+	{
+		if (Coord.Y + Offset >= 0 && Coord.Y + Offset < Height)
+		{
+			UpdateLine(false, Coord.Y + Offset, &Changed);
+		}
+		if (Coord.X + Offset >= 0 && Coord.X + Offset < Width)
+		{
+			UpdateLine(true, Coord.X + Offset, &Changed);
+		}
+	}
+
+	// The cell is also a corner or the landing cell of the diagonal steps around it
+	for (int32 DY = -1; DY <= 1; ++DY)
+	{
+		for (int32 DX = -1; DX <= 1; ++DX)
+		{
+			if (Graph.IsValidCoord(Coord.X + DX, Coord.Y + DY))
+			{
+				Changed.push_back(Graph.GetCellId(Coord.X + DX, Coord.Y + DY));
+			}
+		}
+	}
+	UpdateDiagonals(Changed);
+}
+
+int32 FJumpPointTable::GetDistance(int32 CellId, int32 Direction) const
+{
+	std::shared_lock<std::shared_mutex> ReadLock(Lock);
+	return Distances[size_t(CellId) * NumDirections + Direction];
+}
+
+FGridCoord FJumpPointTable::GetDirection(int32 Direction)
+{
+	return FGridCoord(DirectionX[Direction], DirectionY[Direction]);
+}
+
+int32 FJumpPointTable::GetDirectionIndex(int32 DX, int32 DY)
+{
+	return DirectionIndices[(DY + 1) * 3 + DX + 1];
+}
+
+SIZE_T FJumpPointTable::GetAllocatedSize() const
+{
+	std::shared_lock<std::shared_mutex> ReadLock(Lock);
+	return (RowBits.capacity() + ColumnBits.capacity() + ForwardStops.capacity() + BackwardStops.capacity()) * sizeof(uint64) +
+		Distances.capacity() * sizeof(int16);
+}
+
+bool FJumpPointTable::IsWalkable(int32 X, int32 Y) const
+{
+	return X >= 0 && Y >= 0 && X < Width && Y < Height && ((RowBits[size_t(Y) * RowWords + (X >> 6)] >> (X & 63)) & 1);
+}
+
+void FJumpPointTable::SetWalkableBit(int32 X, int32 Y, bool bWalkable)
+{
+	uint64& RowWord = RowBits[size_t(Y) * RowWords + (X >> 6)];
+	uint64& ColumnWord = ColumnBits[size_t(X) * ColumnWords + (Y >> 6)];
+	const uint64 RowMask = uint64(1) << (X & 63);
+	const uint64 ColumnMask = uint64(1) << (Y & 63);
+	RowWord = bWalkable ? RowWord | RowMask : RowWord & ~RowMask;
+	ColumnWord = bWalkable ? ColumnWord | ColumnMask : ColumnWord & ~ColumnMask;
+}
+
+void FJumpPointTable::UpdateLine(bool bColumn, int32 Index, std::vector<int32>* OutChanged)
+{
+	const int32 Words = bColumn ? ColumnWords : RowWords;
+	const int32 Length = bColumn ? Height : Width;
+	const int32 NumLines = bColumn ? Width : Height;
+	const uint64* Line = (bColumn ? ColumnBits.data() : RowBits.data()) + size_t(Index) * Words;
+	const uint64* Sides[2] = { Index > 0 ? Line - Words : nullptr, Index + 1 < NumLines ? Line + Words : nullptr };
+
+	// Moving along the line, a cell is a jump point when the line beside it opens up right after being blocked.
+	// Blocked cells stop the scan both ways, and so does the padding past the end of the line
+	ForwardStops.resize(Words);
+	BackwardStops.resize(Words);
+	for (int32 Word = 0; Word < Words; ++Word)
+	{
+		uint64 Forward = 0;
+		uint64 Backward = 0;
+		for (const uint64* Side : Sides)
+		{
+			if (Side)
+			{
+				const uint64 Behind = (Side[Word] << 1) | (Word > 0 ? Side[Word - 1] >> 63 : 0);
+				const uint64 Ahead = (Side[Word] >> 1) | (Word + 1 < Words ? Side[Word + 1] << 63 : 0);
+				Forward |= Side[Word] & ~Behind;
+				Backward |= Side[Word] & ~Ahead;
+			}
+		}
+		ForwardStops[Word] = Forward | ~Line[Word];
+		BackwardStops[Word] = Backward | ~Line[Word];
+	}
+
+	const int32 FirstCell = bColumn ? Index : Index * Width;
+	const int32 CellStep = bColumn ? Width : 1;
+	const int32 ForwardDirection = bColumn ? 2 : 0;
+	auto Store = [this, FirstCell, CellStep, OutChanged](int32 Position, int32 Direction, int32 Distance)
+	{
+		const int32 CellId = FirstCell + Position * CellStep;
+		int16& Entry = Distances[size_t(CellId) * NumDirections + Direction];
+		if (Entry != Distance)
+		{
+			Entry = int16(Distance);
+			if (OutChanged)
+			{
+				OutChanged->push_back(CellId);
+			}
+		}
+	};
+	auto IsStopWalkable = [Line, Length](int32 Position)
+	{
+		return Position >= 0 && Position < Length && ((Line[Position >> 6] >> (Position & 63)) & 1);
+	};
+
+	// Every cell of a run between two stops shares the stop ahead of it, one bit scan per run
+	for (int32 Position = 0; Position < Length;)
+	{
+		const int32 Stop = std::min(FindNextStop(ForwardStops.data(), Words, Position), Length);
+		const bool bJumpPoint = IsStopWalkable(Stop);
+		for (; Position < Stop; ++Position)
+		{
+			Store(Position, ForwardDirection, bJumpPoint ? Stop - Position : Position + 1 - Stop);
+		}
+	}
+	for (int32 Position = Length - 1; Position >= 0;)
+	{
+		const int32 Stop = FindPreviousStop(BackwardStops.data(), Position);
+		const bool bJumpPoint = IsStopWalkable(Stop);
+		for (; Position > Stop; --Position)
+		{
+			Store(Position, ForwardDirection + 1, bJumpPoint ? Position - Stop : Stop + 1 - Position);
+		}
+	}
+}
+
+int16 FJumpPointTable::ComputeDiagonal(int32 X, int32 Y, int32 Direction) const
+{
+	// Diagonal steps can't squeeze past a blocked corner, same as the online search
+	const int32 DX = DirectionX[Direction];
+	const int32 DY = DirectionY[Direction];
+	if (!IsWalkable(X + DX, Y + DY) || !IsWalkable(X + DX, Y) || !IsWalkable(X, Y + DY))
+	{
+		return 0;
+	}
+
+	// A diagonal node is a jump point when one of its straight scans finds something
+	const int16* Next = &Distances[size_t((Y + DY) * Width + X + DX) * NumDirections];
+	if (Next[DX > 0 ? 0 : 1] > 0 || Next[DY > 0 ? 2 : 3] > 0)
+	{
+		return 1;
+	}
+	return Next[Direction] > 0 ? Next[Direction] + 1 : Next[Direction] - 1;
+}
+
+void FJumpPointTable::UpdateDiagonals(std::vector<int32>& Seeds)
+{
+	std::sort(Seeds.begin(), Seeds.end());
+	Seeds.erase(std::unique(Seeds.begin(), Seeds.end()), Seeds.end());
+
+	std::vector<FGridCoord> Starts;
+	Starts.reserve(Seeds.size());
+	for (int32 Direction = FirstDiagonal; Direction < NumDirections; ++Direction)
+	{
+		// A seed changes the distance of the cell one step before it, the walk back from there carries the change on
+		const int32 DX = DirectionX[Direction];
+		const int32 DY = DirectionY[Direction];
+		Starts.clear();
+		for (int32 SeedId : Seeds)
+		{
+			const FGridCoord Start(SeedId % Width - DX, SeedId / Width - DY);
+			if (Graph.IsValidCoord(Start.X, Start.Y))
+			{
+				Starts.push_back(Start);
+			}
+		}
+
+		// Cells further along the direction go first, so the cell every recomputed one reads from is already final
+		std::sort(Starts.begin(), Starts.end(), [DX, DY](const FGridCoord& A, const FGridCoord& B)
+		{
+			return DX * A.X + DY * A.Y > DX * B.X + DY * B.Y;
+		});
+		for (FGridCoord Cell : Starts)
+		{
+			for (; Graph.IsValidCoord(Cell.X, Cell.Y); Cell = Cell - FGridCoord(DX, DY))
+			{
+				int16& Entry = Distances[size_t(Cell.Y * Width + Cell.X) * NumDirections + Direction];
+				const int16 Distance = ComputeDiagonal(Cell.X, Cell.Y, Direction);
+				if (Distance == Entry)
+				{
+					break;
+				}
+				Entry = Distance;
+			}
+		}
+	}
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <shared_mutex>
+#include <vector>
+
+class FGridGraph;
+
+/**
+ * JPS+ preprocessing for FJumpPointSearch: for every cell and each of the 8 directions, how far the
+ * online search would jump before it finds a jump point or hits a wall, so a query reads one number
+ * instead of walking the line. Distances come from a copy of the walkability packed 64 cells to a word
+ * per row and per column, where the next wall or forced neighbour is one leading / trailing zero count away.
+ * A walkability change rescans the rows and columns next to the cell and follows the diagonal runs
+ * only as far back as their distances actually change, so the table keeps up with semi-dynamic maps.
+ * Safe to search from several threads while the owner of the graph reports changes.
+ */
+class INVADED_API FJumpPointTable
+{
+public:
+	/** Directions in table order: E, W, S, N, then SE, SW, NE, NW (Y grows south) */
+	static constexpr int32 NumDirections = 8;
+
+	explicit FJumpPointTable(FGridGraph& InGraph);
+
+	/** Computes every distance from scratch, the graph has to be a lattice under 32768 cells a side */
+	void Build();
+
+	/** Updates the distances after the walkability of the cell changed in the graph, does nothing when it didn't */
+	void OnWalkabilityChanged(int32 CellId);
+
+	/** Steps to the next jump point when positive, otherwise minus the steps that can be taken before a wall */
+	int32 GetDistance(int32 CellId, int32 Direction) const;
+
+	static FGridCoord GetDirection(int32 Direction);
+	static int32 GetDirectionIndex(int32 DX, int32 DY);
+
+	FGridGraph& GetGraph() const { return Graph; }
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	friend class FJumpPointSearch;
+
+	bool IsWalkable(int32 X, int32 Y) const;
+	void SetWalkableBit(int32 X, int32 Y, bool bWalkable);
+
+	/**
+	 * Recomputes the straight distances along one row (E / W) or column (S / N) from the packed bits of the
+	 * line and its two neighbours, appends the cells whose distances changed to OutChanged when given.
+	 */
+	void UpdateLine(bool bColumn, int32 Index, std::vector<int32>* OutChanged);
+
+	/** Diagonal distance of the cell from the straight distances of the next cell along the diagonal */
+	int16 ComputeDiagonal(int32 X, int32 Y, int32 Direction) const;
+
+	/** Recomputes the diagonal runs through the seed cells, back to where the distances stop changing */
+	void UpdateDiagonals(std::vector<int32>& Seeds);
+
+	FGridGraph& Graph;
+
+	mutable std::shared_mutex Lock;
+
+	int32 Width;
+	int32 Height;
+
+	/** Walkability, bit X of row Y at RowBits[Y * RowWords + X / 64] and bit Y of column X at ColumnBits[X * ColumnWords + Y / 64] */
+	int32 RowWords;
+	int32 ColumnWords;
+	std::vector<uint64> RowBits;
+	std::vector<uint64> ColumnBits;
+
+	/** NumDirections entries per cell id, so one expansion reads a single 16 byte block */
+	std::vector<int16> Distances;
+
+	/** Stop masks of the line being rescanned, kept to save the allocations */
+	std::vector<uint64> ForwardStops;
+	std::vector<uint64> BackwardStops;
+};
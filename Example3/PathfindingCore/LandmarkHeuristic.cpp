@@ -0,0 +1,296 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LandmarkHeuristic.h"
+#include "GridFile.h"
+#include "GridGraph.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <queue>
+
+namespace
+{
+	const uint32 FileMagic = 0x4D4C4650; // "PFLM"
+	const uint32 FileVersion = 1;
+
+	/** Seeds tried before the landmarks settle for the largest part of the grid found so far */
+	const int32 MaxSeedAttempts = 8;
+
+	struct FLandmarkFileHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		int32 Width;
+		int32 Height;
+		int32 NumLandmarks;
+		int32 Stride;
+		uint64 GraphHash;
+	};
+
+	/** Cheapest cost from SourceId to every cell over the moves the searches allow, MAX_int32 where it can't go */
+	void GetCostsFrom(const FGridGraph& Graph, const FEdgeCostSnapshot& EdgeCosts, int32 SourceId, std::vector<int32>& OutCosts)
+	{
+		typedef std::pair<int32, int32> FQueueEntry;
+		std::priority_queue<FQueueEntry, std::vector<FQueueEntry>, std::greater<FQueueEntry>> Queue;
+
+		OutCosts.assign(Graph.Num(), MAX_int32);
+		OutCosts[SourceId] = 0;
+		Queue.push(FQueueEntry(0, SourceId));
+		while (!Queue.empty())
+		{
+			const FQueueEntry Entry = Queue.top();
+			Queue.pop();
+			if (Entry.first > OutCosts[Entry.second])
+			{
+				continue;
+			}
+
+			for (int32 Edge = Graph.GetFirstEdge(Entry.second); Edge < Graph.GetEndEdge(Entry.second); ++Edge)
+			{
+				const int32 NeighbourId = Graph.GetEdgeTarget(Edge);
+				const int32 Cost = Entry.first + EdgeCosts[Edge];
+				if (Cost < OutCosts[NeighbourId] && Graph.IsWalkable(NeighbourId) && Graph.IsMoveAllowed(Entry.second, NeighbourId))
+				{
+					OutCosts[NeighbourId] = Cost;
+					Queue.push(FQueueEntry(Cost, NeighbourId));
+				}
+			}
+		}
+	}
+
+	void HashBytes(uint64& Hash, const void* Data, SIZE_T Size)
+	{
+		// FNV-1a
+		const uint8* Bytes = static_cast<const uint8*>(Data);
+		for (SIZE_T i = 0; i < Size; ++i)
+		{
+			Hash = (Hash ^ Bytes[i]) * 0x100000001B3ull;
+		}
+	}
+
+	template <typename ValueType>
+	void HashValue(uint64& Hash, const ValueType& Value)
+	{
+		HashBytes(Hash, &Value, sizeof(Value));
+	}
+}
+
+FLandmarkTable::FLandmarkTable()
+{
+	Width = 0;
+	Height = 0;
+	GraphHash = 0;
+	Stride = 0;
+	DistanceData = nullptr;
+}
+
+void FLandmarkTable::Build(const FGridGraph& Graph, int32 NumLandmarks)
+{
+	NumLandmarks = std::max(1, std::min(NumLandmarks, MaxLandmarks));
+
+	Width = Graph.GetWidth();
+	Height = Graph.GetHeight();
+	GraphHash = GetGraphHash(Graph);
+	Stride = (NumLandmarks + 3) & ~3;
+	Landmarks.clear();
+	Distances.assign(size_t(Graph.Num()) * Stride, 0);
+	DistanceData = Distances.data();
+
+	// Landmarks only cover the part of the grid their seed reaches, so a seed walled into a pocket is retried
+	// from cells spread over the grid until one reaches most of the walkable cells
+	int32 NumWalkable = 0;
+	for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+	{
+		NumWalkable += Graph.IsWalkable(CellId) ? 1 : 0;
+	}
+	if (NumWalkable == 0)
+	{
+		return;
+	}
+
+	const FEdgeCostSnapshot EdgeCosts = Graph.GetEdgeCosts();
+	std::vector<int32> Costs;
+	std::vector<int32> ClosestLandmarkCosts;
+	int32 BestReached = 0;
+	for (int32 Attempt = 0; Attempt < MaxSeedAttempts && BestReached * 2 <= NumWalkable; ++Attempt)
+	{
+		int32 SeedId = int32(int64(Graph.Num()) * Attempt / MaxSeedAttempts);
+		while (SeedId < Graph.Num() && !Graph.IsWalkable(SeedId))
+		{
+			++SeedId;
+		}
+		if (SeedId == Graph.Num())
+		{
+			continue;
+		}
+
+		GetCostsFrom(Graph, EdgeCosts, SeedId, Costs);
+		const int32 Reached = int32(std::count_if(Costs.begin(), Costs.end(), [](int32 Cost) { return Cost != MAX_int32; }));
+		if (Reached > BestReached)
+		{
+			BestReached = Reached;
+			ClosestLandmarkCosts.swap(Costs);
+		}
+	}
+
+	// The first landmark is the cell furthest from the seed, every next one the cell furthest from all before it
+	while (int32(Landmarks.size()) < NumLandmarks)
+	{
+		int32 LandmarkId = INDEX_NONE;
+		int32 BestCost = 0;
+		for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+		{
+			if (ClosestLandmarkCosts[CellId] != MAX_int32 && ClosestLandmarkCosts[CellId] > BestCost)
+			{
+				LandmarkId = CellId;
+				BestCost = ClosestLandmarkCosts[CellId];
+			}
+		}
+
+		// Every cell already sits on a landmark, more of them would tell nothing new
+		if (LandmarkId == INDEX_NONE)
+		{
+			break;
+		}
+
+		const int32 Column = int32(Landmarks.size());
+		Landmarks.push_back(LandmarkId);
+		GetCostsFrom(Graph, EdgeCosts, LandmarkId, Costs);
+		for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+		{
+			if (Costs[CellId] != MAX_int32)
+			{
+				Distances[size_t(CellId) * Stride + Column] = Costs[CellId];
+				ClosestLandmarkCosts[CellId] = Column == 0 ? Costs[CellId] : std::min(ClosestLandmarkCosts[CellId], Costs[CellId]);
+			}
+		}
+	}
+}
+
+bool FLandmarkTable::Save(const std::string& Filename) const
+{
+	std::ofstream File(Filename, std::ios::binary | std::ios::trunc);
+	if (!File)
+	{
+		return false;
+	}
+
+	FLandmarkFileHeader Header;
+	Header.Magic = FileMagic;
+	Header.Version = FileVersion;
+	Header.Width = Width;
+	Header.Height = Height;
+	Header.NumLandmarks = GetNumLandmarks();
+	Header.Stride = Stride;
+	Header.GraphHash = GraphHash;
+
+	File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+	File.write(reinterpret_cast<const char*>(Landmarks.data()), Landmarks.size() * sizeof(int32));
+	File.write(reinterpret_cast<const char*>(DistanceData), size_t(Width) * Height * Stride * sizeof(int32));
+	return bool(File);
+}
+
+bool FLandmarkTable::Load(const std::string& Filename, const FGridGraph& Graph)
+{
+	std::ifstream File(Filename, std::ios::binary);
+	if (!File)
+	{
+		return false;
+	}
+
+	FLandmarkFileHeader Header;
+	if (!File.read(reinterpret_cast<char*>(&Header), sizeof(Header))
+		|| Header.Magic != FileMagic || Header.Version != FileVersion
+		|| Header.Width != Graph.GetWidth() || Header.Height != Graph.GetHeight()
+		|| Header.NumLandmarks < 0 || Header.NumLandmarks > MaxLandmarks
+		|| Header.Stride < Header.NumLandmarks || Header.Stride > MaxLandmarks || Header.Stride % 4 != 0
+		|| Header.GraphHash != GetGraphHash(Graph))
+	{
+		return false;
+	}
+
+	std::vector<int32> NewLandmarks(Header.NumLandmarks);
+	std::vector<int32> NewDistances(size_t(Graph.Num()) * Header.Stride);
+	if (!File.read(reinterpret_cast<char*>(NewLandmarks.data()), NewLandmarks.size() * sizeof(int32))
+		|| !File.read(reinterpret_cast<char*>(NewDistances.data()), NewDistances.size() * sizeof(int32))
+		|| File.peek() != std::ifstream::traits_type::eof())
+	{
+		return false;
+	}
+
+	Width = Header.Width;
+	Height = Header.Height;
+	GraphHash = Header.GraphHash;
+	Stride = Header.Stride;
+	Landmarks.swap(NewLandmarks);
+	Distances.swap(NewDistances);
+	DistanceData = Distances.data();
+	return true;
+}
+
+bool FLandmarkTable::Attach(const FGridFile& File)
+{
+	if (File.GetNumLandmarks() == 0)
+	{
+		return false;
+	}
+
+	Width = File.GetWidth();
+	Height = File.GetHeight();
+	GraphHash = File.GetLandmarkGraphHash();
+	Stride = File.GetLandmarkStride();
+	Landmarks.assign(File.GetLandmarks(), File.GetLandmarks() + File.GetNumLandmarks());
+	std::vector<int32>().swap(Distances);
+	DistanceData = File.GetLandmarkDistances();
+	return true;
+}
+
+bool FLandmarkTable::Matches(const FGridGraph& Graph) const
+{
+	return Width == Graph.GetWidth() && Height == Graph.GetHeight() && GraphHash == GetGraphHash(Graph);
+}
+
+SIZE_T FLandmarkTable::GetAllocatedSize() const
+{
+	return Landmarks.capacity() * sizeof(int32) + Distances.capacity() * sizeof(int32);
+}
+
+uint64 FLandmarkTable::GetGraphHash(const FGridGraph& Graph)
+{
+	uint64 Hash = 0xCBF29CE484222325ull;
+	HashValue(Hash, Graph.GetWidth());
+	HashValue(Hash, Graph.GetHeight());
+	HashValue(Hash, Graph.GetStraightCost());
+	HashValue(Hash, Graph.GetDiagonalCost());
+	const FEdgeCostSnapshot EdgeCosts = Graph.GetEdgeCosts();
+	for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+	{
+		HashValue(Hash, uint8(Graph.IsWalkable(CellId)));
+		HashValue(Hash, Graph.GetEndEdge(CellId) - Graph.GetFirstEdge(CellId));
+		for (int32 Edge = Graph.GetFirstEdge(CellId); Edge < Graph.GetEndEdge(CellId); ++Edge)
+		{
+			HashValue(Hash, Graph.GetEdgeTarget(Edge));
+			HashValue(Hash, EdgeCosts[Edge]);
+		}
+	}
+	return Hash;
+}
+
+FLandmarkHeuristic::FLandmarkHeuristic(const FGridGraph& InGraph, const FLandmarkTable& InTable, int32 TargetId)
+	: Graph(InGraph)
+	, Table(InTable)
+	, Octile(InGraph, TargetId)
+	, TargetDistances(InTable.GetDistances(TargetId))
+{
+}
+
+void FLandmarkHeuristic::GetNeighbours(int32 CellId, int32* OutCosts) const
+{
+	Octile.GetNeighbours(CellId, OutCosts);
+
+	const int32 FirstEdge = Graph.GetFirstEdge(CellId);
+	for (int32 Edge = FirstEdge; Edge < Graph.GetEndEdge(CellId); ++Edge)
+	{
+		OutCosts[Edge - FirstEdge] = std::max(OutCosts[Edge - FirstEdge], GetLandmarkBound(Graph.GetEdgeTarget(Edge)));
+	}
+}
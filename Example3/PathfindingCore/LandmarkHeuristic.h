@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include "PathHeuristics.h"
+#include <string>
+#include <vector>
+
+class FGridFile;
+class FGridGraph;
+
+/**
+ * Exact shortest-path costs from a few landmark cells to every cell of a graph, for the ALT heuristic.
+ * Landmarks are picked far apart from each other (each one the cell furthest from the ones before it),
+ * so at least one of them usually sits behind the target as seen from any cell.
+ * Meant for maps whose walls don't move: blocking cells afterwards keeps the estimates admissible,
+ * opening a cell does not and the table has to be rebuilt.
+ */
+class INVADED_API FLandmarkTable
+{
+public:
+	/** Landmarks past this add memory and per-node work faster than they remove expansions */
+	static constexpr int32 MaxLandmarks = 32;
+
+	FLandmarkTable();
+
+	FLandmarkTable(const FLandmarkTable&) = delete;
+	FLandmarkTable& operator=(const FLandmarkTable&) = delete;
+
+	/** Runs one Dijkstra search per landmark over the walkable cells, the graph must have symmetric edges */
+	void Build(const FGridGraph& Graph, int32 NumLandmarks);
+
+	/** Writes the table to a binary file, false when the file can't be written */
+	bool Save(const std::string& Filename) const;
+
+	/** Reads a table written by Save, false when the file is missing or damaged or the graph changed since it was written */
+	bool Load(const std::string& Filename, const FGridGraph& Graph);
+
+	/**
+	 * Reads the distances of a grid file where they lie, false when the file has no landmarks. They were built for
+	 * the graph in the same file, see FGridGraph::Attach. The file's memory has to outlive the table or its next Build or Load.
+	 */
+	bool Attach(const FGridFile& File);
+
+	/** True when the table was built for a graph with this size, adjacency and walkability */
+	bool Matches(const FGridGraph& Graph) const;
+
+	int32 GetNumLandmarks() const { return int32(Landmarks.size()); }
+	int32 GetLandmark(int32 Index) const { return Landmarks[Index]; }
+
+	/**
+	 * Costs from every landmark to the cell, padded with zeros to GetStride entries.
+	 * Cells a landmark can't reach read zero, nothing connects them to its cells so any estimate is safe.
+	 */
+	const int32* GetDistances(int32 CellId) const { return DistanceData + size_t(CellId) * Stride; }
+
+	/** Entries per cell, the landmark count rounded up to whole heuristic lanes */
+	int32 GetStride() const { return Stride; }
+
+	/** Memory held by the table, an attached file's distances are not counted */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Hash of the size, step costs, adjacency and walkability of the graph */
+	static uint64 GetGraphHash(const FGridGraph& Graph);
+
+private:
+	int32 Width;
+	int32 Height;
+	uint64 GraphHash;
+
+	int32 Stride;
+	std::vector<int32> Landmarks;
+	std::vector<int32> Distances;
+
+	/** Distances, or the distances of an attached grid file */
+	const int32* DistanceData;
+};
+
+/**
+ * ALT estimate of the cost from grid cells to one target. By the triangle inequality the cost between two
+ * cells is at least the difference of their costs to any landmark, the largest difference over all
+ * landmarks bounds it from below much tighter than straight-line distances wherever walls force detours.
+ * Never lower than the octile estimate, admissible and consistent while the table matches the graph.
+ * Drop-in replacement for TGridHeuristic in FGridAStar::FindPathWithHeuristic.
+ */
+class INVADED_API FLandmarkHeuristic
+{
+public:
+	FLandmarkHeuristic(const FGridGraph& InGraph, const FLandmarkTable& InTable, int32 TargetId);
+
+	int32 Get(int32 CellId) const
+	{
+		return std::max(Octile.Get(CellId), GetLandmarkBound(CellId));
+	}
+
+	/** Writes the estimate of every edge target of the cell to OutCosts, in edge order */
+	void GetNeighbours(int32 CellId, int32* OutCosts) const;
+
+private:
+	int32 GetLandmarkBound(int32 CellId) const
+	{
+		const int32* CellDistances = Table.GetDistances(CellId);
+		FHeuristicLanes Bound = LanesSet1(0);
+		for (int32 Lane = 0; Lane < Table.GetStride(); Lane += 4)
+		{
+			Bound = LanesMax(Bound, LanesAbs(LanesSubtract(LanesLoadUnaligned(CellDistances + Lane), LanesLoadUnaligned(TargetDistances + Lane))));
+		}
+
+		alignas(16) int32 Bounds[4];
+		LanesStore(Bound, Bounds);
+		return std::max(std::max(Bounds[0], Bounds[1]), std::max(Bounds[2], Bounds[3]));
+	}
+
+	const FGridGraph& Graph;
+	const FLandmarkTable& Table;
+	TGridHeuristic<FOctileHeuristic> Octile;
+	const int32* TargetDistances;
+};
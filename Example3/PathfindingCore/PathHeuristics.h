@@ -0,0 +1,262 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include "GridGraph.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define PATHFINDING_CORE_SSE4 1
+#include <smmintrin.h>
+#else
+#define PATHFINDING_CORE_SSE4 0
+#endif
+
+/** Four int32 lanes, an SSE register where SSE4.1 is available and a plain array the compiler may vectorize otherwise */
+#if PATHFINDING_CORE_SSE4
+typedef __m128i FHeuristicLanes;
+
+inline FHeuristicLanes LanesSet1(int32 Value) { return _mm_set1_epi32(Value); }
+inline FHeuristicLanes LanesLoad(const int32* Values) { return _mm_load_si128(reinterpret_cast<const __m128i*>(Values)); }
+inline FHeuristicLanes LanesLoadUnaligned(const int32* Values) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(Values)); }
+inline void LanesStore(const FHeuristicLanes& Lanes, int32* OutValues) { _mm_store_si128(reinterpret_cast<__m128i*>(OutValues), Lanes); }
+inline FHeuristicLanes LanesAdd(const FHeuristicLanes& A, const FHeuristicLanes& B) { return _mm_add_epi32(A, B); }
+inline FHeuristicLanes LanesSubtract(const FHeuristicLanes& A, const FHeuristicLanes& B) { return _mm_sub_epi32(A, B); }
+inline FHeuristicLanes LanesMultiply(const FHeuristicLanes& A, const FHeuristicLanes& B) { return _mm_mullo_epi32(A, B); }
+inline FHeuristicLanes LanesMin(const FHeuristicLanes& A, const FHeuristicLanes& B) { return _mm_min_epi32(A, B); }
+inline FHeuristicLanes LanesMax(const FHeuristicLanes& A, const FHeuristicLanes& B) { return _mm_max_epi32(A, B); }
+inline FHeuristicLanes LanesAbs(const FHeuristicLanes& A) { return _mm_abs_epi32(A); }
+#else
+struct FHeuristicLanes
+{
+	int32 V[4];
+};
+
+inline FHeuristicLanes LanesSet1(int32 Value) { return FHeuristicLanes{ { Value, Value, Value, Value } }; }
+inline FHeuristicLanes LanesLoad(const int32* Values) { FHeuristicLanes Lanes; std::memcpy(Lanes.V, Values, sizeof(Lanes.V)); return Lanes; }
+inline FHeuristicLanes LanesLoadUnaligned(const int32* Values) { return LanesLoad(Values); }
+inline void LanesStore(const FHeuristicLanes& Lanes, int32* OutValues) { std::memcpy(OutValues, Lanes.V, sizeof(Lanes.V)); }
+
+#define PATHFINDING_CORE_LANES_OP(Name, Expression) \
+	inline FHeuristicLanes Name(const FHeuristicLanes& A, const FHeuristicLanes& B) \
+	{ \
+		FHeuristicLanes Result; \
+		for (int32 i = 0; i < 4; ++i) \
+		{ \
+			Result.V[i] = Expression; \
+		} \
+		return Result; \
+	}
+PATHFINDING_CORE_LANES_OP(LanesAdd, A.V[i] + B.V[i])
+PATHFINDING_CORE_LANES_OP(LanesSubtract, A.V[i] - B.V[i])
+PATHFINDING_CORE_LANES_OP(LanesMultiply, A.V[i] * B.V[i])
+PATHFINDING_CORE_LANES_OP(LanesMin, std::min(A.V[i], B.V[i]))
+PATHFINDING_CORE_LANES_OP(LanesMax, std::max(A.V[i], B.V[i]))
+#undef PATHFINDING_CORE_LANES_OP
+
+inline FHeuristicLanes LanesAbs(const FHeuristicLanes& A) { return FHeuristicLanes{ { std::abs(A.V[0]), std::abs(A.V[1]), std::abs(A.V[2]), std::abs(A.V[3]) } }; }
+#endif
+
+/**
+ * Heuristic policies for the grid searches, picked at compile time.
+ * A policy turns the absolute X / Y steps to the target into a cost in the units of the grid step costs,
+ * either for one cell or for four cells at once.
+ */
+struct FOctileHeuristic
+{
+	/** Exact on an empty 8-connected grid, admissible and consistent with the FGridGraph step costs */
+	static int32 Get(int32 DX, int32 DY, int32 StraightCost, int32 DiagonalCost)
+	{
+		const int32 MinDelta = std::min(DX, DY);
+		return DiagonalCost * MinDelta + StraightCost * (std::max(DX, DY) - MinDelta);
+	}
+
+	static FHeuristicLanes Get(const FHeuristicLanes& DX, const FHeuristicLanes& DY, const FHeuristicLanes& StraightCost, const FHeuristicLanes& DiagonalCost)
+	{
+		const FHeuristicLanes MinDelta = LanesMin(DX, DY);
+		return LanesAdd(LanesMultiply(DiagonalCost, MinDelta), LanesMultiply(StraightCost, LanesSubtract(LanesMax(DX, DY), MinDelta)));
+	}
+};
+
+/** Ignores diagonal steps, so on 8-connected grids it overestimates and trades optimal paths for fewer expansions */
+struct FManhattanHeuristic
+{
+	static int32 Get(int32 DX, int32 DY, int32 StraightCost, int32 /*DiagonalCost*/)
+	{
+		return StraightCost * (DX + DY);
+	}
+
+	static FHeuristicLanes Get(const FHeuristicLanes& DX, const FHeuristicLanes& DY, const FHeuristicLanes& StraightCost, const FHeuristicLanes& /*DiagonalCost*/)
+	{
+		return LanesMultiply(StraightCost, LanesAdd(DX, DY));
+	}
+};
+
+/** Estimates the cost from grid cells to one target using the given policy */
+template <typename PolicyType>
+class TGridHeuristic
+{
+public:
+	TGridHeuristic(const FGridGraph& InGraph, int32 TargetId)
+		: Graph(InGraph)
+		, Target(InGraph.GetCoord(TargetId))
+	{
+	}
+
+	int32 Get(int32 CellId) const
+	{
+		const FGridCoord Coord = Graph.GetCoord(CellId);
+		return PolicyType::Get(std::abs(Coord.X - Target.X), std::abs(Coord.Y - Target.Y), Graph.GetStraightCost(), Graph.GetDiagonalCost());
+	}
+
+	/** Writes the estimate of every edge target of the cell to OutCosts, in edge order and four edges per vector op */
+	void GetNeighbours(int32 CellId, int32* OutCosts) const
+	{
+		const FGridCoord Coord = Graph.GetCoord(CellId);
+		const int32 FirstEdge = Graph.GetFirstEdge(CellId);
+		const int32 NumEdges = Graph.GetEndEdge(CellId) - FirstEdge;
+
+		const FHeuristicLanes OffsetX = LanesSet1(Coord.X - Target.X);
+		const FHeuristicLanes OffsetY = LanesSet1(Coord.Y - Target.Y);
+		const FHeuristicLanes StraightCost = LanesSet1(Graph.GetStraightCost());
+		const FHeuristicLanes DiagonalCost = LanesSet1(Graph.GetDiagonalCost());
+
+		for (int32 Lane = 0; Lane < NumEdges; Lane += 4)
+		{
+			const int32 NumLanes = std::min(4, NumEdges - Lane);
+
+			alignas(16) int32 StepX[4] = { 0, 0, 0, 0 };
+			alignas(16) int32 StepY[4] = { 0, 0, 0, 0 };
+			for (int32 i = 0; i < NumLanes; ++i)
+			{
+				const FGridCoord Delta = Graph.GetEdgeDelta(FirstEdge + Lane + i);
+				StepX[i] = Delta.X;
+				StepY[i] = Delta.Y;
+			}
+
+			const FHeuristicLanes DX = LanesAbs(LanesAdd(OffsetX, LanesLoad(StepX)));
+			const FHeuristicLanes DY = LanesAbs(LanesAdd(OffsetY, LanesLoad(StepY)));
+
+			alignas(16) int32 Costs[4];
+			LanesStore(PolicyType::Get(DX, DY, StraightCost, DiagonalCost), Costs);
+			std::memcpy(OutCosts + Lane, Costs, NumLanes * sizeof(int32));
+		}
+	}
+
+private:
+	const FGridGraph& Graph;
+	FGridCoord Target;
+};
+
+/**
+ * Estimates the cost from grid cells to the nearest of several targets, the minimum over
+ * the single target estimates, four targets per vector op. Stays consistent when the policy is.
+ */
+template <typename PolicyType>
+class TNearestTargetHeuristic
+{
+public:
+	TNearestTargetHeuristic(const FGridGraph& InGraph, const std::vector<int32>& TargetIds)
+		: Graph(InGraph)
+	{
+		// Padding repeats the first target, which leaves the minimum alone
+		const size_t NumPadded = (TargetIds.size() + 3) & ~size_t(3);
+		TargetX.reserve(NumPadded);
+		TargetY.reserve(NumPadded);
+		for (size_t Index = 0; Index < NumPadded; ++Index)
+		{
+			const FGridCoord Target = InGraph.GetCoord(TargetIds[Index < TargetIds.size() ? Index : 0]);
+			TargetX.push_back(Target.X);
+			TargetY.push_back(Target.Y);
+		}
+	}
+
+	int32 Get(int32 CellId) const
+	{
+		return GetNearest(Graph.GetCoord(CellId));
+	}
+
+	/** Writes the estimate of every edge target of the cell to OutCosts, in edge order */
+	void GetNeighbours(int32 CellId, int32* OutCosts) const
+	{
+		const FGridCoord Coord = Graph.GetCoord(CellId);
+		for (int32 Edge = Graph.GetFirstEdge(CellId); Edge < Graph.GetEndEdge(CellId); ++Edge)
+		{
+			*OutCosts++ = GetNearest(Coord + Graph.GetEdgeDelta(Edge));
+		}
+	}
+
+private:
+	int32 GetNearest(const FGridCoord& Coord) const
+	{
+		const FHeuristicLanes X = LanesSet1(Coord.X);
+		const FHeuristicLanes Y = LanesSet1(Coord.Y);
+		const FHeuristicLanes StraightCost = LanesSet1(Graph.GetStraightCost());
+		const FHeuristicLanes DiagonalCost = LanesSet1(Graph.GetDiagonalCost());
+
+		FHeuristicLanes Nearest = LanesSet1(MAX_int32);
+		for (size_t Index = 0; Index < TargetX.size(); Index += 4)
+		{
+			const FHeuristicLanes DX = LanesAbs(LanesSubtract(X, LanesLoadUnaligned(&TargetX[Index])));
+			const FHeuristicLanes DY = LanesAbs(LanesSubtract(Y, LanesLoadUnaligned(&TargetY[Index])));
+			Nearest = LanesMin(Nearest, PolicyType::Get(DX, DY, StraightCost, DiagonalCost));
+		}
+
+		alignas(16) int32 Costs[4];
+		LanesStore(Nearest, Costs);
+		return std::min(std::min(Costs[0], Costs[1]), std::min(Costs[2], Costs[3]));
+	}
+
+	const FGridGraph& Graph;
+	std::vector<int32> TargetX;
+	std::vector<int32> TargetY;
+};
+
+/**
+ * Inflates another estimate by a constant weight for weighted A*. With a consistent inner estimate and
+ * closed nodes never reopened, paths cost at most Weight times the optimal ones.
+ */
+template <typename HeuristicType>
+class TWeightedHeuristic
+{
+public:
+	/** Far past the point where the search is greedy already, larger weights are clamped to keep costs in range */
+	static constexpr int32 MaxWeight = 64;
+
+	TWeightedHeuristic(const FGridGraph& InGraph, const HeuristicType& InInner, float Weight)
+		: Graph(InGraph)
+		, Inner(InInner)
+		, FixedWeight(int64(std::min(double(Weight), double(MaxWeight)) * 65536.0))
+	{
+	}
+
+	int32 Get(int32 CellId) const
+	{
+		return Scale(Inner.Get(CellId));
+	}
+
+	void GetNeighbours(int32 CellId, int32* OutCosts) const
+	{
+		Inner.GetNeighbours(CellId, OutCosts);
+		const int32 NumEdges = Graph.GetEndEdge(CellId) - Graph.GetFirstEdge(CellId);
+		for (int32 Index = 0; Index < NumEdges; ++Index)
+		{
+			OutCosts[Index] = Scale(OutCosts[Index]);
+		}
+	}
+
+private:
+	/** 16.16 fixed point rounded down, so the effective weight never exceeds the requested one. Capped so f costs can't overflow. */
+	int32 Scale(int32 Cost) const
+	{
+		return int32(std::min((int64(Cost) * FixedWeight) >> 16, int64(MAX_int32 / 2)));
+	}
+
+	const FGridGraph& Graph;
+	const HeuristicType& Inner;
+	int64 FixedWeight;
+};
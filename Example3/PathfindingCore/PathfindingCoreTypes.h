@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * Everything under PathfindingCore works on integer cell ids and only uses the C++ standard library,
+ * so it builds inside the engine module and as a standalone library (see CMakeLists.txt, which defines
+ * PATHFINDING_CORE_STANDALONE). Outside the engine this header provides the few engine basics the
+ * code relies on; inside it they come from CoreMinimal.h.
+ */
+#if PATHFINDING_CORE_STANDALONE
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+typedef std::int8_t int8;
+typedef std::int16_t int16;
+typedef std::int32_t int32;
+typedef std::int64_t int64;
+typedef std::uint8_t uint8;
+typedef std::uint16_t uint16;
+typedef std::uint32_t uint32;
+typedef std::uint64_t uint64;
+typedef std::size_t SIZE_T;
+
+#define INDEX_NONE (-1)
+#define MAX_int8 ((int8)0x7f)
+#define MAX_int16 ((int16)0x7fff)
+#define MAX_int32 ((int32)0x7fffffff)
+#define MAX_uint8 ((uint8)0xff)
+#define MAX_uint16 ((uint16)0xffff)
+
+#define check(Expression) assert(Expression)
+
+#define INVADED_API
+
+#else
+
+#include "CoreMinimal.h"
+
+#endif
+
+#include <atomic>
+
+/** Search algorithm used to answer a path query */
+enum class EPathSearchMode : uint8
+{
+	/** Plain A* over the cell neighbours */
+	AStar,
+	/** Jump Point Search, for uniform-cost grids */
+	JumpPoint,
+	/** HPA* over precomputed clusters, near-optimal paths for long queries */
+	Hierarchical,
+	/** Theta*, paths hold only the turning points and run in straight lines between them */
+	AnyAngle,
+	/** JPS+, Jump Point Search over precomputed jump distances, for uniform-cost grids */
+	JumpPointPlus,
+	/** Weighted A*, paths within a requested factor of optimal for fewer expansions */
+	WeightedAStar,
+	/** Focal search (A*epsilon), the same bound as WeightedAStar with paths usually closer to optimal */
+	Focal,
+};
+
+/** Cell position on the grid lattice */
+struct FGridCoord
+{
+	int32 X;
+	int32 Y;
+
+	FGridCoord() : X(0), Y(0) {}
+	FGridCoord(int32 InX, int32 InY) : X(InX), Y(InY) {}
+
+	FGridCoord operator+(const FGridCoord& Other) const { return FGridCoord(X + Other.X, Y + Other.Y); }
+	FGridCoord operator-(const FGridCoord& Other) const { return FGridCoord(X - Other.X, Y - Other.Y); }
+	bool operator==(const FGridCoord& Other) const { return X == Other.X && Y == Other.Y; }
+	bool operator!=(const FGridCoord& Other) const { return !(*this == Other); }
+};
+
+/**
+ * Lets the owner of a query stop the search answering it.
+ * Searches poll it between expansions and return an empty path once it is cancelled.
+ */
+class FPathCancellationToken
+{
+public:
+	FPathCancellationToken() : bCancelled(false) {}
+
+	void Cancel() { bCancelled.store(true); }
+	bool IsCancelled() const { return bCancelled.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<bool> bCancelled;
+};
+
+/** Work done by one search, filled in when the caller passes one in */
+struct FPathSearchStats
+{
+	int32 NodesExpanded;
+	int32 NodesGenerated;
+
+	/** Nodes added to the open list and lowered in it, every one is a sift through the heap */
+	int32 HeapPushes;
+	int32 HeapPops;
+
+	/** Edges or jump directions looked at from the expanded nodes, blocked and closed ones included */
+	int32 NeighboursEvaluated;
+
+	FPathSearchStats() : NodesExpanded(0), NodesGenerated(0), HeapPushes(0), HeapPops(0), NeighboursEvaluated(0) {}
+};
@@ -0,0 +1,1255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Standalone checks for the pathfinding core, built by CMakeLists.txt only.
+#if PATHFINDING_CORE_STANDALONE
+
+#include "FocalSearch.h"
+#include "GridAStar.h"
+#include "GridBenchmark.h"
+#include "GridComponents.h"
+#include "GridFile.h"
+#include "GridFlowField.h"
+#include "GridGraph.h"
+#include "HierarchicalPathfinder.h"
+#include "JumpPointSearch.h"
+#include "JumpPointTable.h"
+#include "LandmarkHeuristic.h"
+#include "AStarNodeTable.h"
+#include "PathHeuristics.h"
+#include "ThetaStar.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	int32 NumFailures = 0;
+
+	#define CORE_TEST_CHECK(Expression) \
+		do \
+		{ \
+			if (!(Expression)) \
+			{ \
+				std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Expression); \
+				++NumFailures; \
+			} \
+		} while (0)
+
+	/** Reference costs from every cell to TargetId, no heuristic and no shared code with the searches under test */
+	std::vector<int32> GetDijkstraCosts(const FGridGraph& Graph, int32 TargetId)
+	{
+		typedef std::pair<int32, int32> FEntry;
+		std::vector<int32> Costs(Graph.Num(), MAX_int32);
+		std::priority_queue<FEntry, std::vector<FEntry>, std::greater<FEntry>> Open;
+		if (!Graph.IsWalkable(TargetId))
+		{
+			return Costs;
+		}
+
+		const FEdgeCostSnapshot EdgeCosts = Graph.GetEdgeCosts();
+		Costs[TargetId] = 0;
+		Open.push(FEntry(0, TargetId));
+		while (!Open.empty())
+		{
+			const FEntry Entry = Open.top();
+			Open.pop();
+			if (Entry.first != Costs[Entry.second])
+			{
+				continue;
+			}
+			for (int32 Edge = Graph.GetFirstEdge(Entry.second); Edge < Graph.GetEndEdge(Entry.second); ++Edge)
+			{
+				const int32 Neighbour = Graph.GetEdgeTarget(Edge);
+				if (Graph.IsWalkable(Neighbour) && Graph.IsMoveAllowed(Neighbour, Entry.second) && Entry.first + EdgeCosts[Edge] < Costs[Neighbour])
+				{
+					Costs[Neighbour] = Entry.first + EdgeCosts[Edge];
+					Open.push(FEntry(Costs[Neighbour], Neighbour));
+				}
+			}
+		}
+		return Costs;
+	}
+
+	/** Cost of the path in graph units, negative when a step is not a legal move */
+	int32 GetPathCost(const FGridGraph& Graph, int32 StartId, const std::vector<int32>& Path)
+	{
+		int32 Cost = 0;
+		int32 PreviousId = StartId;
+		for (int32 CellId : Path)
+		{
+			const FGridCoord Delta = Graph.GetCoord(CellId) - Graph.GetCoord(PreviousId);
+			if (std::abs(Delta.X) > 1 || std::abs(Delta.Y) > 1 || !Graph.IsWalkable(CellId) || !Graph.IsMoveAllowed(PreviousId, CellId))
+			{
+				return -1;
+			}
+			Cost += Delta.X != 0 && Delta.Y != 0 ? Graph.GetDiagonalCost() : Graph.GetStraightCost();
+			PreviousId = CellId;
+		}
+		return Cost;
+	}
+
+	/** Like GetPathCost but sums the graph's own step costs, for graphs with cell costs */
+	int32 GetWeightedPathCost(const FGridGraph& Graph, int32 StartId, const std::vector<int32>& Path)
+	{
+		const FEdgeCostSnapshot EdgeCosts = Graph.GetEdgeCosts();
+		int32 Cost = 0;
+		int32 PreviousId = StartId;
+		for (int32 CellId : Path)
+		{
+			int32 StepCost = -1;
+			for (int32 Edge = Graph.GetFirstEdge(PreviousId); Edge < Graph.GetEndEdge(PreviousId); ++Edge)
+			{
+				if (Graph.GetEdgeTarget(Edge) == CellId)
+				{
+					StepCost = EdgeCosts[Edge];
+				}
+			}
+			if (StepCost < 0 || !Graph.IsWalkable(CellId) || !Graph.IsMoveAllowed(PreviousId, CellId))
+			{
+				return -1;
+			}
+			Cost += StepCost;
+			PreviousId = CellId;
+		}
+		return Cost;
+	}
+
+	void BuildRandomGraph(FGridGraph& Graph, int32 Width, int32 Height, float BlockedChance, uint32 Seed)
+	{
+		std::mt19937 Random(Seed);
+		std::uniform_real_distribution<float> Distribution(0.0f, 1.0f);
+		std::vector<bool> Walkable(Width * Height);
+		for (int32 CellId = 0; CellId < Width * Height; ++CellId)
+		{
+			Walkable[CellId] = Distribution(Random) >= BlockedChance;
+		}
+		Graph.BuildLattice(Width, Height, Walkable, 10, 14);
+	}
+
+	/** Searches may leave a blocked start cell, so queries only pick walkable endpoints to keep the reference simple */
+	int32 GetRandomWalkableCell(const FGridGraph& Graph, std::mt19937& Random)
+	{
+		int32 CellId;
+		do
+		{
+			CellId = Random() % Graph.Num();
+		} while (!Graph.IsWalkable(CellId));
+		return CellId;
+	}
+
+	/** Optimal searches have to match Dijkstra, HPA* has to find a valid path whenever one exists */
+	void TestSearchesAgainstDijkstra()
+	{
+		for (uint32 Seed = 1; Seed <= 6; ++Seed)
+		{
+			FGridGraph Graph;
+			BuildRandomGraph(Graph, 37 + Seed * 3, 29 + Seed * 2, 0.1f * (Seed % 4), Seed);
+
+			FHierarchicalPathfinder Hierarchy(Graph, 8);
+			Hierarchy.Build();
+
+			std::mt19937 Random(Seed * 7919);
+			std::vector<int32> Path;
+			for (int32 Query = 0; Query < 40; ++Query)
+			{
+				const int32 StartId = GetRandomWalkableCell(Graph, Random);
+				const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+				const std::vector<int32> Costs = GetDijkstraCosts(Graph, TargetId);
+				const bool bReachable = Costs[StartId] != MAX_int32;
+
+				const bool bAStar = FGridAStar::FindPath<FOctileHeuristic>(Graph, StartId, TargetId, Path);
+				CORE_TEST_CHECK(bAStar == bReachable);
+				if (bAStar && bReachable)
+				{
+					CORE_TEST_CHECK(GetPathCost(Graph, StartId, Path) == Costs[StartId]);
+				}
+
+				const bool bJumpPoint = FJumpPointSearch::FindPath(Graph, StartId, TargetId, Path);
+				CORE_TEST_CHECK(bJumpPoint == bReachable);
+				if (bJumpPoint && bReachable)
+				{
+					CORE_TEST_CHECK(GetPathCost(Graph, StartId, Path) == Costs[StartId]);
+				}
+
+				const bool bHierarchical = Hierarchy.FindPath(StartId, TargetId, Path);
+				CORE_TEST_CHECK(bHierarchical == bReachable);
+				if (bHierarchical && bReachable)
+				{
+					CORE_TEST_CHECK(GetPathCost(Graph, StartId, Path) >= Costs[StartId]);
+				}
+			}
+		}
+	}
+
+	/** The inadmissible heuristic still has to return legal paths to the right cell */
+	void TestManhattanPathsAreValid()
+	{
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 48, 48, 0.25f, 11);
+
+		std::mt19937 Random(5);
+		std::vector<int32> Path;
+		for (int32 Query = 0; Query < 50; ++Query)
+		{
+			const int32 StartId = GetRandomWalkableCell(Graph, Random);
+			const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+			const std::vector<int32> Costs = GetDijkstraCosts(Graph, TargetId);
+			const bool bReachable = Costs[StartId] != MAX_int32;
+
+			const bool bFound = FGridAStar::FindPath<FManhattanHeuristic>(Graph, StartId, TargetId, Path);
+			CORE_TEST_CHECK(bFound == bReachable);
+			if (bFound && StartId != TargetId)
+			{
+				CORE_TEST_CHECK(GetPathCost(Graph, StartId, Path) >= Costs[StartId]);
+				CORE_TEST_CHECK(Path.back() == TargetId);
+			}
+		}
+	}
+
+	/** The four-lane estimates have to agree with the scalar ones for every edge */
+	void TestHeuristicLanesMatchScalar()
+	{
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 20, 17, 0.0f, 3);
+
+		std::vector<int32> Costs(Graph.GetMaxEdges());
+		for (int32 TargetId = 0; TargetId < Graph.Num(); TargetId += 7)
+		{
+			const TGridHeuristic<FOctileHeuristic> Octile(Graph, TargetId);
+			const TGridHeuristic<FManhattanHeuristic> Manhattan(Graph, TargetId);
+			for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+			{
+				Octile.GetNeighbours(CellId, Costs.data());
+				for (int32 Edge = Graph.GetFirstEdge(CellId); Edge < Graph.GetEndEdge(CellId); ++Edge)
+				{
+					CORE_TEST_CHECK(Costs[Edge - Graph.GetFirstEdge(CellId)] == Octile.Get(Graph.GetEdgeTarget(Edge)));
+				}
+
+				Manhattan.GetNeighbours(CellId, Costs.data());
+				for (int32 Edge = Graph.GetFirstEdge(CellId); Edge < Graph.GetEndEdge(CellId); ++Edge)
+				{
+					CORE_TEST_CHECK(Costs[Edge - Graph.GetFirstEdge(CellId)] == Manhattan.Get(Graph.GetEdgeTarget(Edge)));
+				}
+			}
+		}
+	}
+
+	double GetEuclideanLength(const FGridGraph& Graph, int32 StartId, const std::vector<int32>& Path)
+	{
+		double Length = 0.0;
+		int32 PreviousId = StartId;
+		for (int32 CellId : Path)
+		{
+			const FGridCoord Delta = Graph.GetCoord(CellId) - Graph.GetCoord(PreviousId);
+			Length += std::sqrt(double(Delta.X) * Delta.X + double(Delta.Y) * Delta.Y);
+			PreviousId = CellId;
+		}
+		return Length;
+	}
+
+	/** Segments see through open cells but not through a blocked cell or between two diagonal blocked cells */
+	void TestLineOfSight()
+	{
+		std::vector<bool> Walkable(5 * 5, true);
+		FGridGraph Graph;
+		Graph.BuildLattice(5, 5, Walkable, 10, 14);
+		CORE_TEST_CHECK(FThetaStar::HasLineOfSight(Graph, Graph.GetCellId(0, 0), Graph.GetCellId(4, 3)));
+
+		std::vector<int32> Crossed;
+		FThetaStar::GetCrossedCells(Graph, Graph.GetCellId(0, 0), Graph.GetCellId(2, 1), Crossed);
+		CORE_TEST_CHECK(Crossed == std::vector<int32>({ Graph.GetCellId(1, 0), Graph.GetCellId(1, 1), Graph.GetCellId(2, 1) }));
+
+		Crossed.clear();
+		FThetaStar::GetCrossedCells(Graph, Graph.GetCellId(3, 3), Graph.GetCellId(1, 1), Crossed);
+		CORE_TEST_CHECK(Crossed.size() == 6 && Crossed.back() == Graph.GetCellId(1, 1));
+
+		Graph.SetWalkable(Graph.GetCellId(2, 1), false);
+		CORE_TEST_CHECK(!FThetaStar::HasLineOfSight(Graph, Graph.GetCellId(0, 0), Graph.GetCellId(4, 2)));
+		CORE_TEST_CHECK(FThetaStar::HasLineOfSight(Graph, Graph.GetCellId(0, 0), Graph.GetCellId(1, 4)));
+
+		// The diagonal passes exactly through the corner of (2, 1), which cuts it like a diagonal step would
+		CORE_TEST_CHECK(!FThetaStar::HasLineOfSight(Graph, Graph.GetCellId(1, 1), Graph.GetCellId(3, 3)));
+	}
+
+	/** Any-angle paths are walkable segment by segment, have fewer points and are no longer than the 8-connected ones */
+	void TestAnyAnglePaths()
+	{
+		for (uint32 Seed = 1; Seed <= 4; ++Seed)
+		{
+			FGridGraph Graph;
+			BuildRandomGraph(Graph, 50, 40, 0.08f * Seed, Seed + 100);
+
+			std::mt19937 Random(Seed);
+			std::vector<int32> Path;
+			std::vector<int32> GridPath;
+			for (int32 Query = 0; Query < 40; ++Query)
+			{
+				const int32 StartId = GetRandomWalkableCell(Graph, Random);
+				const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+				const bool bGridFound = FGridAStar::FindPath<FOctileHeuristic>(Graph, StartId, TargetId, GridPath);
+				const bool bFound = FThetaStar::FindPath(Graph, StartId, TargetId, Path);
+				CORE_TEST_CHECK(bFound == bGridFound);
+				if (!bFound || StartId == TargetId)
+				{
+					continue;
+				}
+
+				CORE_TEST_CHECK(Path.back() == TargetId);
+				CORE_TEST_CHECK(Path.size() <= GridPath.size());
+				CORE_TEST_CHECK(GetEuclideanLength(Graph, StartId, Path) <= GetEuclideanLength(Graph, StartId, GridPath) * 1.001);
+
+				int32 PreviousId = StartId;
+				for (int32 CellId : Path)
+				{
+					CORE_TEST_CHECK(FThetaStar::HasLineOfSight(Graph, PreviousId, CellId));
+					PreviousId = CellId;
+				}
+			}
+		}
+	}
+
+	/** A search cancelled before it starts returns nothing */
+	void TestCancellation()
+	{
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 64, 64, 0.0f, 1);
+
+		FPathCancellationToken Cancellation;
+		Cancellation.Cancel();
+
+		std::vector<int32> Path;
+		CORE_TEST_CHECK(!FGridAStar::FindPath<FOctileHeuristic>(Graph, 0, Graph.Num() - 1, Path, &Cancellation));
+		CORE_TEST_CHECK(Path.empty());
+		CORE_TEST_CHECK(!FJumpPointSearch::FindPath(Graph, 0, Graph.Num() - 1, Path, &Cancellation));
+		CORE_TEST_CHECK(Path.empty());
+		CORE_TEST_CHECK(!FThetaStar::FindPath(Graph, 0, Graph.Num() - 1, Path, &Cancellation));
+		CORE_TEST_CHECK(Path.empty());
+	}
+
+	/** Bumping the generation forgets the previous query without clearing the arrays */
+	void TestNodeTableReuse()
+	{
+		FAStarNodeTable Nodes;
+		Nodes.Reset(16);
+		Nodes.Visit(3);
+		Nodes.SetGCost(3, 42);
+		Nodes.Close(3);
+		CORE_TEST_CHECK(Nodes.IsClosed(3));
+		CORE_TEST_CHECK(Nodes.GetGCost(3) == 42);
+
+		Nodes.Reset(16);
+		CORE_TEST_CHECK(!Nodes.IsVisited(3));
+		CORE_TEST_CHECK(!Nodes.IsClosed(3));
+		CORE_TEST_CHECK(Nodes.GetGCost(3) == MAX_int32);
+	}
+
+	/** Searches on one graph from several threads borrow separate node tables and agree with a serial run */
+	void TestConcurrentQueries()
+	{
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 96, 96, 0.2f, 9);
+
+		std::vector<int32> Expected(64);
+		std::vector<int32> Path;
+		for (int32 Query = 0; Query < int32(Expected.size()); ++Query)
+		{
+			const bool bFound = FGridAStar::FindPath<FOctileHeuristic>(Graph, Query * 131 % Graph.Num(), Query * 977 % Graph.Num(), Path);
+			Expected[Query] = bFound ? GetPathCost(Graph, Query * 131 % Graph.Num(), Path) : -1;
+		}
+
+		std::vector<int32> Results(Expected.size());
+		std::vector<std::thread> Threads;
+		for (int32 ThreadIndex = 0; ThreadIndex < 4; ++ThreadIndex)
+		{
+			Threads.emplace_back([&Graph, &Results, ThreadIndex]()
+			{
+				std::vector<int32> ThreadPath;
+				for (int32 Query = ThreadIndex; Query < int32(Results.size()); Query += 4)
+				{
+					const bool bFound = FGridAStar::FindPath<FOctileHeuristic>(Graph, Query * 131 % Graph.Num(), Query * 977 % Graph.Num(), ThreadPath);
+					Results[Query] = bFound ? GetPathCost(Graph, Query * 131 % Graph.Num(), ThreadPath) : -1;
+				}
+			});
+		}
+		for (std::thread& Thread : Threads)
+		{
+			Thread.join();
+		}
+		CORE_TEST_CHECK(Results == Expected);
+	}
+
+	/** Every room of a generated maze is reachable from every other one */
+	void TestMazeIsConnected()
+	{
+		FBenchmarkMap Map;
+		FGridBenchmark::GenerateMaze(33, 17, Map);
+		CORE_TEST_CHECK(Map.Width == 33 && Map.Height == 33);
+
+		FGridGraph Graph;
+		Graph.BuildLattice(Map.Width, Map.Height, Map.Walkable, 10, 14);
+		const std::vector<int32> Costs = GetDijkstraCosts(Graph, Graph.GetCellId(1, 1));
+		for (int32 Y = 1; Y < Map.Height; Y += 2)
+		{
+			for (int32 X = 1; X < Map.Width; X += 2)
+			{
+				CORE_TEST_CHECK(Costs[Graph.GetCellId(X, Y)] != MAX_int32);
+			}
+		}
+	}
+
+	/** Every cell with a direction steps to a neighbour exactly one step closer, every other one is the target or unreachable */
+	bool IsFlowFieldConsistent(const FGridGraph& Graph, const FGridFlowField& Field)
+	{
+		for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+		{
+			const int32 NextId = Field.GetNextCell(CellId);
+			if (NextId == INDEX_NONE)
+			{
+				if (CellId != Field.GetTargetId() && Field.GetDistance(CellId) != FGridFlowField::Unreachable)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const FGridCoord Delta = Graph.GetCoord(NextId) - Graph.GetCoord(CellId);
+			const int32 StepCost = Delta.X != 0 && Delta.Y != 0 ? FGridFlowField::DiagonalCost : FGridFlowField::StraightCost;
+			if (!Graph.IsWalkable(NextId) || !Graph.IsMoveAllowed(CellId, NextId) || Field.GetDistance(NextId) + StepCost != Field.GetDistance(CellId))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Flow field distances match Dijkstra, also past 16 bits, and incremental repairs match a fresh build */
+	void TestFlowField()
+	{
+		for (uint32 Seed = 1; Seed <= 3; ++Seed)
+		{
+			// Built with the field's own step costs, so Dijkstra over the graph is the reference
+			const int32 Width = 40 + Seed * 7;
+			const int32 Height = 31 + Seed * 5;
+			std::mt19937 Random(Seed * 7919);
+			std::vector<bool> Walkable(Width * Height);
+			for (int32 CellId = 0; CellId < Width * Height; ++CellId)
+			{
+				Walkable[CellId] = Random() % 100 >= 10 * Seed;
+			}
+			FGridGraph Graph;
+			Graph.BuildLattice(Width, Height, Walkable, FGridFlowField::StraightCost, FGridFlowField::DiagonalCost);
+
+			const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+			FGridFlowField Field(Graph, TargetId);
+			Field.Build();
+			CORE_TEST_CHECK(Field.GetDistance(TargetId) == 0 && !Field.HasWideDistances());
+			CORE_TEST_CHECK(IsFlowFieldConsistent(Graph, Field));
+
+			for (int32 Round = 0; Round < 30; ++Round)
+			{
+				std::vector<int32> Toggled;
+				for (int32 Change = 0; Change < 1 + Round % 4; ++Change)
+				{
+					const int32 CellId = Random() % Graph.Num();
+					Graph.SetWalkable(CellId, !Graph.IsWalkable(CellId));
+					Toggled.push_back(CellId);
+				}
+				Field.NotifyCellsChanged(Toggled);
+
+				FGridFlowField Fresh(Graph, TargetId);
+				Fresh.Build();
+				const std::vector<int32> Costs = GetDijkstraCosts(Graph, TargetId);
+				bool bSame = true;
+				for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+				{
+					bSame = bSame && Field.GetDistance(CellId) == Fresh.GetDistance(CellId) && Fresh.GetDistance(CellId) == Costs[CellId];
+				}
+				CORE_TEST_CHECK(bSame);
+				CORE_TEST_CHECK(IsFlowFieldConsistent(Graph, Field));
+			}
+		}
+
+		// The far corner of a large maze lies further than 16 bit distances reach
+		FBenchmarkMap Map;
+		FGridBenchmark::GenerateMaze(511, 1, Map);
+		FGridGraph Graph;
+		Graph.BuildLattice(Map.Width, Map.Height, Map.Walkable, FGridFlowField::StraightCost, FGridFlowField::DiagonalCost);
+		const int32 TargetId = Graph.GetCellId(1, 1);
+		FGridFlowField Field(Graph, TargetId);
+		Field.Build();
+		const std::vector<int32> Costs = GetDijkstraCosts(Graph, TargetId);
+		int32 Farthest = 0;
+		bool bSame = true;
+		for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+		{
+			Farthest = Costs[CellId] != MAX_int32 ? std::max(Farthest, Costs[CellId]) : Farthest;
+			bSame = bSame && Field.GetDistance(CellId) == Costs[CellId];
+		}
+		CORE_TEST_CHECK(Farthest > MAX_uint16 && Field.HasWideDistances());
+		CORE_TEST_CHECK(bSame);
+		CORE_TEST_CHECK(IsFlowFieldConsistent(Graph, Field));
+	}
+
+	/** ALT estimates never exceed the true cost nor drop by more than a step across one, so A* stays optimal, also after cells get blocked */
+	void TestLandmarkPaths()
+	{
+		for (uint32 Seed = 1; Seed <= 4; ++Seed)
+		{
+			FGridGraph Graph;
+			BuildRandomGraph(Graph, 41 + Seed * 5, 33 + Seed * 3, 0.1f * Seed, Seed);
+
+			FLandmarkTable Table;
+			Table.Build(Graph, 6);
+			CORE_TEST_CHECK(Table.GetNumLandmarks() == 6 && Table.GetStride() == 8);
+			CORE_TEST_CHECK(Table.Matches(Graph));
+
+			std::mt19937 Random(Seed * 104729);
+			std::vector<int32> Path;
+			for (int32 Round = 0; Round < 2; ++Round)
+			{
+				for (int32 Query = 0; Query < 30; ++Query)
+				{
+					const int32 StartId = GetRandomWalkableCell(Graph, Random);
+					const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+					const std::vector<int32> Costs = GetDijkstraCosts(Graph, TargetId);
+					const FLandmarkHeuristic Heuristic(Graph, Table, TargetId);
+					const FEdgeCostSnapshot EdgeCosts = Graph.GetEdgeCosts();
+
+					for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+					{
+						if (Costs[CellId] == MAX_int32)
+						{
+							continue;
+						}
+						CORE_TEST_CHECK(Heuristic.Get(CellId) <= Costs[CellId]);
+						for (int32 Edge = Graph.GetFirstEdge(CellId); Edge < Graph.GetEndEdge(CellId); ++Edge)
+						{
+							if (Costs[Graph.GetEdgeTarget(Edge)] != MAX_int32 && Graph.IsMoveAllowed(CellId, Graph.GetEdgeTarget(Edge)))
+							{
+								CORE_TEST_CHECK(Heuristic.Get(CellId) <= Heuristic.Get(Graph.GetEdgeTarget(Edge)) + EdgeCosts[Edge]);
+							}
+						}
+					}
+
+					const bool bFound = FGridAStar::FindPathWithHeuristic(Graph, StartId, TargetId, Heuristic, Path);
+					CORE_TEST_CHECK(bFound == (Costs[StartId] != MAX_int32));
+					if (bFound)
+					{
+						CORE_TEST_CHECK(GetPathCost(Graph, StartId, Path) == Costs[StartId]);
+					}
+				}
+
+				// Blocking cells only makes routes longer, the old table keeps bounding them from below
+				for (int32 Blocked = 0; Blocked < Graph.Num() / 10; ++Blocked)
+				{
+					Graph.SetWalkable(GetRandomWalkableCell(Graph, Random), false);
+				}
+				CORE_TEST_CHECK(!Table.Matches(Graph));
+			}
+		}
+
+		// Around walls ALT has to beat the octile estimate by a wide margin
+		FBenchmarkMap Map;
+		FGridBenchmark::GenerateMaze(129, 5, Map);
+		FGridGraph Maze;
+		Maze.BuildLattice(Map.Width, Map.Height, Map.Walkable, 10, 14);
+		FLandmarkTable Table;
+		Table.Build(Maze, 8);
+
+		std::mt19937 Random(11);
+		std::vector<int32> Path;
+		int64 OctileExpansions = 0;
+		int64 LandmarkExpansions = 0;
+		for (int32 Query = 0; Query < 50; ++Query)
+		{
+			const int32 StartId = GetRandomWalkableCell(Maze, Random);
+			const int32 TargetId = GetRandomWalkableCell(Maze, Random);
+			FPathSearchStats Stats;
+			FGridAStar::FindPath<FOctileHeuristic>(Maze, StartId, TargetId, Path, nullptr, &Stats);
+			OctileExpansions += Stats.NodesExpanded;
+			FGridAStar::FindPathWithHeuristic(Maze, StartId, TargetId, FLandmarkHeuristic(Maze, Table, TargetId), Path, nullptr, &Stats);
+			LandmarkExpansions += Stats.NodesExpanded;
+		}
+		CORE_TEST_CHECK(LandmarkExpansions * 2 < OctileExpansions);
+	}
+
+	/** A first walkable cell walled into a pocket still gets landmarks spread over the rest of the grid */
+	void TestLandmarkSeedInPocket()
+	{
+		const int32 Width = 24;
+		const int32 Height = 18;
+		std::vector<bool> Walkable(Width * Height, true);
+		Walkable[1] = false;
+		Walkable[Width] = false;
+		Walkable[Width + 1] = false;
+		FGridGraph Graph;
+		Graph.BuildLattice(Width, Height, Walkable, 10, 14);
+
+		FLandmarkTable Table;
+		Table.Build(Graph, 4);
+		CORE_TEST_CHECK(Table.GetNumLandmarks() == 4);
+		for (int32 Index = 0; Index < Table.GetNumLandmarks(); ++Index)
+		{
+			CORE_TEST_CHECK(Table.GetLandmark(Index) != 0);
+		}
+
+		const int32 StartId = Width * 2 + 2;
+		const int32 TargetId = Width * Height - 1;
+		const std::vector<int32> Costs = GetDijkstraCosts(Graph, TargetId);
+		const FLandmarkHeuristic Heuristic(Graph, Table, TargetId);
+		CORE_TEST_CHECK(Table.GetDistances(StartId)[0] > 0 && Heuristic.Get(StartId) <= Costs[StartId]);
+	}
+
+	/** Incremental labels agree with a fresh labelling and with Dijkstra reachability while cells open and close */
+	void TestComponents()
+	{
+		for (uint32 Seed = 1; Seed <= 4; ++Seed)
+		{
+			FGridGraph Graph;
+			BuildRandomGraph(Graph, 30 + Seed * 4, 24 + Seed * 3, 0.25f + 0.05f * Seed, Seed);
+			FGridComponents Components(Graph);
+			Components.Build();
+
+			std::mt19937 Random(Seed * 31337);
+			for (int32 Change = 0; Change < 300; ++Change)
+			{
+				const int32 CellId = Random() % Graph.Num();
+				Graph.SetWalkable(CellId, !Graph.IsWalkable(CellId));
+				Components.OnWalkabilityChanged(CellId);
+				if (Change % 20 != 0)
+				{
+					continue;
+				}
+
+				FGridComponents Fresh(Graph);
+				Fresh.Build();
+				CORE_TEST_CHECK(Components.GetNumComponents() == Fresh.GetNumComponents());
+
+				for (int32 Query = 0; Query < 10; ++Query)
+				{
+					const int32 StartId = Random() % Graph.Num();
+					const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+					const std::vector<int32> Costs = GetDijkstraCosts(Graph, TargetId);
+
+					// A blocked start reaches the target through any walkable neighbour it may step to
+					bool bReachable = StartId == TargetId || Costs[StartId] != MAX_int32;
+					for (int32 Edge = Graph.GetFirstEdge(StartId); Edge < Graph.GetEndEdge(StartId) && !Graph.IsWalkable(StartId); ++Edge)
+					{
+						const int32 NeighbourId = Graph.GetEdgeTarget(Edge);
+						bReachable = bReachable || (Costs[NeighbourId] != MAX_int32 && Graph.IsMoveAllowed(StartId, NeighbourId));
+					}
+					CORE_TEST_CHECK(Components.AreConnected(StartId, TargetId) == bReachable);
+
+					std::vector<int32> Path;
+					CORE_TEST_CHECK(FGridAStar::FindPath<FOctileHeuristic>(Graph, StartId, TargetId, Path) == bReachable);
+
+					// No reachable cell lies closer to the target than the one returned
+					const int32 NearestId = Components.FindNearestReachableCell(StartId, TargetId);
+					if (bReachable)
+					{
+						CORE_TEST_CHECK(NearestId == TargetId);
+						continue;
+					}
+					if (NearestId == INDEX_NONE)
+					{
+						continue;
+					}
+					CORE_TEST_CHECK(Components.AreConnected(StartId, NearestId));
+					const FGridCoord Target = Graph.GetCoord(TargetId);
+					auto GetDistance = [&Graph, &Target](int32 CellId)
+					{
+						const FGridCoord Delta = Graph.GetCoord(CellId) - Target;
+						return Delta.X * Delta.X + Delta.Y * Delta.Y;
+					};
+					for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+					{
+						if (GetDistance(CellId) < GetDistance(NearestId))
+						{
+							CORE_TEST_CHECK(!Graph.IsWalkable(CellId) || !Components.AreConnected(StartId, CellId));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/** Nearest-target queries agree with the cheapest of the single target searches, on both sides of the heuristic cut-off */
+	void TestNearestTarget()
+	{
+		for (uint32 Seed = 1; Seed <= 4; ++Seed)
+		{
+			FGridGraph Graph;
+			BuildRandomGraph(Graph, 45 + Seed * 5, 38, 0.1f * Seed, Seed);
+
+			std::mt19937 Random(Seed * 6007);
+			std::vector<int32> Path;
+			for (int32 NumTargets : { 1, 3, FGridAStar::MaxHeuristicTargets, FGridAStar::MaxHeuristicTargets + 1, 40 })
+			{
+				for (int32 Query = 0; Query < 10; ++Query)
+				{
+					// Starts may be blocked, targets too, and a blocked target is never the one reached
+					const int32 StartId = Random() % Graph.Num();
+					std::vector<int32> TargetIds;
+					int32 BestCost = MAX_int32;
+					for (int32 Index = 0; Index < NumTargets; ++Index)
+					{
+						TargetIds.push_back(Random() % Graph.Num());
+						if (Graph.IsWalkable(TargetIds.back()) && FGridAStar::FindPath<FOctileHeuristic>(Graph, StartId, TargetIds.back(), Path))
+						{
+							BestCost = std::min(BestCost, GetPathCost(Graph, StartId, Path));
+						}
+					}
+
+					int32 TargetIndex;
+					const bool bFound = FGridAStar::FindPathToNearest(Graph, StartId, TargetIds, Path, TargetIndex);
+					CORE_TEST_CHECK(bFound == (BestCost != MAX_int32));
+					if (bFound)
+					{
+						CORE_TEST_CHECK(TargetIndex >= 0 && TargetIndex < NumTargets);
+						CORE_TEST_CHECK(GetPathCost(Graph, StartId, Path) == BestCost);
+						CORE_TEST_CHECK((Path.empty() ? StartId : Path.back()) == TargetIds[TargetIndex]);
+					}
+				}
+			}
+		}
+	}
+
+	/** Bounded modes stay within 1 + epsilon of optimal, are optimal at zero, and weighted A* expands less on open ground */
+	void TestBoundedSearches()
+	{
+		for (uint32 Seed = 1; Seed <= 4; ++Seed)
+		{
+			FGridGraph Graph;
+			BuildRandomGraph(Graph, 48 + Seed * 4, 41, 0.1f * Seed, Seed);
+
+			std::mt19937 Random(Seed * 5297);
+			std::vector<int32> Path;
+			for (int32 Query = 0; Query < 30; ++Query)
+			{
+				const int32 StartId = GetRandomWalkableCell(Graph, Random);
+				const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+				const std::vector<int32> Costs = GetDijkstraCosts(Graph, TargetId);
+				for (float Epsilon : { 0.0f, 0.1f, 0.5f, 2.0f })
+				{
+					for (int32 Pass = 0; Pass < 2; ++Pass)
+					{
+						const bool bFound = Pass == 0
+							? FGridAStar::FindPathWeighted(Graph, StartId, TargetId, Epsilon, Path)
+							: FFocalSearch::FindPath(Graph, StartId, TargetId, Epsilon, Path);
+						CORE_TEST_CHECK(bFound == (Costs[StartId] != MAX_int32));
+						if (!bFound)
+						{
+							continue;
+						}
+
+						const int32 Cost = GetPathCost(Graph, StartId, Path);
+						CORE_TEST_CHECK(Cost >= Costs[StartId] && Cost <= int64(Costs[StartId]) * (1.0f + Epsilon));
+						CORE_TEST_CHECK(Epsilon > 0.0f || Cost == Costs[StartId]);
+						CORE_TEST_CHECK((Path.empty() ? StartId : Path.back()) == TargetId);
+					}
+				}
+			}
+		}
+
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 120, 120, 0.1f, 11);
+		std::mt19937 Random(31);
+		std::vector<int32> Path;
+		int64 OptimalExpansions = 0;
+		int64 WeightedExpansions = 0;
+		int64 FocalExpansions = 0;
+		for (int32 Query = 0; Query < 20; ++Query)
+		{
+			const int32 StartId = GetRandomWalkableCell(Graph, Random);
+			const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+			FPathSearchStats Stats;
+			FGridAStar::FindPath<FOctileHeuristic>(Graph, StartId, TargetId, Path, nullptr, &Stats);
+			OptimalExpansions += Stats.NodesExpanded;
+			FGridAStar::FindPathWeighted(Graph, StartId, TargetId, 0.25f, Path, nullptr, &Stats);
+			WeightedExpansions += Stats.NodesExpanded;
+			FFocalSearch::FindPath(Graph, StartId, TargetId, 0.25f, Path, nullptr, &Stats);
+			FocalExpansions += Stats.NodesExpanded;
+		}
+		CORE_TEST_CHECK(WeightedExpansions < OptimalExpansions);
+		CORE_TEST_CHECK(FocalExpansions < OptimalExpansions);
+	}
+
+	/** Weighted cells have to steer A* and the landmark heuristic exactly like they steer Dijkstra */
+	void TestCellCosts()
+	{
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 50, 37, 0.15f, 7);
+		CORE_TEST_CHECK(Graph.HasUniformCosts());
+
+		std::vector<uint8> Costs(Graph.Num(), 1);
+		Graph.SetCellCosts(Costs);
+		CORE_TEST_CHECK(Graph.HasUniformCosts());
+
+		std::mt19937 Random(4441);
+		for (uint8& Cost : Costs)
+		{
+			Cost = uint8(Random() % 4);
+		}
+		Graph.SetCellCosts(Costs);
+		CORE_TEST_CHECK(!Graph.HasUniformCosts());
+
+		FLandmarkTable Landmarks;
+		Landmarks.Build(Graph, 4);
+		std::vector<int32> Path;
+		for (int32 Query = 0; Query < 40; ++Query)
+		{
+			const int32 StartId = GetRandomWalkableCell(Graph, Random);
+			const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+			const std::vector<int32> Reference = GetDijkstraCosts(Graph, TargetId);
+
+			const bool bFound = FGridAStar::FindPath<FOctileHeuristic>(Graph, StartId, TargetId, Path);
+			CORE_TEST_CHECK(bFound == (Reference[StartId] != MAX_int32));
+			if (bFound)
+			{
+				CORE_TEST_CHECK(GetWeightedPathCost(Graph, StartId, Path) == Reference[StartId]);
+				CORE_TEST_CHECK(FGridAStar::FindPathWithHeuristic(Graph, StartId, TargetId, FLandmarkHeuristic(Graph, Landmarks, TargetId), Path));
+				CORE_TEST_CHECK(GetWeightedPathCost(Graph, StartId, Path) == Reference[StartId]);
+			}
+		}
+	}
+
+	/** Costs swapped in while searches run never hand them a broken path, and the last costs set are the ones in use */
+	void TestCostsChangedUnderSearches()
+	{
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 80, 80, 0.2f, 33);
+		std::vector<std::vector<uint8>> CostSets(2, std::vector<uint8>(Graph.Num()));
+		std::mt19937 Random(271);
+		for (std::vector<uint8>& Costs : CostSets)
+		{
+			for (uint8& Cost : Costs)
+			{
+				Cost = uint8(1 + Random() % 4);
+			}
+		}
+		Graph.SetCellCosts(CostSets[0]);
+
+		std::vector<std::pair<int32, int32>> Queries;
+		std::vector<bool> Reachable;
+		for (int32 Query = 0; Query < 48; ++Query)
+		{
+			const int32 StartId = GetRandomWalkableCell(Graph, Random);
+			const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+			Queries.emplace_back(StartId, TargetId);
+			Reachable.push_back(GetDijkstraCosts(Graph, TargetId)[StartId] != MAX_int32);
+		}
+
+		std::atomic<int32> NumBroken(0);
+		std::vector<std::thread> Threads;
+		for (int32 ThreadIndex = 0; ThreadIndex < 4; ++ThreadIndex)
+		{
+			Threads.emplace_back([&Graph, &Queries, &Reachable, &NumBroken, ThreadIndex]()
+			{
+				std::vector<int32> ThreadPath;
+				for (int32 Query = ThreadIndex; Query < int32(Queries.size()); Query += 4)
+				{
+					const bool bFound = FGridAStar::FindPath<FOctileHeuristic>(Graph, Queries[Query].first, Queries[Query].second, ThreadPath);
+					if (bFound != Reachable[Query] || (bFound && GetWeightedPathCost(Graph, Queries[Query].first, ThreadPath) < 0))
+					{
+						++NumBroken;
+					}
+				}
+			});
+		}
+		for (int32 Swap = 1; Swap <= 20; ++Swap)
+		{
+			Graph.SetCellCosts(CostSets[Swap % 2]);
+		}
+		for (std::thread& Thread : Threads)
+		{
+			Thread.join();
+		}
+		CORE_TEST_CHECK(NumBroken == 0);
+
+		std::vector<int32> Path;
+		const int32 TargetId = Queries[0].second;
+		const std::vector<int32> Costs = GetDijkstraCosts(Graph, TargetId);
+		CORE_TEST_CHECK(FGridAStar::FindPath<FOctileHeuristic>(Graph, Queries[0].first, TargetId, Path) == Reachable[0]);
+		CORE_TEST_CHECK(!Reachable[0] || GetWeightedPathCost(Graph, Queries[0].first, Path) == Costs[Queries[0].first]);
+	}
+
+	/** Every search counts its heap operations and the neighbours it looked at, on top of the expansions */
+	void TestSearchStats()
+	{
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 60, 60, 0.2f, 17);
+		FHierarchicalPathfinder Hierarchy(Graph, 8);
+		Hierarchy.Build();
+
+		std::mt19937 Random(47);
+		std::vector<int32> Path;
+		for (int32 Query = 0; Query < 20; ++Query)
+		{
+			const int32 StartId = GetRandomWalkableCell(Graph, Random);
+			const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+			FPathSearchStats Stats[5];
+			FGridAStar::FindPath<FOctileHeuristic>(Graph, StartId, TargetId, Path, nullptr, &Stats[0]);
+			FJumpPointSearch::FindPath(Graph, StartId, TargetId, Path, nullptr, &Stats[1]);
+			FThetaStar::FindPath(Graph, StartId, TargetId, Path, nullptr, &Stats[2]);
+			Hierarchy.FindPath(StartId, TargetId, Path, nullptr, &Stats[3]);
+			FFocalSearch::FindPath(Graph, StartId, TargetId, 0.25f, Path, nullptr, &Stats[4]);
+
+			// Only the focal list has outdated entries to pop without expanding them
+			for (int32 Index = 0; Index < 4; ++Index)
+			{
+				CORE_TEST_CHECK(Stats[Index].HeapPops == Stats[Index].NodesExpanded);
+				CORE_TEST_CHECK(Stats[Index].HeapPushes >= Stats[Index].NodesGenerated);
+			}
+			CORE_TEST_CHECK(Stats[4].HeapPops >= Stats[4].NodesExpanded);
+			for (const FPathSearchStats& Search : Stats)
+			{
+				CORE_TEST_CHECK(Search.NeighboursEvaluated >= Search.NodesGenerated - 1);
+			}
+			CORE_TEST_CHECK(Stats[0].NeighboursEvaluated <= Stats[0].NodesExpanded * 8);
+		}
+	}
+
+	/** Cells toggled behind the tables' back, then rebuilt in place like FPathGrid::Invalidate does, search like fresh tables */
+	void TestRebuildAfterBulkChange()
+	{
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 70, 52, 0.2f, 29);
+		FJumpPointTable Table(Graph);
+		Table.Build();
+		FHierarchicalPathfinder Hierarchy(Graph, 8);
+		Hierarchy.Build();
+
+		std::mt19937 Random(6007);
+		std::vector<int32> Path;
+		for (int32 Round = 0; Round < 3; ++Round)
+		{
+			for (int32 Change = 0; Change < Graph.Num() / 10; ++Change)
+			{
+				const int32 CellId = Random() % Graph.Num();
+				Graph.SetWalkable(CellId, !Graph.IsWalkable(CellId));
+			}
+			Table.Build();
+			Hierarchy.Build();
+
+			for (int32 Query = 0; Query < 40; ++Query)
+			{
+				const int32 StartId = GetRandomWalkableCell(Graph, Random);
+				const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+				const std::vector<int32> Costs = GetDijkstraCosts(Graph, TargetId);
+				const bool bReachable = Costs[StartId] != MAX_int32;
+
+				const bool bJumpPointPlus = FJumpPointSearch::FindPath(Table, StartId, TargetId, Path);
+				CORE_TEST_CHECK(bJumpPointPlus == bReachable);
+				CORE_TEST_CHECK(!bJumpPointPlus || GetPathCost(Graph, StartId, Path) == Costs[StartId]);
+
+				const bool bHierarchical = Hierarchy.FindPath(StartId, TargetId, Path);
+				CORE_TEST_CHECK(bHierarchical == bReachable);
+				CORE_TEST_CHECK(!bHierarchical || GetPathCost(Graph, StartId, Path) >= Costs[StartId]);
+			}
+		}
+	}
+
+	/** Queries running while the hierarchy is rebuilt still see a whole set of clusters */
+	void TestHierarchyRebuildUnderQueries()
+	{
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 96, 96, 0.15f, 41);
+		FHierarchicalPathfinder Hierarchy(Graph, 8);
+		Hierarchy.Build();
+
+		std::mt19937 Random(4111);
+		std::vector<std::pair<int32, int32>> Queries;
+		std::vector<bool> Reachable;
+		for (int32 Query = 0; Query < 64; ++Query)
+		{
+			const int32 StartId = GetRandomWalkableCell(Graph, Random);
+			const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+			Queries.emplace_back(StartId, TargetId);
+			Reachable.push_back(GetDijkstraCosts(Graph, TargetId)[StartId] != MAX_int32);
+		}
+
+		std::atomic<int32> NumBroken(0);
+		std::vector<std::thread> Threads;
+		for (int32 ThreadIndex = 0; ThreadIndex < 4; ++ThreadIndex)
+		{
+			Threads.emplace_back([&Hierarchy, &Queries, &Reachable, &NumBroken, ThreadIndex]()
+			{
+				std::vector<int32> ThreadPath;
+				for (int32 Round = 0; Round < 6; ++Round)
+				{
+					for (int32 Query = ThreadIndex; Query < int32(Queries.size()); Query += 4)
+					{
+						if (Hierarchy.FindPath(Queries[Query].first, Queries[Query].second, ThreadPath) != Reachable[Query])
+						{
+							++NumBroken;
+						}
+					}
+				}
+			});
+		}
+		for (int32 Rebuild = 0; Rebuild < 10; ++Rebuild)
+		{
+			Hierarchy.Build();
+		}
+		for (std::thread& Thread : Threads)
+		{
+			Thread.join();
+		}
+		CORE_TEST_CHECK(NumBroken == 0);
+	}
+
+	/** JPS+ paths stay optimal, and incremental table updates match a fresh build while cells open and close */
+	void TestJumpPointTable()
+	{
+		// Sides on both sides of the 64 cell word boundary
+		const FGridCoord Sizes[] = { FGridCoord(64, 40), FGridCoord(70, 66), FGridCoord(129, 31), FGridCoord(33, 128) };
+		for (uint32 Seed = 1; Seed <= 4; ++Seed)
+		{
+			FGridGraph Graph;
+			BuildRandomGraph(Graph, Sizes[Seed - 1].X, Sizes[Seed - 1].Y, 0.1f * Seed, Seed);
+			FJumpPointTable Table(Graph);
+			Table.Build();
+
+			std::mt19937 Random(Seed * 4099);
+			std::vector<int32> Path;
+			for (int32 Change = 0; Change <= 200; ++Change)
+			{
+				if (Change % 40 == 0)
+				{
+					FJumpPointTable Fresh(Graph);
+					Fresh.Build();
+					bool bSame = true;
+					for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+					{
+						for (int32 Direction = 0; Direction < FJumpPointTable::NumDirections; ++Direction)
+						{
+							bSame = bSame && Table.GetDistance(CellId, Direction) == Fresh.GetDistance(CellId, Direction);
+						}
+					}
+					CORE_TEST_CHECK(bSame);
+
+					for (int32 Query = 0; Query < 20; ++Query)
+					{
+						const int32 StartId = GetRandomWalkableCell(Graph, Random);
+						const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+						const std::vector<int32> Costs = GetDijkstraCosts(Graph, TargetId);
+						const bool bFound = FJumpPointSearch::FindPath(Table, StartId, TargetId, Path);
+						CORE_TEST_CHECK(bFound == (Costs[StartId] != MAX_int32));
+						if (bFound)
+						{
+							CORE_TEST_CHECK(GetPathCost(Graph, StartId, Path) == Costs[StartId]);
+						}
+
+						// A blocked start is left the same way the online search leaves it
+						const int32 BlockedStartId = Random() % Graph.Num();
+						std::vector<int32> OnlinePath;
+						const bool bOnline = FJumpPointSearch::FindPath(Graph, BlockedStartId, TargetId, OnlinePath);
+						CORE_TEST_CHECK(FJumpPointSearch::FindPath(Table, BlockedStartId, TargetId, Path) == bOnline);
+						if (bOnline)
+						{
+							CORE_TEST_CHECK(Path.size() == OnlinePath.size());
+						}
+					}
+				}
+
+				const int32 CellId = Random() % Graph.Num();
+				Graph.SetWalkable(CellId, !Graph.IsWalkable(CellId));
+				Table.OnWalkabilityChanged(CellId);
+			}
+		}
+	}
+
+	/** A saved table loads back unchanged, and is refused once the graph it was built for changes */
+	void TestLandmarkTableFile()
+	{
+		const char* Filename = "PathfindingCoreTests.landmarks";
+
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 50, 40, 0.2f, 9);
+		FLandmarkTable Table;
+		Table.Build(Graph, 5);
+		CORE_TEST_CHECK(Table.Save(Filename));
+
+		FLandmarkTable Loaded;
+		CORE_TEST_CHECK(Loaded.Load(Filename, Graph));
+		CORE_TEST_CHECK(Loaded.GetNumLandmarks() == Table.GetNumLandmarks() && Loaded.GetStride() == Table.GetStride());
+		bool bSame = true;
+		for (int32 CellId = 0; CellId < Graph.Num(); ++CellId)
+		{
+			for (int32 Index = 0; Index < Table.GetStride(); ++Index)
+			{
+				bSame = bSame && Loaded.GetDistances(CellId)[Index] == Table.GetDistances(CellId)[Index];
+			}
+		}
+		CORE_TEST_CHECK(bSame);
+
+		Graph.SetWalkable(Table.GetLandmark(0), false);
+		CORE_TEST_CHECK(!Loaded.Load(Filename, Graph));
+		CORE_TEST_CHECK(!Loaded.Load("PathfindingCoreTests.missing", Graph));
+		std::remove(Filename);
+	}
+
+	/** A written grid file searches in place like the graph it came from, and a damaged one is refused */
+	void TestGridFile()
+	{
+		const char* Filename = "PathfindingCoreTests.pfgrid";
+
+		FGridGraph Graph;
+		BuildRandomGraph(Graph, 45, 38, 0.2f, 21);
+		std::mt19937 Random(913);
+		std::vector<uint8> Costs(Graph.Num());
+		for (uint8& Cost : Costs)
+		{
+			Cost = uint8(1 + Random() % 3);
+		}
+		Graph.SetCellCosts(Costs);
+		FGridComponents Components(Graph);
+		Components.Build();
+		FLandmarkTable Table;
+		Table.Build(Graph, 4);
+		CORE_TEST_CHECK(FGridFile::Write(Filename, Graph, 1234, &Components, &Table));
+
+		// Read into 8 byte words so the sections keep their alignment, like a mapped file's would
+		std::ifstream Stream(Filename, std::ios::binary | std::ios::ate);
+		const SIZE_T Size = SIZE_T(Stream.tellg());
+		std::vector<uint64> Buffer((Size + sizeof(uint64) - 1) / sizeof(uint64));
+		Stream.seekg(0);
+		Stream.read(reinterpret_cast<char*>(Buffer.data()), std::streamsize(Size));
+		Stream.close();
+		std::remove(Filename);
+
+		FGridFile File;
+		CORE_TEST_CHECK(File.Open(Buffer.data(), Size));
+		CORE_TEST_CHECK(File.GetSourceHash() == 1234 && File.Num() == Graph.Num() && !File.HasUniformCosts());
+
+		FGridGraph Attached;
+		Attached.Attach(File);
+		FGridComponents AttachedComponents(Attached);
+		AttachedComponents.Build(File.GetComponentLabels());
+		FLandmarkTable AttachedTable;
+		CORE_TEST_CHECK(AttachedTable.Attach(File));
+		CORE_TEST_CHECK(AttachedTable.Matches(Attached));
+		CORE_TEST_CHECK(AttachedComponents.GetNumComponents() == Components.GetNumComponents());
+
+		std::vector<int32> Path;
+		std::vector<int32> AttachedPath;
+		for (int32 Query = 0; Query < 40; ++Query)
+		{
+			const int32 StartId = GetRandomWalkableCell(Graph, Random);
+			const int32 TargetId = GetRandomWalkableCell(Graph, Random);
+			const bool bFound = FGridAStar::FindPath<FOctileHeuristic>(Graph, StartId, TargetId, Path);
+			CORE_TEST_CHECK(AttachedComponents.AreConnected(StartId, TargetId) == bFound);
+			CORE_TEST_CHECK(FGridAStar::FindPathWithHeuristic(Attached, StartId, TargetId, FLandmarkHeuristic(Attached, AttachedTable, TargetId), AttachedPath) == bFound);
+			CORE_TEST_CHECK(!bFound || GetWeightedPathCost(Attached, StartId, AttachedPath) == GetWeightedPathCost(Graph, StartId, Path));
+		}
+
+		// Blocking a cell copies nothing back into the file, the attached graph keeps its own walkability
+		const int32 BlockedId = GetRandomWalkableCell(Attached, Random);
+		Attached.SetWalkable(BlockedId, false);
+		AttachedComponents.OnWalkabilityChanged(BlockedId);
+		CORE_TEST_CHECK(!Attached.IsWalkable(BlockedId) && Graph.IsWalkable(BlockedId));
+
+		// Ids a search would index by unchecked keep the file from opening, Height and MaxEdges are header words 3 and 7
+		const int32* Words = reinterpret_cast<const int32*>(Buffer.data());
+		auto OpensWith = [&Buffer, Size](ptrdiff_t WordIndex, int32 Value)
+		{
+			std::vector<uint64> Corrupted = Buffer;
+			reinterpret_cast<int32*>(Corrupted.data())[WordIndex] = Value;
+			FGridFile CorruptedFile;
+			return CorruptedFile.Open(Corrupted.data(), Size);
+		};
+		const ptrdiff_t OffsetsWord = File.GetEdgeOffsets() - Words;
+		const ptrdiff_t TargetsWord = File.GetEdgeTargets() - Words;
+		const ptrdiff_t LabelsWord = File.GetComponentLabels() - Words;
+		CORE_TEST_CHECK(OpensWith(TargetsWord, Words[TargetsWord]));
+		CORE_TEST_CHECK(!OpensWith(7, File.GetMaxEdges() - 1));
+		CORE_TEST_CHECK(!OpensWith(TargetsWord + File.GetNumEdges() / 2, File.Num()));
+		CORE_TEST_CHECK(!OpensWith(TargetsWord, -1));
+		CORE_TEST_CHECK(!OpensWith(OffsetsWord + File.Num() / 2, Words[OffsetsWord + File.Num() / 2 + 1] + 1));
+		CORE_TEST_CHECK(!OpensWith(LabelsWord + 1, -2));
+		CORE_TEST_CHECK(!OpensWith(3, MAX_int32 / File.GetWidth() + 1));
+
+		FGridFile Damaged;
+		CORE_TEST_CHECK(!Damaged.Open(Buffer.data(), Size / 2));
+		Buffer[0] ^= 1;
+		CORE_TEST_CHECK(!Damaged.Open(Buffer.data(), Size));
+		CORE_TEST_CHECK(!Damaged.IsOpen());
+	}
+
+	/** The benchmark's own checks accept every mode on a small map */
+	void TestBenchmarkRun()
+	{
+		FBenchmarkMap Map;
+		FGridBenchmark::GenerateOpenField(40, 2, Map);
+
+		FGridBenchmark Benchmark(Map);
+		CORE_TEST_CHECK(Benchmark.GenerateQueries(100, 4));
+		for (EPathSearchMode Mode : { EPathSearchMode::AStar, EPathSearchMode::JumpPoint, EPathSearchMode::Hierarchical, EPathSearchMode::JumpPointPlus })
+		{
+			const FBenchmarkResult Result = Benchmark.Run(Mode);
+			CORE_TEST_CHECK(Result.NumWrong == 0);
+			CORE_TEST_CHECK(Result.MeanLengthRatio >= 1.0);
+		}
+
+		const FBenchmarkResult AnyAngle = Benchmark.Run(EPathSearchMode::AnyAngle);
+		CORE_TEST_CHECK(AnyAngle.NumWrong == 0);
+		CORE_TEST_CHECK(AnyAngle.MeanLengthRatio <= 1.0);
+
+		Benchmark.SetSuboptimalityBound(0.25);
+		for (EPathSearchMode Mode : { EPathSearchMode::WeightedAStar, EPathSearchMode::Focal })
+		{
+			const FBenchmarkResult Result = Benchmark.Run(Mode);
+			CORE_TEST_CHECK(Result.NumWrong == 0);
+			CORE_TEST_CHECK(Result.MeanLengthRatio >= 1.0 && Result.WorstLengthRatio <= 1.25 * (1.0 + FGridBenchmark::LengthTolerance));
+		}
+
+		Benchmark.SetLandmarks(4);
+		CORE_TEST_CHECK(Benchmark.Run(EPathSearchMode::AStar).NumWrong == 0);
+	}
+}
+
+int main()
+{
+	TestSearchesAgainstDijkstra();
+	TestManhattanPathsAreValid();
+	TestHeuristicLanesMatchScalar();
+	TestLineOfSight();
+	TestAnyAnglePaths();
+	TestCancellation();
+	TestNodeTableReuse();
+	TestConcurrentQueries();
+	TestMazeIsConnected();
+	TestFlowField();
+	TestLandmarkPaths();
+	TestLandmarkSeedInPocket();
+	TestLandmarkTableFile();
+	TestComponents();
+	TestJumpPointTable();
+	TestRebuildAfterBulkChange();
+	TestHierarchyRebuildUnderQueries();
+	TestNearestTarget();
+	TestBoundedSearches();
+	TestCellCosts();
+	TestCostsChangedUnderSearches();
+	TestGridFile();
+	TestSearchStats();
+	TestBenchmarkRun();
+
+	if (NumFailures > 0)
+	{
+		std::printf("%d checks failed\n", NumFailures);
+		return 1;
+	}
+	std::printf("All checks passed\n");
+	return 0;
+}
+
+#endif
@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ThetaStar.h"
+#include "AStarNodeTable.h"
+#include "AStarOpenSet.h"
+#include "GridAStar.h"
+#include "GridGraph.h"
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+	/**
+	 * Walks the cells a segment between two cell centers touches, stepping cell ids directly so
+	 * the walk only reads the walkable bits. Stops early and returns false once Visit does.
+	 */
+	template <typename VisitorType>
+	bool WalkSegment(const FGridGraph& Graph, int32 FromId, int32 ToId, VisitorType Visit)
+	{
+		const FGridCoord From = Graph.GetCoord(FromId);
+		const FGridCoord To = Graph.GetCoord(ToId);
+		const int32 DX = std::abs(To.X - From.X);
+		const int32 DY = std::abs(To.Y - From.Y);
+		const int32 StepX = To.X > From.X ? 1 : -1;
+		const int32 StepY = To.Y > From.Y ? Graph.GetWidth() : -Graph.GetWidth();
+
+		// Positive when the segment reaches the next vertical cell edge before the next horizontal one, zero at a corner
+		int32 Error = DX - DY;
+		int32 CellId = FromId;
+		for (int32 Remaining = DX + DY; Remaining > 0;)
+		{
+			if (Error > 0)
+			{
+				CellId += StepX;
+				Error -= 2 * DY;
+				--Remaining;
+			}
+			else if (Error < 0)
+			{
+				CellId += StepY;
+				Error += 2 * DX;
+				--Remaining;
+			}
+			else
+			{
+				if (!Visit(CellId + StepX) || !Visit(CellId + StepY))
+				{
+					return false;
+				}
+				CellId += StepX + StepY;
+				Error += 2 * (DX - DY);
+				Remaining -= 2;
+			}
+
+			if (!Visit(CellId))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+bool FThetaStar::FindPath(FGridGraph& Graph, int32 StartId, int32 TargetId, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation, FPathSearchStats* OutStats)
+{
+	FPathSearchStats LocalStats;
+	FPathSearchStats& Stats = OutStats ? *OutStats : LocalStats;
+	Stats = FPathSearchStats();
+
+	FScopedNodeTable Nodes(Graph);
+	FAStarOpenSet OpenSet(*Nodes, &Stats);
+	const FEdgeCostSnapshot EdgeCosts = Graph.GetEdgeCosts();
+	OutPath.clear();
+
+	Nodes->Visit(StartId);
+	Nodes->SetGCost(StartId, 0);
+	Nodes->SetHCost(StartId, GetSegmentCost(Graph, StartId, TargetId));
+	OpenSet.Push(StartId);
+	++Stats.NodesGenerated;
+
+	bool bFound = false;
+	while (!OpenSet.IsEmpty())
+	{
+		if (Cancellation && Cancellation->IsCancelled())
+		{
+			return false;
+		}
+
+		const int32 CurrentId = OpenSet.Pop();
+		++Stats.NodesExpanded;
+		if (CurrentId == TargetId)
+		{
+			FGridAStar::RetracePath(*Nodes, StartId, TargetId, OutPath);
+			bFound = true;
+			break;
+		}
+
+		const int32 ParentId = Nodes->GetParent(CurrentId);
+		Stats.NeighboursEvaluated += Graph.GetEndEdge(CurrentId) - Graph.GetFirstEdge(CurrentId);
+		for (int32 Edge = Graph.GetFirstEdge(CurrentId); Edge < Graph.GetEndEdge(CurrentId); ++Edge)
+		{
+			const int32 NeighbourId = Graph.GetEdgeTarget(Edge);
+			if (!Graph.IsWalkable(NeighbourId) || Nodes->IsClosed(NeighbourId) || !Graph.IsMoveAllowed(CurrentId, NeighbourId))
+			{
+				continue;
+			}
+
+			if (!Nodes->IsVisited(NeighbourId))
+			{
+				Nodes->Visit(NeighbourId);
+			}
+
+			// Skip the current node when its parent can see the neighbour directly
+			int32 ViaId = CurrentId;
+			int32 MovementCost = Nodes->GetGCost(CurrentId) + EdgeCosts[Edge];
+			if (ParentId != INDEX_NONE && HasLineOfSight(Graph, ParentId, NeighbourId))
+			{
+				ViaId = ParentId;
+				MovementCost = Nodes->GetGCost(ParentId) + GetSegmentCost(Graph, ParentId, NeighbourId);
+			}
+
+			const bool bInOpenSet = OpenSet.Contains(NeighbourId);
+			if (MovementCost < Nodes->GetGCost(NeighbourId) || !bInOpenSet)
+			{
+				Nodes->SetGCost(NeighbourId, MovementCost);
+				Nodes->SetHCost(NeighbourId, GetSegmentCost(Graph, NeighbourId, TargetId));
+				Nodes->SetParent(NeighbourId, ViaId);
+
+				if (bInOpenSet)
+				{
+					OpenSet.Update(NeighbourId);
+				}
+				else
+				{
+					OpenSet.Push(NeighbourId);
+					++Stats.NodesGenerated;
+				}
+			}
+		}
+	}
+
+	if (!bFound)
+	{
+		return false;
+	}
+
+	// A point in the middle of a straight run is not a turn, the segment across it touches the same cells
+	int32 NumKept = 0;
+	int32 PreviousId = StartId;
+	for (int32 Index = 0; Index < int32(OutPath.size()); ++Index)
+	{
+		if (Index + 1 < int32(OutPath.size()))
+		{
+			const FGridCoord In = Graph.GetCoord(OutPath[Index]) - Graph.GetCoord(PreviousId);
+			const FGridCoord Out = Graph.GetCoord(OutPath[Index + 1]) - Graph.GetCoord(OutPath[Index]);
+			if (In.X * Out.Y == In.Y * Out.X && In.X * Out.X + In.Y * Out.Y > 0)
+			{
+				continue;
+			}
+		}
+		OutPath[NumKept++] = OutPath[Index];
+		PreviousId = OutPath[Index];
+	}
+	OutPath.resize(NumKept);
+	return true;
+}
+
+bool FThetaStar::HasLineOfSight(const FGridGraph& Graph, int32 FromId, int32 ToId)
+{
+	return WalkSegment(Graph, FromId, ToId, [&Graph](int32 CellId) { return Graph.IsWalkable(CellId); });
+}
+
+void FThetaStar::GetCrossedCells(const FGridGraph& Graph, int32 FromId, int32 ToId, std::vector<int32>& OutCells)
+{
+	WalkSegment(Graph, FromId, ToId, [&OutCells](int32 CellId) { OutCells.push_back(CellId); return true; });
+}
+
+int32 FThetaStar::GetSegmentCost(const FGridGraph& Graph, int32 FromId, int32 ToId)
+{
+	const FGridCoord Delta = Graph.GetCoord(ToId) - Graph.GetCoord(FromId);
+	const int32 DX = std::abs(Delta.X);
+	const int32 DY = std::abs(Delta.Y);
+	if (DX == 0 || DY == 0)
+	{
+		return Graph.GetStraightCost() * (DX + DY);
+	}
+	if (DX == DY)
+	{
+		return Graph.GetDiagonalCost() * DX;
+	}
+	return int32(std::lround(Graph.GetStraightCost() * std::sqrt(double(DX) * DX + double(DY) * DY)));
+}
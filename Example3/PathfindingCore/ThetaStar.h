@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "PathfindingCoreTypes.h"
+#include <vector>
+
+class FGridGraph;
+
+/**
+ * Theta* any-angle search over an FGridGraph.
+ * Works like A*, except that a node whose parent can see the new neighbour gets that parent
+ * instead, so paths run in straight segments between turning points rather than cell by cell.
+ * Paths are not guaranteed to be the shortest any-angle paths, but usually come close, and they
+ * are shorter than the 8-connected ones from FGridAStar wherever the lattice forces a zig-zag.
+ */
+class INVADED_API FThetaStar
+{
+public:
+	/**
+	 * Fills OutPath with the turning points after StartId, the last one being TargetId.
+	 * Consecutive points, starting from StartId, always have line of sight to each other.
+	 * False when the target can't be reached or the search was cancelled.
+	 */
+	static bool FindPath(FGridGraph& Graph, int32 StartId, int32 TargetId, std::vector<int32>& OutPath, const FPathCancellationToken* Cancellation = nullptr, FPathSearchStats* OutStats = nullptr);
+
+	/**
+	 * True when the straight segment between the two cell centers only touches walkable cells.
+	 * A segment through a lattice corner touches both cells beside it, the same rule that keeps
+	 * diagonal steps from cutting corners. FromId itself is not checked.
+	 */
+	static bool HasLineOfSight(const FGridGraph& Graph, int32 FromId, int32 ToId);
+
+	/** Appends the cells the segment touches after FromId up to ToId, in walking order */
+	static void GetCrossedCells(const FGridGraph& Graph, int32 FromId, int32 ToId, std::vector<int32>& OutCells);
+
+	/** Cost of walking the segment in the step cost units of the graph, matches the step costs for straight and diagonal lines */
+	static int32 GetSegmentCost(const FGridGraph& Graph, int32 FromId, int32 ToId);
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathfindingGridCookCommandlet.h"
+#include "CellGrid.h"
+#include "PathGrid.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPathfindingGridCook, Log, All);
+
+UPathfindingGridCookCommandlet::UPathfindingGridCookCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UPathfindingGridCookCommandlet::Main(const FString& Params)
+{
+	FString MapList;
+	int32 NumLandmarks = 8;
+	FParse::Value(*Params, TEXT("map="), MapList, false);
+	FParse::Value(*Params, TEXT("landmarks="), NumLandmarks);
+
+	TArray<FString> MapNames;
+	MapList.ParseIntoArray(MapNames, TEXT(","));
+	if (MapNames.Num() == 0)
+	{
+		UE_LOG(LogPathfindingGridCook, Error, TEXT("Pass -map=<package>[,<package>...] [-landmarks=N]"));
+		return 1;
+	}
+
+	int32 NumFailed = 0;
+	for (const FString& MapName : MapNames)
+	{
+		UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+		UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+		if (!World || !World->PersistentLevel)
+		{
+			UE_LOG(LogPathfindingGridCook, Error, TEXT("Can't load level %s"), *MapName);
+			++NumFailed;
+			continue;
+		}
+
+		// The world is never initialized, so walk the level's actors instead of iterating the world
+		for (AActor* Actor : World->PersistentLevel->Actors)
+		{
+			const ACellGrid* CellGrid = Cast<ACellGrid>(Actor);
+			if (!CellGrid || CellGrid->Num() == 0)
+			{
+				continue;
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			if (FPathGrid::WriteGridFile(CellGrid, NumLandmarks))
+			{
+				UE_LOG(LogPathfindingGridCook, Display, TEXT("%s: %dx%d grid written to %s in %.1f ms"),
+					*MapName, CellGrid->GetWidth(), CellGrid->GetHeight(), *FPathGrid::GetGridFilename(CellGrid), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+			}
+			else
+			{
+				UE_LOG(LogPathfindingGridCook, Error, TEXT("%s: can't write %s"), *MapName, *FPathGrid::GetGridFilename(CellGrid));
+				++NumFailed;
+			}
+		}
+	}
+	return NumFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PathfindingGridCookCommandlet.generated.h"
+
+/**
+ * Writes the grid file of every ACellGrid in the given levels, so FPathGrid maps the finished search graph,
+ * components and landmark distances at startup instead of building them.
+ *
+ *   -run=PathfindingGridCook -map=/Game/Maps/Arena,/Game/Maps/Caves -landmarks=8
+ *
+ * Files land in Content/Pathfinding named after the layout hash of the cells, stage that directory with the
+ * game. Rerun after editing a level, stale files are ignored rather than loaded. Returns non-zero when a level
+ * can't be loaded or a file can't be written.
+ */
+UCLASS()
+class INVADED_API UPathfindingGridCookCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UPathfindingGridCookCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
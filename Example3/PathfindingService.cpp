@@ -0,0 +1,372 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathfindingService.h"
+#include "AStar.h"
+#include "FAStarNT.h"
+#include "TimeSlicedPathSearch.h"
+#include "Misc/ScopeLock.h"
+
+FPathfindingService* FPathfindingService::Instance = nullptr;
+
+void FPathfindingService::Startup(int32 NumWorkers)
+{
+	if (!Instance)
+	{
+		if (NumWorkers <= 0)
+		{
+			NumWorkers = FMath::Clamp(FPlatformMisc::NumberOfCores() - 2, 1, 4);
+		}
+		Instance = new FPathfindingService(NumWorkers);
+	}
+}
+
+void FPathfindingService::Shutdown()
+{
+	delete Instance;
+	Instance = nullptr;
+}
+
+FPathfindingService& FPathfindingService::Get()
+{
+	if (!Instance)
+	{
+		Startup();
+	}
+	return *Instance;
+}
+
+FPathfindingService::FPathfindingService(int32 NumWorkers)
+{
+	NextRequestId = 0;
+	NextSliceIndex = 0;
+	FrameExpansionBudget = 2048;
+	FrameBudgetMicroseconds = 1000.0;
+
+	if (FPlatformProcess::SupportsMultithreading())
+	{
+		for (int32 i = 0; i < NumWorkers; ++i)
+		{
+			Workers.Add(new FAStar(*this, i));
+		}
+	}
+}
+
+FPathfindingService::~FPathfindingService()
+{
+	// Cancel first so workers in the middle of a search stop at their next expansion
+	TArray<FPathRequestHandle> Handles;
+	ActiveQueries.GetKeys(Handles);
+	for (FPathRequestHandle Handle : Handles)
+	{
+		CancelRequest(Handle);
+	}
+
+	for (FAStar* Worker : Workers)
+	{
+		Worker->Stop();
+	}
+	for (FAStar* Worker : Workers)
+	{
+		Worker->EnsureCompletion();
+		delete Worker;
+	}
+	Workers.Empty();
+}
+
+FPathRequestHandle FPathfindingService::RequestPath(const FPathRequest& Request, FOnPathComplete OnComplete)
+{
+	TSharedPtr<FPathQuery, ESPMode::ThreadSafe> Query = MakeShared<FPathQuery, ESPMode::ThreadSafe>();
+	Query->OnComplete = OnComplete;
+	const FPathRequestHandle Handle = Register(Query, Request);
+	Dispatch(Query);
+	return Handle;
+}
+
+TFuture<FPathResult> FPathfindingService::RequestPathAsync(const FPathRequest& Request, FPathRequestHandle* OutHandle)
+{
+	TSharedPtr<FPathQuery, ESPMode::ThreadSafe> Query = MakeShared<FPathQuery, ESPMode::ThreadSafe>();
+	Query->Promise = MakeUnique<TPromise<FPathResult>>();
+	TFuture<FPathResult> Future = Query->Promise->GetFuture();
+
+	const FPathRequestHandle Handle = Register(Query, Request);
+	Dispatch(Query);
+	if (OutHandle)
+	{
+		*OutHandle = Handle;
+	}
+	return Future;
+}
+
+FPathRequestHandle FPathfindingService::RequestPathBatched(const FPathRequest& Request, FOnPathComplete OnComplete)
+{
+	TSharedPtr<FPathQuery, ESPMode::ThreadSafe> Query = MakeShared<FPathQuery, ESPMode::ThreadSafe>();
+	Query->OnComplete = OnComplete;
+	const FPathRequestHandle Handle = Register(Query, Request);
+	BatchedQueries.Add(Query);
+	return Handle;
+}
+
+void FPathfindingService::FlushBatch()
+{
+	check(IsInGameThread());
+
+	// Only workers can run a backward search off the game thread, time slicing serves the queries one by one.
+	// Backward searches run over cell actors, queries on packed grids go one by one as well.
+	TMap<TPair<AGridGenerator*, ACellBase*>, TArray<TSharedPtr<FPathQuery, ESPMode::ThreadSafe>>> Groups;
+	for (const TSharedPtr<FPathQuery, ESPMode::ThreadSafe>& Query : BatchedQueries)
+	{
+		if (Workers.Num() > 0 && Query->Request.Mode == EPathSearchMode::AStar && !Query->Request.CellGrid)
+		{
+			Groups.FindOrAdd(TPair<AGridGenerator*, ACellBase*>(Query->Request.GridGenerator, Query->Request.TargetCell)).Add(Query);
+		}
+		else
+		{
+			Dispatch(Query);
+		}
+	}
+	BatchedQueries.Reset();
+
+	for (auto It = Groups.CreateIterator(); It; ++It)
+	{
+		TArray<TSharedPtr<FPathQuery, ESPMode::ThreadSafe>>& Members = It.Value();
+		if (Members.Num() == 1)
+		{
+			Dispatch(Members[0]);
+			continue;
+		}
+
+		TSharedPtr<FPathQuery, ESPMode::ThreadSafe> Batch = MakeShared<FPathQuery, ESPMode::ThreadSafe>();
+		Batch->Request = Members[0]->Request;
+		for (const TSharedPtr<FPathQuery, ESPMode::ThreadSafe>& Member : Members)
+		{
+			Member->Batch = Batch;
+		}
+		Batch->BatchMembers = MoveTemp(Members);
+		Dispatch(Batch);
+	}
+}
+
+FPathRequestHandle FPathfindingService::Register(const TSharedPtr<FPathQuery, ESPMode::ThreadSafe>& Query, const FPathRequest& Request)
+{
+	check(IsInGameThread());
+
+	if (++NextRequestId == 0)
+	{
+		++NextRequestId;
+	}
+	Query->Handle = FPathRequestHandle(NextRequestId);
+	Query->Request = Request;
+
+	// Resolved once here, so batching groups the request by the cell it will actually head for
+	if (Request.bAcceptNearestTarget && Request.CellGrid)
+	{
+		const int32 NearestId = UFAStarNT::GetNearestReachableCellId(Request.CellGrid, Request.StartId, Request.TargetId);
+		if (NearestId != INDEX_NONE)
+		{
+			Query->Request.TargetId = NearestId;
+		}
+	}
+	else if (Request.bAcceptNearestTarget)
+	{
+		if (ACellBase* NearestCell = UFAStarNT::GetNearestReachableCell(Request.StartCell, Request.TargetCell, Request.GridGenerator))
+		{
+			Query->Request.TargetCell = NearestCell;
+		}
+	}
+	ActiveQueries.Add(Query->Handle, Query);
+	return Query->Handle;
+}
+
+void FPathfindingService::Dispatch(const TSharedPtr<FPathQuery, ESPMode::ThreadSafe>& Query)
+{
+	const FPathRequest& Request = Query->Request;
+	if (Workers.Num() == 0)
+	{
+		Query->State = EPathRequestState::Running;
+		if (Request.Mode == EPathSearchMode::AStar)
+		{
+			FSlicedRequest Sliced;
+			Sliced.Query = Query;
+			Sliced.Search = Request.CellGrid
+				? MakeUnique<FTimeSlicedPathSearch>(Request.CellGrid, Request.StartId, Request.TargetId)
+				: MakeUnique<FTimeSlicedPathSearch>(Request.StartCell, Request.TargetCell, Request.GridGenerator);
+			SlicedRequests.Add(MoveTemp(Sliced));
+		}
+		else if (Request.CellGrid)
+		{
+			CompleteRequest(*Query, UFAStarNT::GetPath(Request.CellGrid, Request.StartId, Request.TargetId, Request.Mode, nullptr, Request.SuboptimalityBound));
+		}
+		else
+		{
+			CompleteRequest(*Query, UFAStarNT::GetPath(Request.StartCell, Request.TargetCell, Request.GridGenerator, Request.Mode, nullptr, Request.SuboptimalityBound));
+		}
+		return;
+	}
+
+	FAStar* WorkerToWake = nullptr;
+	{
+		FScopeLock Lock(&QueueLock);
+		PendingRequests.Enqueue(Query);
+		if (IdleWorkers.Num() > 0)
+		{
+			WorkerToWake = IdleWorkers.Pop(false);
+		}
+	}
+	if (WorkerToWake)
+	{
+		WorkerToWake->Wake();
+	}
+}
+
+void FPathfindingService::CancelRequest(FPathRequestHandle Handle)
+{
+	check(IsInGameThread());
+
+	TSharedPtr<FPathQuery, ESPMode::ThreadSafe> Query;
+	if (!ActiveQueries.RemoveAndCopyValue(Handle, Query))
+	{
+		return;
+	}
+
+	// A worker that is still searching sees the token, one that is done loses the race in CompleteRequest
+	Query->Cancellation.Cancel();
+	Query->State = EPathRequestState::Cancelled;
+	SlicedRequests.RemoveAll([Handle](const FSlicedRequest& Sliced) { return Sliced.Query->Handle == Handle; });
+	BatchedQueries.Remove(Query);
+
+	// The shared search only stops once nobody in the batch wants a path anymore
+	TSharedPtr<FPathQuery, ESPMode::ThreadSafe> Batch = Query->Batch.Pin();
+	if (Batch.IsValid() && !Batch->BatchMembers.ContainsByPredicate([](const TSharedPtr<FPathQuery, ESPMode::ThreadSafe>& Member) { return Member->State != EPathRequestState::Cancelled; }))
+	{
+		Batch->Cancellation.Cancel();
+	}
+
+	if (Query->Promise.IsValid())
+	{
+		FPathResult Result;
+		Result.Handle = Handle;
+		Result.bCancelled = true;
+		Query->Promise->SetValue(MoveTemp(Result));
+	}
+}
+
+bool FPathfindingService::IsRequestPending(FPathRequestHandle Handle) const
+{
+	return ActiveQueries.Contains(Handle);
+}
+
+bool FPathfindingService::GetPartialPath(FPathRequestHandle Handle, FPathBuffer& OutPath) const
+{
+	const FSlicedRequest* Sliced = SlicedRequests.FindByPredicate([Handle](const FSlicedRequest& Entry) { return Entry.Query->Handle == Handle; });
+	if (!Sliced)
+	{
+		return false;
+	}
+	OutPath = Sliced->Search->GetPartialPath();
+	return true;
+}
+
+void FPathfindingService::SetFrameBudget(int32 MaxExpansions, double MaxMicroseconds)
+{
+	FrameExpansionBudget = MaxExpansions;
+	FrameBudgetMicroseconds = MaxMicroseconds;
+}
+
+TSharedPtr<FPathQuery, ESPMode::ThreadSafe> FPathfindingService::DequeueRequest(FAStar& Worker)
+{
+	FScopeLock Lock(&QueueLock);
+	TSharedPtr<FPathQuery, ESPMode::ThreadSafe> Query;
+	while (PendingRequests.Dequeue(Query))
+	{
+		// Queries cancelled while queued are dropped here instead of occupying the worker
+		EPathRequestState Expected = EPathRequestState::Queued;
+		if (Query->State.CompareExchange(Expected, EPathRequestState::Running))
+		{
+			return Query;
+		}
+	}
+	IdleWorkers.AddUnique(&Worker);
+	return nullptr;
+}
+
+void FPathfindingService::CompleteRequest(FPathQuery& Query, FPathBuffer&& Path)
+{
+	EPathRequestState Expected = EPathRequestState::Running;
+	if (Query.State.CompareExchange(Expected, EPathRequestState::Completed))
+	{
+		FPathResult Result;
+		Result.Handle = Query.Handle;
+		Result.Path = MoveTemp(Path);
+		CompletedRequests.Enqueue(MoveTemp(Result));
+	}
+}
+
+void FPathfindingService::TickSlicedSearches()
+{
+	const int32 NumSearches = SlicedRequests.Num();
+	if (NumSearches == 0)
+	{
+		return;
+	}
+
+	// Each search gets an even share of what is left, so budget unused by short searches goes to the rest
+	const double StartTime = FPlatformTime::Seconds();
+	int32 ExpansionsLeft = FrameExpansionBudget;
+	for (int32 i = 0; i < NumSearches; ++i)
+	{
+		const double MicrosecondsLeft = FrameBudgetMicroseconds - (FPlatformTime::Seconds() - StartTime) * 1e6;
+		if ((FrameExpansionBudget > 0 && ExpansionsLeft <= 0) || (FrameBudgetMicroseconds > 0.0 && MicrosecondsLeft <= 0.0))
+		{
+			break;
+		}
+
+		const int32 SearchesLeft = NumSearches - i;
+		FTimeSlicedPathSearch& Search = *SlicedRequests[(NextSliceIndex + i) % NumSearches].Search;
+		Search.Step(FrameExpansionBudget > 0 ? FMath::Max(1, ExpansionsLeft / SearchesLeft) : 0,
+			FrameBudgetMicroseconds > 0.0 ? MicrosecondsLeft / SearchesLeft : 0.0);
+		ExpansionsLeft -= Search.GetLastStepExpansions();
+	}
+
+	// Rotate who goes first so the searches at the back are not always the ones starved
+	NextSliceIndex = (NextSliceIndex + 1) % NumSearches;
+
+	for (int32 i = SlicedRequests.Num() - 1; i >= 0; --i)
+	{
+		if (SlicedRequests[i].Search->IsDone())
+		{
+			CompleteRequest(*SlicedRequests[i].Query, SlicedRequests[i].Search->TakePath());
+			SlicedRequests.RemoveAt(i);
+		}
+	}
+}
+
+void FPathfindingService::Tick(float DeltaTime)
+{
+	FlushBatch();
+	TickSlicedSearches();
+
+	FPathResult Result;
+	while (CompletedRequests.Dequeue(Result))
+	{
+		// Cancelled after the worker finished, nobody wants the path anymore
+		TSharedPtr<FPathQuery, ESPMode::ThreadSafe> Query;
+		if (!ActiveQueries.RemoveAndCopyValue(Result.Handle, Query))
+		{
+			continue;
+		}
+
+		if (Query->Promise.IsValid())
+		{
+			Query->Promise->SetValue(MoveTemp(Result));
+		}
+		else
+		{
+			Query->OnComplete.ExecuteIfBound(Result);
+		}
+	}
+}
+
+TStatId FPathfindingService::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FPathfindingService, STATGROUP_Tickables);
+}
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+#include "Tickable.h"
+#include "PathfindingTypes.h"
+
+class FAStar;
+class FTimeSlicedPathSearch;
+
+/** A request in flight, shared between the game thread and the worker answering it */
+struct FPathQuery
+{
+	FPathRequestHandle Handle;
+	FPathRequest Request;
+
+	/** Polled by the search, so cancelling frees the worker within one expansion */
+	FPathCancellationToken Cancellation;
+
+	/** Moves from Queued to Running when a worker picks the query up, whoever reaches Completed or Cancelled first wins */
+	TAtomic<EPathRequestState> State;
+
+	/** Game thread only, a query either has a delegate or a promise */
+	FOnPathComplete OnComplete;
+	TUniquePtr<TPromise<FPathResult>> Promise;
+
+	/** On a query answering a batch: the requests sharing its target, the batch itself has no handle */
+	TArray<TSharedPtr<FPathQuery, ESPMode::ThreadSafe>> BatchMembers;
+
+	/** On a member of a batch: the query answering it */
+	TWeakPtr<FPathQuery, ESPMode::ThreadSafe> Batch;
+
+	FPathQuery() : State(EPathRequestState::Queued) {}
+};
+
+/**
+ * Runs path requests on a fixed pool of FAStar worker threads.
+ * Requests are submitted from the game thread and get a handle back; results are
+ * queued by the workers and handed to the request's delegate or future when the
+ * service ticks on the game thread, the pooled path buffer is moved all the way. Without
+ * multithreading support A* requests are time sliced on the game thread, every
+ * in-flight search getting a share of one frame budget, and the other modes run
+ * inline; both are still delivered on a tick.
+ */
+class INVADED_API FPathfindingService : public FTickableGameObject
+{
+public:
+	/** Creates the service, NumWorkers <= 0 picks a pool size from the core count */
+	static void Startup(int32 NumWorkers = 0);
+
+	/** Stops the workers, requests still in flight are cancelled without calling their delegates */
+	static void Shutdown();
+
+	/** Returns the service, starting it with the default pool size when needed */
+	static FPathfindingService& Get();
+
+	static bool IsRunning() { return Instance != nullptr; }
+
+	/** Queues a path query, OnComplete runs on the game thread once the path is ready */
+	FPathRequestHandle RequestPath(const FPathRequest& Request, FOnPathComplete OnComplete);
+
+	/** Queues a path query whose result is moved into the future on the game thread, cancelled queries resolve with bCancelled set */
+	TFuture<FPathResult> RequestPathAsync(const FPathRequest& Request, FPathRequestHandle* OutHandle = nullptr);
+
+	/**
+	 * Holds the query until the end of the frame. A* queries collected this way that share a grid and a target
+	 * are answered by one backward search from the target, repeated starts are searched once.
+	 */
+	FPathRequestHandle RequestPathBatched(const FPathRequest& Request, FOnPathComplete OnComplete);
+
+	/** Groups and starts the queries held by RequestPathBatched, called by Tick */
+	void FlushBatch();
+
+	/** Stops the query wherever it is, its delegate is never called. Use when the agent dies or picks another target */
+	void CancelRequest(FPathRequestHandle Handle);
+
+	/** True while the request has not been delivered or cancelled yet */
+	bool IsRequestPending(FPathRequestHandle Handle) const;
+
+	/** Partial path of a time-sliced request that is still searching, see FTimeSlicedPathSearch::GetPartialPath */
+	bool GetPartialPath(FPathRequestHandle Handle, FPathBuffer& OutPath) const;
+
+	/** Caps the work all time-sliced searches may do together in one frame, <= 0 for no limit */
+	void SetFrameBudget(int32 MaxExpansions, double MaxMicroseconds);
+
+	int32 GetNumWorkers() const { return Workers.Num(); }
+
+	/** Delivers finished requests, called by the engine every frame */
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return true; }
+	virtual bool IsTickableWhenPaused() const override { return true; }
+	virtual TStatId GetStatId() const override;
+
+	/** Worker side: takes the oldest query that was not cancelled and marks it running, registers the worker as idle when there is none */
+	TSharedPtr<FPathQuery, ESPMode::ThreadSafe> DequeueRequest(FAStar& Worker);
+
+	/** Worker side: hands the path of a running query over to the game thread, dropped if the query was cancelled meanwhile */
+	void CompleteRequest(FPathQuery& Query, FPathBuffer&& Path);
+
+private:
+	explicit FPathfindingService(int32 NumWorkers);
+	~FPathfindingService();
+
+	/** Gives the query a handle and tracks it until it is delivered or cancelled */
+	FPathRequestHandle Register(const TSharedPtr<FPathQuery, ESPMode::ThreadSafe>& Query, const FPathRequest& Request);
+
+	/** Starts a registered query or a batch on a worker, a time slice or inline */
+	void Dispatch(const TSharedPtr<FPathQuery, ESPMode::ThreadSafe>& Query);
+
+	/** Spreads the frame budget over the time-sliced searches and completes the ones that finished */
+	void TickSlicedSearches();
+
+	static FPathfindingService* Instance;
+
+	TArray<FAStar*> Workers;
+
+	FCriticalSection QueueLock;
+	TQueue<TSharedPtr<FPathQuery, ESPMode::ThreadSafe>> PendingRequests;
+	TArray<FAStar*> IdleWorkers;
+
+	TQueue<FPathResult, EQueueMode::Mpsc> CompletedRequests;
+
+	/** Game thread only */
+	TMap<FPathRequestHandle, TSharedPtr<FPathQuery, ESPMode::ThreadSafe>> ActiveQueries;
+
+	struct FSlicedRequest
+	{
+		TSharedPtr<FPathQuery, ESPMode::ThreadSafe> Query;
+		TUniquePtr<FTimeSlicedPathSearch> Search;
+	};
+
+	/** Game thread only, in the order they get their share of the frame budget */
+	TArray<FSlicedRequest> SlicedRequests;
+
+	/** Game thread only, waiting for FlushBatch */
+	TArray<TSharedPtr<FPathQuery, ESPMode::ThreadSafe>> BatchedQueries;
+	int32 NextSliceIndex;
+
+	int32 FrameExpansionBudget;
+	double FrameBudgetMicroseconds;
+
+	uint32 NextRequestId;
+};
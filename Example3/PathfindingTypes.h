@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathBufferPool.h"
+#include "PathfindingCore/PathfindingCoreTypes.h"
+
+class ACellBase;
+class ACellGrid;
+class AGridGenerator;
+
+/** Identifies a request submitted to FPathfindingService */
+struct FPathRequestHandle
+{
+	uint32 Id;
+
+	FPathRequestHandle() : Id(0) {}
+	explicit FPathRequestHandle(uint32 InId) : Id(InId) {}
+
+	bool IsValid() const { return Id != 0; }
+
+	bool operator==(const FPathRequestHandle& Other) const { return Id == Other.Id; }
+	bool operator!=(const FPathRequestHandle& Other) const { return Id != Other.Id; }
+
+	friend uint32 GetTypeHash(const FPathRequestHandle& Handle) { return Handle.Id; }
+};
+
+/** Inputs of a single path query, between two cell actors of a generator or two cell ids of a packed grid */
+struct FPathRequest
+{
+	ACellBase* StartCell;
+	ACellBase* TargetCell;
+	AGridGenerator* GridGenerator;
+
+	/** Set for queries on a packed grid, which go by StartId and TargetId instead of the cell actors */
+	ACellGrid* CellGrid;
+	int32 StartId;
+	int32 TargetId;
+
+	EPathSearchMode Mode;
+
+	/**
+	 * Epsilon for the WeightedAStar and Focal modes, their paths cost at most 1 + SuboptimalityBound times the optimal one.
+	 * Far away or low priority agents can take a few percent longer routes for much cheaper queries.
+	 */
+	float SuboptimalityBound;
+
+	/** When the target is walled off from the start, find a path to the reachable cell closest to it instead of failing */
+	bool bAcceptNearestTarget;
+
+	FPathRequest()
+	{
+		StartCell = nullptr;
+		TargetCell = nullptr;
+		GridGenerator = nullptr;
+		CellGrid = nullptr;
+		StartId = INDEX_NONE;
+		TargetId = INDEX_NONE;
+		Mode = EPathSearchMode::AStar;
+		SuboptimalityBound = 0.0f;
+		bAcceptNearestTarget = false;
+	}
+
+	FPathRequest(ACellBase* InStartCell, ACellBase* InTargetCell, AGridGenerator* InGridGenerator, EPathSearchMode InMode = EPathSearchMode::AStar)
+	{
+		StartCell = InStartCell;
+		TargetCell = InTargetCell;
+		GridGenerator = InGridGenerator;
+		CellGrid = nullptr;
+		StartId = INDEX_NONE;
+		TargetId = INDEX_NONE;
+		Mode = InMode;
+		SuboptimalityBound = 0.0f;
+		bAcceptNearestTarget = false;
+	}
+
+	FPathRequest(ACellGrid* InCellGrid, int32 InStartId, int32 InTargetId, EPathSearchMode InMode = EPathSearchMode::AStar)
+	{
+		StartCell = nullptr;
+		TargetCell = nullptr;
+		GridGenerator = nullptr;
+		CellGrid = InCellGrid;
+		StartId = InStartId;
+		TargetId = InTargetId;
+		Mode = InMode;
+		SuboptimalityBound = 0.0f;
+		bAcceptNearestTarget = false;
+	}
+};
+
+/** Where a request submitted to FPathfindingService is in its life, shared between threads */
+enum class EPathRequestState : uint8
+{
+	Queued,
+	Running,
+	Completed,
+	Cancelled,
+};
+
+/**
+ * Outcome of a path query, Path is empty when the target can't be reached or the query was cancelled.
+ * Copies of the result share the pooled path, keep one for as long as the agent follows it.
+ */
+struct FPathResult
+{
+	FPathRequestHandle Handle;
+	FPathBuffer Path;
+	bool bCancelled;
+
+	FPathResult() : bCancelled(false) {}
+
+	bool IsSuccess() const { return !Path.IsEmpty(); }
+};
+
+DECLARE_DELEGATE_OneParam(FOnPathComplete, const FPathResult&);
@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TimeSlicedPathSearch.h"
+#include "CellBase.h"
+#include "FAStarNT.h"
+#include "PathGrid.h"
+#include "PathQueryProfiler.h"
+#include "PathfindingCore/AStarNodeTable.h"
+#include "PathfindingCore/PathHeuristics.h"
+
+namespace
+{
+	// Reading the clock is not free, only check it every few expansions
+	const int32 ExpansionsPerTimeCheck = 16;
+}
+
+FTimeSlicedPathSearch::FTimeSlicedPathSearch(ACellBase* StartCell, ACellBase* TargetCell, AGridGenerator* GridGenerator)
+	: FTimeSlicedPathSearch(FPathGrid::FindOrBuild(GridGenerator, StartCell), StartCell, TargetCell)
+{
+}
+
+FTimeSlicedPathSearch::FTimeSlicedPathSearch(ACellGrid* CellGrid, int32 InStartId, int32 InTargetId)
+	: FTimeSlicedPathSearch(FPathGrid::FindOrBuild(CellGrid), InStartId, InTargetId)
+{
+}
+
+FTimeSlicedPathSearch::FTimeSlicedPathSearch(const TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& InGrid, ACellBase* StartCell, ACellBase* TargetCell)
+	: FTimeSlicedPathSearch(InGrid, InGrid->GetCellId(StartCell), InGrid->GetCellId(TargetCell))
+{
+}
+
+FTimeSlicedPathSearch::FTimeSlicedPathSearch(const TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& InGrid, int32 InStartId, int32 InTargetId)
+	: Grid(InGrid)
+	, Nodes(Grid->AcquireNodeTable())
+	, OpenSet(*Nodes, &Stats)
+	, EdgeCosts(Grid->GetEdgeCosts())
+	, StartId(InStartId)
+	, TargetId(InTargetId)
+	, CacheKey(StartId, TargetId, Grid->GetVersion(), EPathSearchMode::AStar)
+	, CacheEpoch(Grid->GetPathCache().GetInvalidationEpoch())
+	, BestId(StartId)
+	, Status(EPathSearchStatus::InProgress)
+	, LastStepExpansions(0)
+	, StartCycles(FPlatformTime::Cycles64())
+{
+	if (Grid->GetPathCache().Find(CacheKey, Path))
+	{
+		Status = EPathSearchStatus::Succeeded;
+		RecordQuery(true);
+		return;
+	}
+
+	// Spread over frames or not, a search between components would visit every cell it can reach for nothing
+	if (!Grid->GetComponents().AreConnected(StartId, TargetId))
+	{
+		Status = EPathSearchStatus::Failed;
+		RecordQuery(true);
+		return;
+	}
+
+	const TGridHeuristic<FOctileHeuristic> Heuristic(*Grid, TargetId);
+	Nodes->Visit(StartId);
+	Nodes->SetGCost(StartId, 0);
+	Nodes->SetHCost(StartId, Heuristic.Get(StartId));
+	OpenSet.Push(StartId);
+	++Stats.NodesGenerated;
+}
+
+FTimeSlicedPathSearch::~FTimeSlicedPathSearch()
+{
+	Grid->ReleaseNodeTable(Nodes);
+}
+
+EPathSearchStatus FTimeSlicedPathSearch::Step(int32 MaxExpansions, double MaxMicroseconds)
+{
+	LastStepExpansions = 0;
+	if (IsDone())
+	{
+		return Status;
+	}
+
+	const double EndTime = MaxMicroseconds > 0.0 ? FPlatformTime::Seconds() + MaxMicroseconds * 1e-6 : MAX_dbl;
+	const TGridHeuristic<FOctileHeuristic> Heuristic(*Grid, TargetId);
+
+	while (!OpenSet.IsEmpty())
+	{
+		if (MaxExpansions > 0 && LastStepExpansions >= MaxExpansions)
+		{
+			return Status;
+		}
+		if (LastStepExpansions % ExpansionsPerTimeCheck == ExpansionsPerTimeCheck - 1 && FPlatformTime::Seconds() >= EndTime)
+		{
+			return Status;
+		}
+
+		const int32 CurrentId = OpenSet.Pop();
+		++LastStepExpansions;
+		++Stats.NodesExpanded;
+
+		if (CurrentId == TargetId)
+		{
+			Path = UFAStarNT::RetracePath(*Grid, *Nodes, StartId, TargetId);
+			Finish(EPathSearchStatus::Succeeded);
+			return Status;
+		}
+
+		Stats.NeighboursEvaluated += Grid->GetEndEdge(CurrentId) - Grid->GetFirstEdge(CurrentId);
+		for (int32 Edge = Grid->GetFirstEdge(CurrentId); Edge < Grid->GetEndEdge(CurrentId); ++Edge)
+		{
+			const int32 NeighbourId = Grid->GetEdgeTarget(Edge);
+			if (!Grid->IsWalkable(NeighbourId) || Nodes->IsClosed(NeighbourId) || !Grid->IsMoveAllowed(CurrentId, NeighbourId))
+			{
+				continue;
+			}
+
+			if (!Nodes->IsVisited(NeighbourId))
+			{
+				Nodes->Visit(NeighbourId);
+			}
+
+			const bool bInOpenSet = OpenSet.Contains(NeighbourId);
+			const int32 MovementCost = Nodes->GetGCost(CurrentId) + EdgeCosts[Edge];
+			if (MovementCost < Nodes->GetGCost(NeighbourId) || !bInOpenSet)
+			{
+				Nodes->SetGCost(NeighbourId, MovementCost);
+				Nodes->SetHCost(NeighbourId, Heuristic.Get(NeighbourId));
+				Nodes->SetParent(NeighbourId, CurrentId);
+
+				if (bInOpenSet)
+				{
+					OpenSet.Update(NeighbourId);
+				}
+				else
+				{
+					OpenSet.Push(NeighbourId);
+					++Stats.NodesGenerated;
+				}
+
+				const int32 BestH = Nodes->GetHCost(BestId);
+				const int32 NeighbourH = Nodes->GetHCost(NeighbourId);
+				if (NeighbourH < BestH || (NeighbourH == BestH && MovementCost < Nodes->GetGCost(BestId)))
+				{
+					BestId = NeighbourId;
+				}
+			}
+		}
+	}
+
+	Finish(EPathSearchStatus::Failed);
+	return Status;
+}
+
+FPathBuffer FTimeSlicedPathSearch::GetPartialPath() const
+{
+	if (Status == EPathSearchStatus::Succeeded)
+	{
+		return Path;
+	}
+	return UFAStarNT::RetracePath(*Grid, *Nodes, StartId, BestId);
+}
+
+void FTimeSlicedPathSearch::Finish(EPathSearchStatus NewStatus)
+{
+	Status = NewStatus;
+	OpenSet.Reset();
+
+	// Same rule as UFAStarNT::GetPath, a cell blocked while the search was spread over frames makes the path unfit for the cache.
+	// Paths on a packed grid carry no actors, so it is the cell ids that tell whether one was found.
+	if (!Path.IsEmpty())
+	{
+		Grid->GetPathCache().Add(CacheKey, Path, CacheEpoch);
+	}
+	RecordQuery(false);
+}
+
+void FTimeSlicedPathSearch::RecordQuery(bool bCacheHit) const
+{
+	FPathQueryRecord Record;
+	Record.GridVersion = CacheKey.GridVersion;
+	Record.Start = Grid->GetCoord(StartId);
+	Record.Target = Grid->GetCoord(TargetId);
+	Record.Mode = CacheKey.Mode;
+	Record.bCacheHit = bCacheHit;
+	Record.Search = Stats;
+	Record.PathLength = Path.NumCellIds();
+	Record.Milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+	Record.ThreadId = FPlatformTLS::GetCurrentThreadId();
+	FPathQueryProfiler::Get().Record(Record);
+}
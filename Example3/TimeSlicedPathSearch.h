@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathfindingCore/AStarOpenSet.h"
+#include "PathfindingCore/GridGraph.h"
+#include "PathCache.h"
+
+class ACellBase;
+class ACellGrid;
+class AGridGenerator;
+class FAStarNodeTable;
+class FPathGrid;
+
+/** Progress of a resumable search */
+enum class EPathSearchStatus : uint8
+{
+	InProgress,
+	Succeeded,
+	Failed,
+};
+
+/**
+ * A* query that runs a slice at a time, for the game thread when no worker threads are available.
+ * Open and closed state live in a node table borrowed from the grid for the lifetime of the search,
+ * so each Step picks up where the last one stopped. While it runs, the path to the node closest to
+ * the target is available so agents can start moving before the search finishes.
+ */
+class INVADED_API FTimeSlicedPathSearch
+{
+public:
+	FTimeSlicedPathSearch(ACellBase* StartCell, ACellBase* TargetCell, AGridGenerator* GridGenerator);
+
+	/** Search between two cell ids of a packed grid, the path carries cell ids only like UFAStarNT::GetPath on one */
+	FTimeSlicedPathSearch(ACellGrid* CellGrid, int32 InStartId, int32 InTargetId);
+
+	~FTimeSlicedPathSearch();
+
+	/**
+	 * Expands nodes until the search ends or the budget runs out.
+	 * @param MaxExpansions	Nodes to expand at most, <= 0 for no limit
+	 * @param MaxMicroseconds	Time to spend at most, <= 0 for no limit
+	 */
+	EPathSearchStatus Step(int32 MaxExpansions, double MaxMicroseconds = 0.0);
+
+	EPathSearchStatus GetStatus() const { return Status; }
+
+	bool IsDone() const { return Status != EPathSearchStatus::InProgress; }
+
+	/** Nodes expanded by the last Step / since the search started */
+	int32 GetLastStepExpansions() const { return LastStepExpansions; }
+	int32 GetTotalExpansions() const { return Stats.NodesExpanded; }
+
+	/** The found path once the search succeeded, empty otherwise */
+	const FPathBuffer& GetPath() const { return Path; }
+	FPathBuffer TakePath() { return MoveTemp(Path); }
+
+	/** Best guess so far: the found path on success, otherwise the route to the node with the lowest estimate to the target */
+	FPathBuffer GetPartialPath() const;
+
+private:
+	FTimeSlicedPathSearch(const TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& InGrid, ACellBase* StartCell, ACellBase* TargetCell);
+	FTimeSlicedPathSearch(const TSharedPtr<FPathGrid, ESPMode::ThreadSafe>& InGrid, int32 InStartId, int32 InTargetId);
+
+	void Finish(EPathSearchStatus NewStatus);
+
+	/** Hands the whole search, every slice of it, to FPathQueryProfiler as one query */
+	void RecordQuery(bool bCacheHit) const;
+
+	TSharedPtr<FPathGrid, ESPMode::ThreadSafe> Grid;
+	FAStarNodeTable* Nodes;
+
+	/** Summed over all slices, the open set counts its heap operations into it */
+	FPathSearchStats Stats;
+	FAStarOpenSet OpenSet;
+
+	/** Step costs as of the start, the search reads the same ones across all its slices */
+	FEdgeCostSnapshot EdgeCosts;
+
+	int32 StartId;
+	int32 TargetId;
+	FPathCacheKey CacheKey;
+
+	/** Invalidation epoch of the path cache when the search started */
+	uint32 CacheEpoch;
+
+	/** Node with the lowest H cost seen so far, where the partial path leads */
+	int32 BestId;
+
+	EPathSearchStatus Status;
+	int32 LastStepExpansions;
+
+	/** When the search was created, the recorded time spans every frame it was spread over */
+	uint64 StartCycles;
+
+	FPathBuffer Path;
+};